@@ -0,0 +1,638 @@
+///////////////
+/// @file accuracy.cpp
+/// @brief Synthetic ground truth corpus generator and accuracy against throughput harness.
+/// @details \c generate composites templates into backgrounds at known places,
+/// \c run matches corpus with every backend and fails if accuracy drops below reference.
+///////////////
+#include <opencv4/opencv2/core.hpp>
+#include <opencv4/opencv2/imgcodecs.hpp>
+#include <opencv4/opencv2/imgproc.hpp>
+
+#include <fmt/core.h>
+
+#include "matching.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! <b>[define]</b>
+/// @code{.cpp}
+#define CORPUS_FILE_NAME "corpus.json"
+#define CORPUS_WIDTH 1280
+#define CORPUS_HEIGHT 720
+#define TEMPLATE_MINIMUM_SIZE 32
+#define TEMPLATE_MAXIMUM_SIZE 96
+#define BACKGROUND_SHAPES_COUNT 40
+#define TEMPLATE_SHAPES_COUNT 6
+#define SHOWCASE_DIRECTORY "showcase"
+#define EXIT_REGRESSION 2
+/// @endcode
+//! <b>[define]</b>
+
+//! <b>[struct]</b>
+/// Sample with one template composited at known center.
+/// @code{.cpp}
+struct corpusSample_t {
+    std::string sourceImage;
+    std::string templateImage;
+    int         x     = 0;
+    int         y     = 0;
+    double      scale = 1;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[struct]</b>
+/// Accuracy and throughput of one match method on corpus.
+/// @code{.cpp}
+struct backendAccuracy_t {
+    uint32_t matchMethod     = 0;
+    size_t   samplesCount    = 0;
+    double   hitRate         = 0; // Found within maximum error
+    double   meanError       = 0; // Pixels, of hits only
+    double   imagesPerSecond = 0;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Fill image with random shapes.
+/// @param[in,out] _image Image to draw on.
+/// @param[in] _shapesCount Shapes count.
+/// @param[in] _rng Random numbers generator.
+///////////////
+static void drawShapes( cv::Mat& _image, size_t _shapesCount, cv::RNG& _rng ) {
+    for ( size_t _shapeIndex = 0; _shapeIndex < _shapesCount; _shapeIndex++ ) {
+        const cv::Scalar l_color( _rng.uniform( 0, 256 ), _rng.uniform( 0, 256 ), _rng.uniform( 0, 256 ) );
+        const cv::Point  l_first( _rng.uniform( 0, _image.cols ), _rng.uniform( 0, _image.rows ) );
+        const cv::Point  l_second( _rng.uniform( 0, _image.cols ), _rng.uniform( 0, _image.rows ) );
+
+        switch ( _rng.uniform( 0, 3 ) ) {
+            case 0: {
+                cv::rectangle( _image, l_first, l_second, l_color, cv::FILLED );
+
+                break;
+            }
+
+            case 1: {
+                cv::circle( _image, l_first, _rng.uniform( 2, ( std::min( _image.cols, _image.rows ) / 3 + 3 ) ), l_color, cv::FILLED, cv::LINE_AA );
+
+                break;
+            }
+
+            default: {
+                cv::putText( _image, fmt::format( "{}", _rng.uniform( 0, 1000 ) ), l_first, cv::FONT_HERSHEY_SIMPLEX, _rng.uniform( 0.3, 1.5 ), l_color, 2 );
+            }
+        }
+    }
+}
+
+///////////////
+/// @brief Images of showcase directory, used as real backgrounds and templates next to synthetic ones.
+/// @param[in] _prefix File name prefix.
+/// @return Decoded images, empty if showcase is not found.
+///////////////
+static std::vector< cv::Mat > readShowcase( const std::string& _prefix ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    std::vector< std::string > l_paths;
+    std::vector< cv::Mat >     l_images;
+
+    if ( !std::filesystem::is_directory( SHOWCASE_DIRECTORY ) ) {
+        return ( l_images );
+    }
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[read]</b>
+    /// Sorted, so corpus is the same on every file system.
+    /// @code{.cpp}
+    for ( const std::filesystem::directory_entry& _entry : std::filesystem::directory_iterator( SHOWCASE_DIRECTORY ) ) {
+        if ( _entry.path().filename().string().rfind( _prefix, 0 ) == 0 ) {
+            l_paths.push_back( _entry.path().string() );
+        }
+    }
+
+    std::sort( l_paths.begin(), l_paths.end() );
+
+    for ( const std::string& _path : l_paths ) {
+        cv::Mat l_image = cv::imread( _path, cv::IMREAD_COLOR );
+
+        if ( !l_image.empty() ) {
+            l_images.push_back( l_image );
+        }
+    }
+    /// @endcode
+    //! <b>[read]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_images );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Write corpus of samples with composited templates and its ground truth.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _directory Corpus directory, created if missing.
+/// @param[in] _samplesCount Samples count.
+/// @param[in] _seed Random seed, the same seed gives the same corpus.
+/// @param[in] _noise Standard deviation of gaussian noise added to sample.
+/// @param[in] _jpegQuality JPEG quality sample goes through, 100 or more for none.
+/// @param[in] _scaleJitter Largest relative change of template scale.
+///////////////
+static void generateCorpus(
+    const std::string& _directory,
+    size_t             _samplesCount,
+    uint64_t           _seed,
+    double             _noise,
+    int                _jpegQuality,
+    double             _scaleJitter
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const std::filesystem::path  l_directory( _directory );
+    const std::vector< cv::Mat > l_backgrounds = readShowcase( "found_" );
+    const std::vector< cv::Mat > l_templates   = readShowcase( "template." );
+    cv::RNG                      l_rng( _seed );
+
+    std::filesystem::create_directories( l_directory );
+
+    cv::FileStorage l_storage( ( l_directory / CORPUS_FILE_NAME ).string(), ( cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON ) );
+
+    if ( !l_storage.isOpened() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't write corpus {}",
+                _directory
+            )
+        );
+    }
+
+    l_storage << "samples" << "[";
+    /// @endcode
+    //! <b>[declare]</b>
+
+    for ( size_t _sampleIndex = 0; _sampleIndex < _samplesCount; _sampleIndex++ ) {
+        //! <b>[background]</b>
+        /// Every other background is showcase image, if there is any.
+        /// @code{.cpp}
+        cv::Mat l_sample;
+
+        if ( !l_backgrounds.empty() && ( _sampleIndex % 2 ) ) {
+            cv::resize( l_backgrounds[ l_rng.uniform( 0, static_cast< int >( l_backgrounds.size() ) ) ], l_sample, cv::Size( CORPUS_WIDTH, CORPUS_HEIGHT ) );
+
+        } else {
+            l_sample.create( CORPUS_HEIGHT, CORPUS_WIDTH, CV_8UC3 );
+            l_sample = cv::Scalar( l_rng.uniform( 0, 256 ), l_rng.uniform( 0, 256 ), l_rng.uniform( 0, 256 ) );
+
+            drawShapes( l_sample, BACKGROUND_SHAPES_COUNT, l_rng );
+        }
+        /// @endcode
+        //! <b>[background]</b>
+
+        //! <b>[template]</b>
+        /// Every third template is showcase template, the rest are random shapes.
+        /// @code{.cpp}
+        cv::Mat l_template;
+
+        if ( !l_templates.empty() && !( _sampleIndex % 3 ) ) {
+            l_template = l_templates[ l_rng.uniform( 0, static_cast< int >( l_templates.size() ) ) ];
+
+        } else {
+            const int l_size = l_rng.uniform( TEMPLATE_MINIMUM_SIZE, ( TEMPLATE_MAXIMUM_SIZE + 1 ) );
+
+            l_template.create( l_size, l_size, CV_8UC3 );
+            l_template = cv::Scalar( l_rng.uniform( 0, 256 ), l_rng.uniform( 0, 256 ), l_rng.uniform( 0, 256 ) );
+
+            drawShapes( l_template, TEMPLATE_SHAPES_COUNT, l_rng );
+        }
+        /// @endcode
+        //! <b>[template]</b>
+
+        //! <b>[composite]</b>
+        /// Scaled template is placed fully inside of sample, its center is ground truth.
+        /// @code{.cpp}
+        const double l_scale = ( 1 + l_rng.uniform( -_scaleJitter, _scaleJitter ) );
+        cv::Mat      l_scaledTemplate;
+
+        cv::resize(
+            l_template,
+            l_scaledTemplate,
+            cv::Size(
+                std::clamp( static_cast< int >( std::lround( l_template.cols * l_scale ) ), 1, ( CORPUS_WIDTH / 2 ) ),
+                std::clamp( static_cast< int >( std::lround( l_template.rows * l_scale ) ), 1, ( CORPUS_HEIGHT / 2 ) )
+            ),
+            0,
+            0,
+            cv::INTER_AREA
+        );
+
+        const cv::Rect l_region(
+            l_rng.uniform( 0, ( CORPUS_WIDTH - l_scaledTemplate.cols ) ),
+            l_rng.uniform( 0, ( CORPUS_HEIGHT - l_scaledTemplate.rows ) ),
+            l_scaledTemplate.cols,
+            l_scaledTemplate.rows
+        );
+
+        l_scaledTemplate.copyTo( l_sample( l_region ) );
+        /// @endcode
+        //! <b>[composite]</b>
+
+        //! <b>[degrade]</b>
+        /// Noise and JPEG artifacts are baked into lossless sample.
+        /// @code{.cpp}
+        if ( _noise > 0 ) {
+            cv::Mat l_noise( l_sample.rows, l_sample.cols, CV_32FC3 );
+            cv::Mat l_noisySample;
+
+            l_rng.fill( l_noise, cv::RNG::NORMAL, 0, _noise );
+            l_sample.convertTo( l_noisySample, CV_32FC3 );
+
+            cv::add( l_noisySample, l_noise, l_noisySample );
+
+            l_noisySample.convertTo( l_sample, CV_8UC3 );
+        }
+
+        if ( _jpegQuality < 100 ) {
+            std::vector< uint8_t > l_buffer;
+
+            cv::imencode( ".jpg", l_sample, l_buffer, { cv::IMWRITE_JPEG_QUALITY, _jpegQuality } );
+
+            l_sample = cv::imdecode( l_buffer, cv::IMREAD_COLOR );
+        }
+        /// @endcode
+        //! <b>[degrade]</b>
+
+        //! <b>[write]</b>
+        /// Template is written unscaled, as it would be captured once.
+        /// @code{.cpp}
+        const std::string l_sourceImage   = ( l_directory / fmt::format( "sample.{:05}.png", _sampleIndex ) ).string();
+        const std::string l_templateImage = ( l_directory / fmt::format( "template.{:05}.png", _sampleIndex ) ).string();
+
+        if ( !cv::imwrite( l_sourceImage, l_sample ) || !cv::imwrite( l_templateImage, l_template ) ) {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "Can't write sample {}",
+                    l_sourceImage
+                )
+            );
+        }
+
+        l_storage << "{"
+            << "sample" << l_sourceImage
+            << "template" << l_templateImage
+            << "x" << ( l_region.x + ( l_region.width / 2 ) )
+            << "y" << ( l_region.y + ( l_region.height / 2 ) )
+            << "scale" << l_scale
+            << "}";
+        /// @endcode
+        //! <b>[write]</b>
+    }
+
+    //! <b>[close]</b>
+    /// @code{.cpp}
+    l_storage << "]";
+
+    l_storage.release();
+    /// @endcode
+    //! <b>[close]</b>
+}
+
+///////////////
+/// @brief Read ground truth of corpus.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _directory Corpus directory.
+/// @return Samples.
+///////////////
+static std::vector< corpusSample_t > readCorpus( const std::string& _directory ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    std::vector< corpusSample_t > l_samples;
+    cv::FileStorage               l_storage( ( std::filesystem::path( _directory ) / CORPUS_FILE_NAME ).string(), cv::FileStorage::READ );
+
+    if ( !l_storage.isOpened() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't read corpus {}",
+                _directory
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[read]</b>
+    /// @code{.cpp}
+    for ( const cv::FileNode _sample : l_storage[ "samples" ] ) {
+        corpusSample_t l_sample;
+
+        l_sample.sourceImage   = static_cast< std::string >( _sample[ "sample" ] );
+        l_sample.templateImage = static_cast< std::string >( _sample[ "template" ] );
+        l_sample.x             = static_cast< int >( _sample[ "x" ] );
+        l_sample.y             = static_cast< int >( _sample[ "y" ] );
+        l_sample.scale         = static_cast< double >( _sample[ "scale" ] );
+
+        l_samples.push_back( l_sample );
+    }
+    /// @endcode
+    //! <b>[read]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_samples );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Match every sample of corpus with one match method.
+/// @details Decoded images cache is disabled, so every sample is decoded like on first call.
+/// Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+/// @param[in] _samples Corpus samples.
+/// @param[in] _maximumError Largest distance from ground truth counted as hit, in pixels.
+/// @return Accuracy and throughput.
+///////////////
+static backendAccuracy_t measureBackend(
+    uint32_t                             _matchMethod,
+    const std::vector< corpusSample_t >& _samples,
+    double                               _maximumError
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    backendAccuracy_t        l_accuracy;
+    size_t                   l_hitsCount = 0;
+    double                   l_errorSum  = 0;
+    std::chrono::nanoseconds l_duration{ 0 };
+
+    l_accuracy.matchMethod  = _matchMethod;
+    l_accuracy.samplesCount = _samples.size();
+
+    getImageCache().setBudget( 0 );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[match]</b>
+    /// Only matching is timed, errors are computed outside of it.
+    /// @code{.cpp}
+    for ( const corpusSample_t& _sample : _samples ) {
+        const std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+
+        const matchResult_t l_result = matchingMethodFile(
+            _matchMethod,
+            _sample.sourceImage,
+            { _sample.templateImage },
+            false
+        ).front();
+
+        l_duration += ( std::chrono::steady_clock::now() - l_start );
+
+        const double l_error = std::hypot(
+            ( static_cast< double >( l_result.x ) - _sample.x ),
+            ( static_cast< double >( l_result.y ) - _sample.y )
+        );
+
+        if ( l_result.found && ( l_error <= _maximumError ) ) {
+            l_hitsCount++;
+            l_errorSum += l_error;
+        }
+    }
+    /// @endcode
+    //! <b>[match]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    const double l_seconds = std::chrono::duration< double >( l_duration ).count();
+
+    if ( !_samples.empty() ) {
+        l_accuracy.hitRate = ( static_cast< double >( l_hitsCount ) / _samples.size() );
+    }
+
+    if ( l_hitsCount ) {
+        l_accuracy.meanError = ( l_errorSum / l_hitsCount );
+    }
+
+    if ( l_seconds > 0 ) {
+        l_accuracy.imagesPerSecond = ( _samples.size() / l_seconds );
+    }
+
+    return ( l_accuracy );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Write results of all backends as JSON.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _path Output path.
+/// @param[in] _accuracies Results of backends.
+///////////////
+static void writeAccuracies( const std::string& _path, const std::vector< backendAccuracy_t >& _accuracies ) {
+    cv::FileStorage l_storage( _path, ( cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON ) );
+
+    if ( !l_storage.isOpened() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't write output {}",
+                _path
+            )
+        );
+    }
+
+    l_storage << "backends" << "[";
+
+    for ( const backendAccuracy_t& _accuracy : _accuracies ) {
+        l_storage << "{"
+            << "method" << static_cast< int >( _accuracy.matchMethod )
+            << "samples" << static_cast< int >( _accuracy.samplesCount )
+            << "hitRate" << _accuracy.hitRate
+            << "meanError" << _accuracy.meanError
+            << "imagesPerSecond" << _accuracy.imagesPerSecond
+            << "}";
+    }
+
+    l_storage << "]";
+}
+
+///////////////
+/// @brief Read results written by \c writeAccuracies .
+/// @details Throws ios_base::failure at error.
+/// @param[in] _path Reference path.
+/// @return Results keyed by match method.
+///////////////
+static std::map< uint32_t, backendAccuracy_t > readAccuracies( const std::string& _path ) {
+    std::map< uint32_t, backendAccuracy_t > l_accuracies;
+    cv::FileStorage                         l_storage( _path, cv::FileStorage::READ );
+
+    if ( !l_storage.isOpened() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't read reference {}",
+                _path
+            )
+        );
+    }
+
+    for ( const cv::FileNode _backend : l_storage[ "backends" ] ) {
+        backendAccuracy_t l_accuracy;
+
+        l_accuracy.matchMethod     = static_cast< int >( _backend[ "method" ] );
+        l_accuracy.samplesCount    = static_cast< int >( _backend[ "samples" ] );
+        l_accuracy.hitRate         = static_cast< double >( _backend[ "hitRate" ] );
+        l_accuracy.meanError       = static_cast< double >( _backend[ "meanError" ] );
+        l_accuracy.imagesPerSecond = static_cast< double >( _backend[ "imagesPerSecond" ] );
+
+        l_accuracies[ l_accuracy.matchMethod ] = l_accuracy;
+    }
+
+    return ( l_accuracies );
+}
+
+///////////////
+/// @brief Parse comma separated match methods.
+/// @param[in] _text Like "0,1,5".
+/// @return Match methods.
+///////////////
+static std::vector< uint32_t > parseMatchMethods( const std::string& _text ) {
+    std::vector< uint32_t > l_matchMethods;
+    std::stringstream       l_stream( _text );
+    std::string             l_item;
+
+    while ( std::getline( l_stream, l_item, ',' ) ) {
+        if ( !l_item.empty() ) {
+            l_matchMethods.push_back( std::stoul( l_item ) );
+        }
+    }
+
+    return ( l_matchMethods );
+}
+
+int main( int _argumentsCount, char** _arguments ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const std::string l_keys =
+        "{help h       |               | print this message }"
+        "{@command     |               | generate or run }"
+        "{@directory   | corpus        | corpus directory }"
+        "{count        | 200           | samples to generate }"
+        "{seed         | 1             | random seed of generator }"
+        "{noise        | 4             | standard deviation of sample noise }"
+        "{jpeg-quality | 90            | JPEG quality samples go through, 100 for none }"
+        "{scale-jitter | 0.02          | largest relative change of template scale }"
+        "{methods      | 0,1,2,3,4,5,6 | comma separated match methods to run }"
+        "{max-error    | 4             | largest distance from ground truth counted as hit, in pixels }"
+        "{output       | accuracy.json | results of run }"
+        "{reference    |               | results of earlier run to compare against }"
+        "{tolerance    | 0.01          | allowed hit rate drop against reference }"
+        "{error-tolerance | 0.5        | allowed mean error growth against reference, in pixels }";
+
+    cv::CommandLineParser l_parser( _argumentsCount, _arguments, l_keys );
+
+    l_parser.about( "Accuracy against throughput harness of matching backends" );
+
+    const std::string l_command   = l_parser.get< std::string >( "@command" );
+    const std::string l_directory = l_parser.get< std::string >( "@directory" );
+
+    if ( l_parser.has( "help" ) || ( ( l_command != "generate" ) && ( l_command != "run" ) ) ) {
+        l_parser.printMessage();
+
+        return ( l_parser.has( "help" ) ? EXIT_SUCCESS : EXIT_FAILURE );
+    }
+    /// @endcode
+    //! <b>[declare]</b>
+
+    try {
+        //! <b>[generate]</b>
+        /// @code{.cpp}
+        if ( l_command == "generate" ) {
+            generateCorpus(
+                l_directory,
+                l_parser.get< int >( "count" ),
+                l_parser.get< int >( "seed" ),
+                l_parser.get< double >( "noise" ),
+                l_parser.get< int >( "jpeg-quality" ),
+                l_parser.get< double >( "scale-jitter" )
+            );
+
+            return ( EXIT_SUCCESS );
+        }
+        /// @endcode
+        //! <b>[generate]</b>
+
+        //! <b>[run]</b>
+        /// @code{.cpp}
+        const std::vector< corpusSample_t > l_samples = readCorpus( l_directory );
+        std::vector< backendAccuracy_t >    l_accuracies;
+
+        fmt::print( "{:>6} {:>8} {:>10} {:>12}\n", "method", "hit rate", "mean error", "images / s" );
+
+        for ( const uint32_t _matchMethod : parseMatchMethods( l_parser.get< std::string >( "methods" ) ) ) {
+            l_accuracies.push_back( measureBackend( _matchMethod, l_samples, l_parser.get< double >( "max-error" ) ) );
+
+            const backendAccuracy_t& l_accuracy = l_accuracies.back();
+
+            fmt::print( "{:>6} {:>8.3f} {:>10.2f} {:>12.1f}\n", l_accuracy.matchMethod, l_accuracy.hitRate, l_accuracy.meanError, l_accuracy.imagesPerSecond );
+        }
+
+        writeAccuracies( l_parser.get< std::string >( "output" ), l_accuracies );
+        /// @endcode
+        //! <b>[run]</b>
+
+        //! <b>[compare]</b>
+        /// Backend fails if it finds less spots or places them worse than reference run did.
+        /// @code{.cpp}
+        const std::string l_reference = l_parser.get< std::string >( "reference" );
+        bool              l_isRegression = false;
+
+        if ( !l_reference.empty() ) {
+            const std::map< uint32_t, backendAccuracy_t > l_referenceAccuracies = readAccuracies( l_reference );
+
+            for ( const backendAccuracy_t& _accuracy : l_accuracies ) {
+                auto l_referenceAccuracy = l_referenceAccuracies.find( _accuracy.matchMethod );
+
+                if ( l_referenceAccuracy == l_referenceAccuracies.end() ) {
+                    continue;
+                }
+
+                if (
+                    ( _accuracy.hitRate < ( l_referenceAccuracy->second.hitRate - l_parser.get< double >( "tolerance" ) ) ) ||
+                    ( _accuracy.meanError > ( l_referenceAccuracy->second.meanError + l_parser.get< double >( "error-tolerance" ) ) )
+                ) {
+                    fmt::print(
+                        stderr,
+                        "Method {} lost accuracy: hit rate {:.3f} against {:.3f}, mean error {:.2f} against {:.2f}\n",
+                        _accuracy.matchMethod,
+                        _accuracy.hitRate,
+                        l_referenceAccuracy->second.hitRate,
+                        _accuracy.meanError,
+                        l_referenceAccuracy->second.meanError
+                    );
+
+                    l_isRegression = true;
+                }
+            }
+        }
+
+        return ( l_isRegression ? EXIT_REGRESSION : EXIT_SUCCESS );
+        /// @endcode
+        //! <b>[compare]</b>
+
+    } catch ( const std::exception& _exception ) {
+        fmt::print( stderr, "{}\n", _exception.what() );
+
+        return ( EXIT_FAILURE );
+    }
+}
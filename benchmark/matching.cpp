@@ -0,0 +1,367 @@
+///////////////
+/// @file matching.cpp
+/// @brief Microbenchmarks of matching and window capture hot paths.
+/// @details Run with \c --benchmark_format=json or build \c benchmark_json target to track results.
+///////////////
+#include <benchmark/benchmark.h>
+
+#include <opencv4/opencv2/imgcodecs.hpp>
+
+#include <fmt/core.h>
+
+#include "matching.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+//! <b>[define]</b>
+/// @code{.cpp}
+#define BENCHMARK_SEED 1
+#define BENCHMARK_DIRECTORY "matching_benchmark"
+#define BENCHMARK_WINDOW_VARIABLE "MATCHING_BENCHMARK_WINDOW"
+#define SHOWCASE_DIRECTORY "showcase"
+/// @endcode
+//! <b>[define]</b>
+
+//! <b>[declare]</b>
+/// Names of cv::TemplateMatchModes, index is match method.
+/// @code{.cpp}
+static const std::array< const char*, 6 > matchMethodNames = {
+    "TM_SQDIFF",
+    "TM_SQDIFF_NORMED",
+    "TM_CCORR",
+    "TM_CCORR_NORMED",
+    "TM_CCOEFF",
+    "TM_CCOEFF_NORMED"
+};
+
+static const std::array< std::pair< const char*, const char* >, 3 > showcaseImages = { {
+    { "found_car_on_advertisement.png", "template.adv.car.png" },
+    { "found_car_light_on_car.png", "template.car.car_light.png" },
+    { "found_horse_on_wild.png", "template.wild.horse.png" }
+} };
+/// @endcode
+//! <b>[declare]</b>
+
+///////////////
+/// @brief Noise frame of 16:9 geometry, the same for every run.
+/// @param[in] _height Frame height.
+/// @return Frame.
+///////////////
+static const cv::Mat& getSyntheticFrame( int _height ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    static std::map< int, cv::Mat > l_frames;
+
+    cv::Mat& l_frame = l_frames[ _height ];
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[generate]</b>
+    /// Noise has no repeated regions, so every template is found at one place.
+    /// @code{.cpp}
+    if ( l_frame.empty() ) {
+        cv::RNG l_rng( BENCHMARK_SEED );
+
+        l_frame.create( _height, ( ( _height * 16 ) / 9 ), CV_8UC3 );
+
+        l_rng.fill( l_frame, cv::RNG::UNIFORM, 0, 256 );
+    }
+    /// @endcode
+    //! <b>[generate]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_frame );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Crop templates from synthetic frame and write them to temporary directory.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _height Frame height.
+/// @param[in] _templateSize Template side.
+/// @param[in] _templatesCount Templates count.
+/// @return Template image paths.
+///////////////
+static std::vector< std::string > getSyntheticTemplates( int _height, int _templateSize, size_t _templatesCount ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const cv::Mat&              l_frame     = getSyntheticFrame( _height );
+    const std::filesystem::path l_directory = ( std::filesystem::temp_directory_path() / BENCHMARK_DIRECTORY );
+    std::vector< std::string >  l_templateImages;
+    cv::RNG                     l_rng( BENCHMARK_SEED + _templatesCount );
+
+    std::filesystem::create_directories( l_directory );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[write]</b>
+    /// Existing files are reused, they depend only on their name.
+    /// @code{.cpp}
+    for ( size_t _templateId = 0; _templateId < _templatesCount; _templateId++ ) {
+        const std::string l_templateImage = (
+            l_directory / fmt::format( "template.{}.{}.{}.{}.png", _height, _templateSize, _templatesCount, _templateId )
+        ).string();
+
+        const cv::Rect l_region(
+            l_rng.uniform( 0, ( l_frame.cols - _templateSize ) ),
+            l_rng.uniform( 0, ( l_frame.rows - _templateSize ) ),
+            _templateSize,
+            _templateSize
+        );
+
+        if ( !std::filesystem::exists( l_templateImage ) && !cv::imwrite( l_templateImage, l_frame( l_region ) ) ) {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "Can't write template image {}",
+                    l_templateImage
+                )
+            );
+        }
+
+        l_templateImages.push_back( l_templateImage );
+    }
+    /// @endcode
+    //! <b>[write]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_templateImages );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Match templates on synthetic frame.
+/// @details Arguments are match method, frame height, template side, templates count and threads count.
+/// @param[in] _state Benchmark state.
+///////////////
+static void matchSynthetic( benchmark::State& _state ) {
+    //! <b>[declare]</b>
+    /// Templates are loaded before timing, every iteration is one frame.
+    /// @code{.cpp}
+    const uint32_t    l_matchMethod    = _state.range( 0 );
+    const int         l_height         = _state.range( 1 );
+    const int         l_templateSize   = _state.range( 2 );
+    const size_t      l_templatesCount = _state.range( 3 );
+    const cv::Mat&    l_frame          = getSyntheticFrame( l_height );
+    matchingSession_t l_session( l_matchMethod, _state.range( 4 ) );
+
+    for ( const std::string& _templateImage : getSyntheticTemplates( l_height, l_templateSize, l_templatesCount ) ) {
+        l_session.addTemplate( _templateImage );
+    }
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[run]</b>
+    /// @code{.cpp}
+    for ( auto _ : _state ) {
+        benchmark::DoNotOptimize( l_session.matchImage( l_frame ) );
+    }
+
+    _state.SetLabel( matchMethodNames[ l_matchMethod ] );
+    _state.counters[ "frames_per_second" ] = benchmark::Counter( _state.iterations(), benchmark::Counter::kIsRate );
+    _state.counters[ "templates_per_second" ] = benchmark::Counter(
+        ( _state.iterations() * l_templatesCount ),
+        benchmark::Counter::kIsRate
+    );
+    /// @endcode
+    //! <b>[run]</b>
+}
+
+///////////////
+/// @brief Match showcase template on its sample.
+/// @details Arguments are showcase index and match method. Run from repository root.
+/// @param[in] _state Benchmark state.
+///////////////
+static void matchShowcase( benchmark::State& _state ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const std::pair< const char*, const char* >& l_showcase    = showcaseImages[ _state.range( 0 ) ];
+    const uint32_t                               l_matchMethod = _state.range( 1 );
+    const std::filesystem::path                  l_directory( SHOWCASE_DIRECTORY );
+    const cv::Mat                                l_image       = cv::imread( ( l_directory / l_showcase.first ).string(), cv::IMREAD_COLOR );
+
+    if ( l_image.empty() ) {
+        _state.SkipWithError( "Showcase images not found, run from repository root" );
+
+        return;
+    }
+
+    matchingSession_t l_session( l_matchMethod );
+
+    l_session.addTemplate( ( l_directory / l_showcase.second ).string() );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[run]</b>
+    /// @code{.cpp}
+    for ( auto _ : _state ) {
+        benchmark::DoNotOptimize( l_session.matchImage( l_image ) );
+    }
+
+    _state.SetLabel( fmt::format( "{} {}", l_showcase.first, matchMethodNames[ l_matchMethod ] ) );
+    _state.counters[ "frames_per_second" ] = benchmark::Counter( _state.iterations(), benchmark::Counter::kIsRate );
+    /// @endcode
+    //! <b>[run]</b>
+}
+
+///////////////
+/// @brief Capture window without matching.
+/// @details Window name is taken from \c MATCHING_BENCHMARK_WINDOW , for example window of \c xterm on Xvfb.
+/// Skipped if it is not set.
+/// @param[in] _state Benchmark state.
+///////////////
+static void captureWindow( benchmark::State& _state ) {
+    //! <b>[declare]</b>
+    /// Session without templates only captures, incremental matching would hash frames.
+    /// @code{.cpp}
+    const char* l_windowName = std::getenv( BENCHMARK_WINDOW_VARIABLE );
+
+    if ( !l_windowName ) {
+        _state.SkipWithError( BENCHMARK_WINDOW_VARIABLE " is not set" );
+
+        return;
+    }
+
+    matchingSession_t l_session( cv::TM_CCOEFF_NORMED, 1 );
+
+    l_session.setIncremental( false );
+    l_session.setWindow( l_windowName );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[run]</b>
+    /// @code{.cpp}
+    for ( auto _ : _state ) {
+        benchmark::DoNotOptimize( l_session.matchWindow() );
+    }
+
+    _state.counters[ "frames_per_second" ] = benchmark::Counter( _state.iterations(), benchmark::Counter::kIsRate );
+    /// @endcode
+    //! <b>[run]</b>
+}
+
+///////////////
+/// @brief Every match method on every frame size with one template.
+/// @param[in] _benchmark Benchmark to add arguments to.
+///////////////
+static void sweepFrameSizes( benchmark::internal::Benchmark* _benchmark ) {
+    const int64_t l_threadsCount = std::thread::hardware_concurrency();
+
+    for ( int64_t _matchMethod = 0; _matchMethod < static_cast< int64_t >( matchMethodNames.size() ); _matchMethod++ ) {
+        for ( const int64_t _height : { 720, 1080, 1440, 2160 } ) {
+            _benchmark->Args( { _matchMethod, _height, 64, 1, l_threadsCount } );
+        }
+    }
+}
+
+///////////////
+/// @brief Template sizes and counts on 1080p frame.
+/// @param[in] _benchmark Benchmark to add arguments to.
+///////////////
+static void sweepTemplates( benchmark::internal::Benchmark* _benchmark ) {
+    const int64_t l_threadsCount = std::thread::hardware_concurrency();
+
+    for ( const int64_t _templateSize : { 32, 64, 128, 256 } ) {
+        for ( const int64_t _templatesCount : { 1, 8, 32 } ) {
+            _benchmark->Args( { cv::TM_CCOEFF_NORMED, 1080, _templateSize, _templatesCount, l_threadsCount } );
+        }
+    }
+}
+
+///////////////
+/// @brief Counts of glyph sized templates on 1080p frame, batched from \c BATCH_MINIMUM_TEMPLATES on.
+/// @param[in] _benchmark Benchmark to add arguments to.
+///////////////
+static void sweepGlyphs( benchmark::internal::Benchmark* _benchmark ) {
+    const int64_t l_threadsCount = std::thread::hardware_concurrency();
+
+    for ( const int64_t _templateSize : { 16, 24 } ) {
+        for ( const int64_t _templatesCount : { 1, 4, 16, 64 } ) {
+            _benchmark->Args( { cv::TM_CCOEFF_NORMED, 1080, _templateSize, _templatesCount, l_threadsCount } );
+        }
+    }
+}
+
+///////////////
+/// @brief Threads counts up to hardware concurrency on 1080p frame with 16 templates.
+/// @param[in] _benchmark Benchmark to add arguments to.
+///////////////
+static void sweepThreads( benchmark::internal::Benchmark* _benchmark ) {
+    const int64_t l_threadsCount = std::thread::hardware_concurrency();
+
+    for ( int64_t _threads = 1; _threads < l_threadsCount; _threads *= 2 ) {
+        _benchmark->Args( { cv::TM_CCOEFF_NORMED, 1080, 64, 16, _threads } );
+    }
+
+    _benchmark->Args( { cv::TM_CCOEFF_NORMED, 1080, 64, 16, l_threadsCount } );
+}
+
+///////////////
+/// @brief Every showcase sample with every match method.
+/// @param[in] _benchmark Benchmark to add arguments to.
+///////////////
+static void sweepShowcase( benchmark::internal::Benchmark* _benchmark ) {
+    for ( int64_t _showcase = 0; _showcase < static_cast< int64_t >( showcaseImages.size() ); _showcase++ ) {
+        for ( int64_t _matchMethod = 0; _matchMethod < static_cast< int64_t >( matchMethodNames.size() ); _matchMethod++ ) {
+            _benchmark->Args( { _showcase, _matchMethod } );
+        }
+    }
+}
+
+//! <b>[register]</b>
+/// Real time is measured, matching runs on pool threads.
+/// @code{.cpp}
+BENCHMARK( matchSynthetic )
+    ->Name( "matchSynthetic/frameSizes" )
+    ->ArgNames( { "method", "height", "template", "templates", "threads" } )
+    ->Apply( sweepFrameSizes )
+    ->Unit( benchmark::kMillisecond )
+    ->UseRealTime();
+
+BENCHMARK( matchSynthetic )
+    ->Name( "matchSynthetic/templates" )
+    ->ArgNames( { "method", "height", "template", "templates", "threads" } )
+    ->Apply( sweepTemplates )
+    ->Unit( benchmark::kMillisecond )
+    ->UseRealTime();
+
+BENCHMARK( matchSynthetic )
+    ->Name( "matchSynthetic/glyphs" )
+    ->ArgNames( { "method", "height", "template", "templates", "threads" } )
+    ->Apply( sweepGlyphs )
+    ->Unit( benchmark::kMillisecond )
+    ->UseRealTime();
+
+BENCHMARK( matchSynthetic )
+    ->Name( "matchSynthetic/threads" )
+    ->ArgNames( { "method", "height", "template", "templates", "threads" } )
+    ->Apply( sweepThreads )
+    ->Unit( benchmark::kMillisecond )
+    ->UseRealTime();
+
+BENCHMARK( matchShowcase )
+    ->ArgNames( { "showcase", "method" } )
+    ->Apply( sweepShowcase )
+    ->Unit( benchmark::kMillisecond )
+    ->UseRealTime();
+
+BENCHMARK( captureWindow )
+    ->Unit( benchmark::kMillisecond )
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
+/// @endcode
+//! <b>[register]</b>
@@ -0,0 +1,432 @@
+///////////////
+/// @file matching.cpp
+/// @brief Command line driver of matching library, runs file, directory, window and stream matching without R.
+/// @details Results go to standard output as CSV, errors to standard error.
+///////////////
+#include <opencv4/opencv2/core.hpp>
+
+#include <fmt/core.h>
+
+#include "matching.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! <b>[define]</b>
+/// @code{.cpp}
+#define EVENTS_POLL_INTERVAL std::chrono::milliseconds( 100 )
+/// @endcode
+//! <b>[define]</b>
+
+///////////////
+/// @brief Interrupt flag set by \c SIGINT and \c SIGTERM .
+/// @details Constant initialized, so signal handler touches no guard.
+/// @return Flag.
+///////////////
+static volatile std::sig_atomic_t& isInterrupted( void ) {
+    static volatile std::sig_atomic_t l_isInterrupted = 0;
+
+    return ( l_isInterrupted );
+}
+
+static void interrupt( int ) {
+    isInterrupted() = 1;
+}
+
+///////////////
+/// @brief Split comma separated list.
+/// @param[in] _text List text.
+/// @return Non-empty items.
+///////////////
+static std::vector< std::string > splitList( const std::string& _text ) {
+    std::vector< std::string > l_items;
+    std::stringstream          l_stream( _text );
+    std::string                l_item;
+
+    while ( std::getline( l_stream, l_item, ',' ) ) {
+        if ( !l_item.empty() ) {
+            l_items.push_back( l_item );
+        }
+    }
+
+    return ( l_items );
+}
+
+///////////////
+/// @brief Print result row.
+/// @param[in] _source Sample, frame or window name.
+/// @param[in] _templateImage Template image path.
+/// @param[in] _result Match result.
+///////////////
+static void printResult( const std::string& _source, const std::string& _templateImage, const matchResult_t& _result ) {
+    fmt::print(
+        "{},{},{},{},{},{}\n",
+        _source,
+        _templateImage,
+        _result.x,
+        _result.y,
+        _result.score,
+        ( _result.found ? 1 : 0 )
+    );
+}
+
+///////////////
+/// @brief Match templates on window until interrupted or duration is over.
+/// @details Session run loop captures and matches at fixed rate, every change of result is printed.
+/// @param[in] _session Session with loaded templates.
+/// @param[in] _windowName Window name.
+/// @param[in] _framesPerSecond Frame rate.
+/// @param[in] _seconds Duration, 0 for endless.
+///////////////
+static void matchWindowLoop(
+    matchingSession_t& _session,
+    const std::string& _windowName,
+    double             _framesPerSecond,
+    double             _seconds
+) {
+    //! <b>[start]</b>
+    /// @code{.cpp}
+    const std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+
+    _session.setWindow( _windowName );
+    _session.start( _framesPerSecond );
+    /// @endcode
+    //! <b>[start]</b>
+
+    //! <b>[events]</b>
+    /// Events are taken from queue, run loop never waits for output.
+    /// @code{.cpp}
+    while (
+        !isInterrupted() &&
+        ( ( _seconds <= 0 ) || ( std::chrono::duration< double >( std::chrono::steady_clock::now() - l_start ).count() < _seconds ) )
+    ) {
+        std::this_thread::sleep_for( EVENTS_POLL_INTERVAL );
+
+        for ( const sessionEvent_t& _event : _session.popEvents() ) {
+            if ( !_event.clicked ) {
+                printResult( _windowName, _session.templateImages()[ _event.templateId ], _event.result );
+            }
+        }
+    }
+    /// @endcode
+    //! <b>[events]</b>
+
+    //! <b>[stop]</b>
+    /// Latency quantiles are reported against target, if it is set.
+    /// @code{.cpp}
+    _session.stop();
+
+    const latencyReport_t l_report = _session.latencyReport();
+
+    fmt::print(
+        stderr,
+        "{} frames, {} missed, {} dropped\n",
+        _session.framesCount(),
+        _session.missedFramesCount(),
+        l_report.droppedFramesCount
+    );
+
+    fmt::print(
+        stderr,
+        "Capture to result median {:.3f} ms, p99 {:.3f} ms, maximum {:.3f} ms{}\n",
+        ( l_report.median * 1000 ),
+        ( l_report.p99 * 1000 ),
+        ( l_report.maximum * 1000 ),
+        (
+            ( l_report.target > 0 )
+            ? fmt::format( ", target {:.3f} ms {}", ( l_report.target * 1000 ), ( l_report.isMet ? "met" : "missed" ) )
+            : std::string()
+        )
+    );
+    /// @endcode
+    //! <b>[stop]</b>
+}
+
+///////////////
+/// @brief Match templates on several windows until interrupted or duration is over.
+/// @details Every window is searched for all templates, changed results are printed.
+/// Throws ios_base::failure at error.
+/// @param[in] _session Session with loaded templates.
+/// @param[in] _windowNames Window names.
+/// @param[in] _framesPerSecond Frame rate.
+/// @param[in] _seconds Duration, 0 for endless.
+///////////////
+static void matchWindowsLoop(
+    matchingSession_t&                _session,
+    const std::vector< std::string >& _windowNames,
+    double                            _framesPerSecond,
+    double                            _seconds
+) {
+    //! <b>[start]</b>
+    /// @code{.cpp}
+    const std::chrono::steady_clock::time_point l_start       = std::chrono::steady_clock::now();
+    const std::chrono::nanoseconds              l_framePeriod = std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::duration< double >( 1 / std::max( _framesPerSecond, 1.0 ) )
+    );
+    std::chrono::steady_clock::time_point       l_nextFrame   = l_start;
+    std::vector< windowResult_t >               l_previousResults;
+    uint64_t                                    l_framesCount = 0;
+
+    for ( const std::string& _windowName : _windowNames ) {
+        _session.addWindow( _windowName );
+    }
+    /// @endcode
+    //! <b>[start]</b>
+
+    //! <b>[loop]</b>
+    /// Result is printed when it differs from previous frame.
+    /// @code{.cpp}
+    while (
+        !isInterrupted() &&
+        ( ( _seconds <= 0 ) || ( std::chrono::duration< double >( std::chrono::steady_clock::now() - l_start ).count() < _seconds ) )
+    ) {
+        const std::vector< windowResult_t > l_results = _session.matchWindows();
+
+        for ( size_t _index = 0; _index < l_results.size(); _index++ ) {
+            const matchResult_t& l_result = l_results[ _index ].result;
+
+            if (
+                ( _index >= l_previousResults.size() ) ||
+                ( l_previousResults[ _index ].result.x != l_result.x ) ||
+                ( l_previousResults[ _index ].result.y != l_result.y ) ||
+                ( l_previousResults[ _index ].result.found != l_result.found )
+            ) {
+                printResult(
+                    _windowNames[ l_results[ _index ].windowId ],
+                    _session.templateImages()[ l_results[ _index ].templateId ],
+                    l_result
+                );
+            }
+        }
+
+        l_previousResults = l_results;
+        l_framesCount++;
+        l_nextFrame = std::max( ( l_nextFrame + l_framePeriod ), std::chrono::steady_clock::now() );
+
+        std::this_thread::sleep_until( l_nextFrame );
+    }
+    /// @endcode
+    //! <b>[loop]</b>
+
+    //! <b>[stop]</b>
+    /// @code{.cpp}
+    fmt::print(
+        stderr,
+        "{} frames of {} windows\n",
+        l_framesCount,
+        _windowNames.size()
+    );
+    /// @endcode
+    //! <b>[stop]</b>
+}
+
+///////////////
+/// @brief Load templates into session and match them on file, window or stream.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _parser Parsed arguments.
+/// @param[in] _command file, window or stream.
+/// @param[in] _source Sample image, window name, comma separated window names or video.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+///////////////
+static void matchSession(
+    const cv::CommandLineParser& _parser,
+    const std::string&           _command,
+    const std::string&           _source,
+    uint32_t                     _matchMethod
+) {
+    //! <b>[session]</b>
+    /// @code{.cpp}
+    const std::vector< std::string > l_templateImages = splitList( _parser.get< std::string >( "templates" ) );
+    const size_t                     l_threadsCount   = static_cast< size_t >( std::max( _parser.get< int >( "threads" ), 0 ) );
+
+    if ( l_templateImages.empty() ) {
+        throw std::ios_base::failure( "No templates, set them with --templates" );
+    }
+
+    matchingSession_t l_session(
+        _matchMethod,
+        ( l_threadsCount ? l_threadsCount : std::thread::hardware_concurrency() )
+    );
+
+    for ( const std::string& _templateImage : l_templateImages ) {
+        l_session.addTemplate( _templateImage );
+    }
+
+    l_session.setShowResult( _parser.get< bool >( "show" ) );
+    l_session.setTuningProfile( _parser.get< std::string >( "profile" ) );
+    l_session.setCaptureScale( static_cast< uint32_t >( std::max( _parser.get< int >( "scale" ), 1 ) ) );
+    /// @endcode
+    //! <b>[session]</b>
+
+    //! <b>[low_latency]</b>
+    /// @code{.cpp}
+    lowLatency_t l_lowLatency;
+
+    l_lowLatency.captureCore   = _parser.get< int >( "core" );
+    l_lowLatency.isPrefaulting = _parser.get< bool >( "prefault" );
+    l_lowLatency.isBusyPolling = _parser.get< bool >( "busy" );
+    l_lowLatency.latencyTarget = std::chrono::microseconds( static_cast< int64_t >( _parser.get< double >( "target" ) * 1000 ) );
+
+    for ( const std::string& _core : splitList( _parser.get< std::string >( "cores" ) ) ) {
+        l_lowLatency.matcherCores.push_back( std::stoi( _core ) );
+    }
+
+    l_session.setLowLatency( l_lowLatency );
+    /// @endcode
+    //! <b>[low_latency]</b>
+
+    //! <b>[match]</b>
+    /// @code{.cpp}
+    if ( _command == "file" ) {
+        const std::vector< matchResult_t > l_results = l_session.matchFile( _source );
+
+        fmt::print( "sample,template,x,y,score,found\n" );
+
+        for ( size_t _templateId = 0; _templateId < l_results.size(); _templateId++ ) {
+            printResult( _source, l_templateImages[ _templateId ], l_results[ _templateId ] );
+        }
+
+    } else if ( _command == "window" ) {
+        const std::vector< std::string > l_windowNames = splitList( _source );
+
+        fmt::print( "window,template,x,y,score,found\n" );
+
+        if ( l_windowNames.size() > 1 ) {
+            matchWindowsLoop( l_session, l_windowNames, _parser.get< double >( "fps" ), _parser.get< double >( "seconds" ) );
+
+        } else {
+            matchWindowLoop( l_session, _source, _parser.get< double >( "fps" ), _parser.get< double >( "seconds" ) );
+        }
+
+    } else {
+        const std::string l_threshold = _parser.get< std::string >( "threshold" );
+
+        if ( !l_threshold.empty() ) {
+            l_session.setScoreThreshold( std::stod( l_threshold ) );
+        }
+
+        const streamStatistics_t l_statistics = l_session.matchStream(
+            _source,
+            _parser.get< std::string >( "output" ),
+            _parser.get< std::string >( "extension" )
+        );
+
+        fmt::print(
+            stderr,
+            "{} frames, {} detections, {:.1f} frames / s\n",
+            l_statistics.framesCount,
+            l_statistics.detectionsCount,
+            l_statistics.framesPerSecond
+        );
+    }
+    /// @endcode
+    //! <b>[match]</b>
+}
+
+int main( int _argumentsCount, char** _arguments ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const std::string l_keys =
+        "{help h    |                | print this message }"
+        "{@command  |                | file, directory, window or stream }"
+        "{@source   |                | sample image, images directory, window names or video }"
+        "{method    | 1              | match method, cv::TemplateMatchModes or 6 for ORB features }"
+        "{templates |                | comma separated template images }"
+        "{extension | .png           | images extension of directory }"
+        "{threads   | 0              | matching threads, 0 for all cores }"
+        "{fps       | 30             | frame rate of window matching }"
+        "{scale     | 1              | window capture downscale, 2 or 4 for coarse matching }"
+        "{seconds   | 0              | duration of window matching, 0 until interrupted }"
+        "{output    | detections.csv | detections of stream, JSON if it ends with .json }"
+        "{threshold |                | score of stream detection, maximum for squared difference, method default if empty }"
+        "{show      | false          | show found templates in window }"
+        "{profile   |                | tuning profile, fastest strategy of every template is kept in it }"
+        "{core      | -1             | core to pin capture thread to, -1 unpinned }"
+        "{cores     |                | comma separated cores to pin matching threads to }"
+        "{prefault  | false          | fault in buffers and lock process memory before window matching }"
+        "{busy      | false          | busy poll until next frame instead of sleeping }"
+        "{target    | 0              | capture to result latency target in milliseconds, late ring frames are dropped }"
+        "{metrics   |                | Unix domain socket to serve metrics on }"
+        "{trace     |                | Chrome trace JSON written at exit }";
+
+    cv::CommandLineParser l_parser( _argumentsCount, _arguments, l_keys );
+
+    l_parser.about( "Template matching on images, image directories, windows and videos" );
+
+    const std::string l_command = l_parser.get< std::string >( "@command" );
+    const std::string l_source  = l_parser.get< std::string >( "@source" );
+
+    if (
+        l_parser.has( "help" ) ||
+        l_source.empty() ||
+        ( ( l_command != "file" ) && ( l_command != "directory" ) && ( l_command != "window" ) && ( l_command != "stream" ) )
+    ) {
+        l_parser.printMessage();
+
+        return ( l_parser.has( "help" ) ? EXIT_SUCCESS : EXIT_FAILURE );
+    }
+
+    std::signal( SIGINT, interrupt );
+    std::signal( SIGTERM, interrupt );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    try {
+        //! <b>[observe]</b>
+        /// @code{.cpp}
+        const uint32_t    l_matchMethod = l_parser.get< uint32_t >( "method" );
+        const std::string l_metrics     = l_parser.get< std::string >( "metrics" );
+        const std::string l_trace       = l_parser.get< std::string >( "trace" );
+
+        if ( !l_metrics.empty() ) {
+            startMetricsServer( l_metrics );
+        }
+
+        enableTracing( !l_trace.empty() );
+        /// @endcode
+        //! <b>[observe]</b>
+
+        //! <b>[match]</b>
+        /// Directory templates are taken from file names, see \c readImageDirectory .
+        /// @code{.cpp}
+        if ( l_command == "directory" ) {
+            fmt::print( "sample,template,x,y,score,found\n" );
+
+            for ( const batchResult_t& _batchResult : matchingMethodBatch(
+                l_matchMethod,
+                readImageDirectory( l_source, l_parser.get< std::string >( "extension" ) )
+            ) ) {
+                printResult( _batchResult.sourceImage, _batchResult.templateImage, _batchResult.result );
+            }
+
+        } else {
+            matchSession( l_parser, l_command, l_source, l_matchMethod );
+        }
+        /// @endcode
+        //! <b>[match]</b>
+
+        //! <b>[trace]</b>
+        /// @code{.cpp}
+        if ( !l_trace.empty() ) {
+            writeTrace( l_trace );
+        }
+
+        stopMetricsServer();
+        /// @endcode
+        //! <b>[trace]</b>
+
+        return ( EXIT_SUCCESS );
+
+    } catch ( const std::exception& _exception ) {
+        fmt::print( stderr, "{}\n", _exception.what() );
+
+        return ( EXIT_FAILURE );
+    }
+}
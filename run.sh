@@ -1,6 +1,4 @@
 #!/bin/bash
-R CMD SHLIB -c src/matching.cpp
-
-mv src/matching.so .
+R CMD SHLIB -c -o matching.so src/matching.cpp src/bindings.cpp
 
 Rscript src/main.r
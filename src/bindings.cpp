@@ -0,0 +1,818 @@
+///////////////
+/// @file bindings.cpp
+/// @brief R \c .C and \c .Call entry points over matching library.
+///////////////
+#include <Rcpp.h>
+
+#include "matching.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+///////////////
+/// @brief Convert batch results to R data frame.
+/// @param[in] _batchResults Results of \c matchingMethodBatch .
+/// @return Data frame with sample, template, x, y, score and found columns.
+///////////////
+static Rcpp::DataFrame toDataFrame( const std::vector< batchResult_t >& _batchResults ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const size_t          l_resultsCount = _batchResults.size();
+    Rcpp::CharacterVector l_sourceImages( l_resultsCount );
+    Rcpp::CharacterVector l_templateImages( l_resultsCount );
+    Rcpp::NumericVector   l_x( l_resultsCount );
+    Rcpp::NumericVector   l_y( l_resultsCount );
+    Rcpp::NumericVector   l_score( l_resultsCount );
+    Rcpp::LogicalVector   l_found( l_resultsCount );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[fill]</b>
+    /// @code{.cpp}
+    for ( size_t _resultIndex = 0; _resultIndex < l_resultsCount; _resultIndex++ ) {
+        const batchResult_t& l_batchResult = _batchResults[ _resultIndex ];
+
+        l_sourceImages[ _resultIndex ]   = l_batchResult.sourceImage;
+        l_templateImages[ _resultIndex ] = l_batchResult.templateImage;
+        l_x[ _resultIndex ]              = l_batchResult.result.x;
+        l_y[ _resultIndex ]              = l_batchResult.result.y;
+        l_score[ _resultIndex ]          = l_batchResult.result.score;
+        l_found[ _resultIndex ]          = l_batchResult.result.found;
+    }
+    /// @endcode
+    //! <b>[fill]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return (
+        Rcpp::DataFrame::create(
+            Rcpp::Named( "sample" )           = l_sourceImages,
+            Rcpp::Named( "template" )         = l_templateImages,
+            Rcpp::Named( "x" )                = l_x,
+            Rcpp::Named( "y" )                = l_y,
+            Rcpp::Named( "score" )            = l_score,
+            Rcpp::Named( "found" )            = l_found,
+            Rcpp::Named( "stringsAsFactors" ) = false
+        )
+    );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Compares a template against overlapped image regions.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes or \c FEATURE_MATCH_METHOD .
+/// @param[in] _sourceImage Image where the search is running. It must be 8-bit or 32-bit floating-point.
+/// @param[in] _templateImage Searched template. It must be not greater than the source image and have the same data type.
+/// @param[in] _searchResults Array to store result.
+/// @param[in] _showResult Will print out squares of found images to window.
+///////////////
+extern "C" void matchingMethodFile(
+    uint32_t*   _matchMethod,
+    char**      _sourceImage,
+    char**      _templateImage,
+    double*     _searchResults,
+    const bool* _showResult
+) {
+    const matchResult_t l_result = matchingMethodFile(
+        *_matchMethod,
+        std::string( *_sourceImage ),
+        { std::string( *_templateImage ) },
+        *_showResult
+    )[ 0 ];
+
+    _searchResults[ 0 ] = l_result.x;
+    _searchResults[ 1 ] = l_result.y;
+}
+
+///////////////
+/// @brief Compares a template against overlapped image regions.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes or \c FEATURE_MATCH_METHOD .
+/// @param[in] _sourceWindowName Window where the search is running.
+/// @param[in] _templateImage Searched template. It must be not greater than the source image and have the same data type.
+/// @param[in] _searchResults Array to store result.
+/// @param[in] _showResult Will print out squares of found images to other window.
+///////////////
+extern "C" void matchingMethodWindow(
+    uint32_t*   _matchMethod,
+    char**      _sourceWindowName,
+    char**      _templateImage,
+    double*     _searchResults,
+    const bool* _showResult
+) {
+    const matchResult_t l_result = matchingMethodWindow(
+        *_matchMethod,
+        std::string( *_sourceWindowName ),
+        { std::string( *_templateImage ) },
+        *_showResult
+    )[ 0 ];
+
+    _searchResults[ 0 ] = l_result.x;
+    _searchResults[ 1 ] = l_result.y;
+}
+
+///////////////
+/// @brief Get allocation counters.
+/// @details Enables process wide \c cv::Mat allocation counter on first call.
+/// @param[in] _poolAllocations Array to store buffers allocated by default pool.
+/// @param[in] _matAllocations Array to store \c cv::Mat heap allocations since first call.
+///////////////
+extern "C" void allocationCount(
+    double* _poolAllocations,
+    double* _matAllocations
+) {
+    enableAllocationCounter();
+
+    _poolAllocations[ 0 ] = getDefaultMatPool().allocations();
+    _matAllocations[ 0 ]  = getMatAllocationsCount();
+}
+
+///////////////
+/// @brief Left clicks on window by coordinates.
+/// @details Returns once click is queued, see \c queueLeftClick .
+/// @param[in] _windowName Window name.
+/// @param[in] _coordinateX X relative to window.
+/// @param[in] _coordinateY Y relative to window.
+///////////////
+extern "C" void leftMouseClick(
+    char**    _windowName,
+    uint32_t* _coordinateX,
+    uint32_t* _coordinateY
+) {
+    queueLeftClick(
+        std::string( *_windowName ),
+        *_coordinateX,
+        *_coordinateY
+    );
+}
+
+///////////////
+/// @brief Compares all templates of images directory against their samples.
+/// @details Errors are raised as R errors.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+/// @param[in] _directory Images directory.
+/// @param[in] _extension Images extension.
+/// @return Data frame of results.
+///////////////
+extern "C" SEXP matchingMethodDirectory(
+    SEXP _matchMethod,
+    SEXP _directory,
+    SEXP _extension
+) {
+    BEGIN_RCPP
+
+    return (
+        toDataFrame(
+            matchingMethodBatch(
+                Rcpp::as< uint32_t >( _matchMethod ),
+                readImageDirectory(
+                    Rcpp::as< std::string >( _directory ),
+                    Rcpp::as< std::string >( _extension )
+                )
+            )
+        )
+    );
+
+    END_RCPP
+}
+
+///////////////
+/// @brief Compares templates against their samples.
+/// @details Errors are raised as R errors.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+/// @param[in] _manifest Named list, names are sample paths and values are template paths.
+/// @return Data frame of results.
+///////////////
+extern "C" SEXP matchingMethodManifest(
+    SEXP _matchMethod,
+    SEXP _manifest
+) {
+    BEGIN_RCPP
+
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    Rcpp::List            l_list( _manifest );
+    Rcpp::CharacterVector l_sourceImages( l_list.names() );
+    manifest_t            l_manifest;
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[manifest]</b>
+    /// @code{.cpp}
+    for ( size_t _sampleIndex = 0; _sampleIndex < l_list.size(); _sampleIndex++ ) {
+        l_manifest.emplace_back(
+            Rcpp::as< std::string >( l_sourceImages[ _sampleIndex ] ),
+            Rcpp::as< std::vector< std::string > >( l_list[ _sampleIndex ] )
+        );
+    }
+    /// @endcode
+    //! <b>[manifest]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return (
+        toDataFrame(
+            matchingMethodBatch(
+                Rcpp::as< uint32_t >( _matchMethod ),
+                l_manifest
+            )
+        )
+    );
+    /// @endcode
+    //! <b>[return]</b>
+
+    END_RCPP
+}
+
+///////////////
+/// @brief Change byte budget of decoded images cache shared by all calls.
+/// @details Errors are raised as R errors.
+/// @param[in] _budget Bytes of decoded images, 0 disables cache.
+/// @return \c NULL .
+///////////////
+extern "C" SEXP setImageCacheBudget( SEXP _budget ) {
+    BEGIN_RCPP
+
+    getImageCache().setBudget( Rcpp::as< double >( _budget ) );
+
+    return ( R_NilValue );
+
+    END_RCPP
+}
+
+///////////////
+/// @brief Counters of decoded images cache.
+/// @details Errors are raised as R errors.
+/// @return Named numeric vector.
+///////////////
+extern "C" SEXP imageCacheStatistics( void ) {
+    BEGIN_RCPP
+
+    const imageCacheStatistics_t l_statistics = getImageCache().statistics();
+
+    return (
+        Rcpp::NumericVector::create(
+            Rcpp::Named( "hits" )          = l_statistics.hits,
+            Rcpp::Named( "misses" )        = l_statistics.misses,
+            Rcpp::Named( "evictions" )     = l_statistics.evictions,
+            Rcpp::Named( "invalidations" ) = l_statistics.invalidations,
+            Rcpp::Named( "images" )        = l_statistics.imagesCount,
+            Rcpp::Named( "bytes" )         = l_statistics.bytes,
+            Rcpp::Named( "budget" )        = l_statistics.budget
+        )
+    );
+
+    END_RCPP
+}
+
+///////////////
+/// @brief Turn recording of per-stage trace events on or off.
+/// @details Errors are raised as R errors.
+/// @param[in] _isEnabled Record trace events.
+/// @return \c NULL .
+///////////////
+extern "C" SEXP setTracing( SEXP _isEnabled ) {
+    BEGIN_RCPP
+
+    enableTracing( Rcpp::as< bool >( _isEnabled ) );
+
+    return ( R_NilValue );
+
+    END_RCPP
+}
+
+///////////////
+/// @brief Write recorded trace events as Chrome trace JSON.
+/// @details Errors are raised as R errors.
+/// @param[in] _path Output file, opened with chrome://tracing or Perfetto.
+/// @return Events count written.
+///////////////
+extern "C" SEXP exportTrace( SEXP _path ) {
+    BEGIN_RCPP
+
+    return ( Rcpp::wrap( static_cast< double >( writeTrace( Rcpp::as< std::string >( _path ) ) ) ) );
+
+    END_RCPP
+}
+
+///////////////
+/// @brief Drop recorded trace events.
+/// @details Errors are raised as R errors.
+/// @return \c NULL .
+///////////////
+extern "C" SEXP resetTrace( void ) {
+    BEGIN_RCPP
+
+    clearTrace();
+
+    return ( R_NilValue );
+
+    END_RCPP
+}
+
+///////////////
+/// @brief Serve metrics on Unix domain socket for external scrapers.
+/// @details Errors are raised as R errors.
+/// @param[in] _socketPath Socket path, empty to stop serving.
+/// @return \c NULL .
+///////////////
+extern "C" SEXP serveMetrics( SEXP _socketPath ) {
+    BEGIN_RCPP
+
+    const std::string l_socketPath = Rcpp::as< std::string >( _socketPath );
+
+    if ( l_socketPath.empty() ) {
+        stopMetricsServer();
+
+    } else {
+        startMetricsServer( l_socketPath );
+    }
+
+    return ( R_NilValue );
+
+    END_RCPP
+}
+
+///////////////
+/// @brief Current metrics, the same text socket serves.
+/// @details Errors are raised as R errors.
+/// @param[in] _isJson JSON instead of Prometheus text.
+/// @return Character scalar.
+///////////////
+extern "C" SEXP metricsText( SEXP _isJson ) {
+    BEGIN_RCPP
+
+    return ( Rcpp::wrap( formatMetrics( Rcpp::as< bool >( _isJson ) ) ) );
+
+    END_RCPP
+}
+
+///////////////
+/// @brief Capture window into frame ring, blocks until frames count is captured.
+/// @details Errors are raised as R errors.
+/// @param[in] _windowName Window name.
+/// @param[in] _ringName Shared memory name like "/frames" or file path.
+/// @param[in] _framesPerSecond Frame rate.
+/// @param[in] _framesCount Frames to capture, 0 for endless.
+/// @param[in] _slotsCount Frames kept.
+/// @param[in] _isFileBacked Ring name is file path.
+/// @return \c NULL .
+///////////////
+extern "C" SEXP captureToFrameRing(
+    SEXP _windowName,
+    SEXP _ringName,
+    SEXP _framesPerSecond,
+    SEXP _framesCount,
+    SEXP _slotsCount,
+    SEXP _isFileBacked
+) {
+    BEGIN_RCPP
+
+    captureWindowToFrameRing(
+        Rcpp::as< std::string >( _windowName ),
+        Rcpp::as< std::string >( _ringName ),
+        Rcpp::as< double >( _framesPerSecond ),
+        Rcpp::as< double >( _framesCount ),
+        Rcpp::as< uint32_t >( _slotsCount ),
+        Rcpp::as< bool >( _isFileBacked )
+    );
+
+    return ( R_NilValue );
+
+    END_RCPP
+}
+
+///////////////
+/// @brief Convert session results to R data frame.
+/// @param[in] _session Session results belong to.
+/// @param[in] _results Results indexed by template ID.
+/// @return Data frame with template, x, y, score, found and frame columns.
+///////////////
+static Rcpp::DataFrame toDataFrame(
+    const matchingSession_t&            _session,
+    const std::vector< matchResult_t >& _results
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const size_t          l_resultsCount = _results.size();
+    Rcpp::CharacterVector l_templateImages( l_resultsCount );
+    Rcpp::NumericVector   l_x( l_resultsCount );
+    Rcpp::NumericVector   l_y( l_resultsCount );
+    Rcpp::NumericVector   l_score( l_resultsCount );
+    Rcpp::LogicalVector   l_found( l_resultsCount );
+    Rcpp::NumericVector   l_frame( l_resultsCount );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[fill]</b>
+    /// @code{.cpp}
+    for ( size_t _templateId = 0; _templateId < l_resultsCount; _templateId++ ) {
+        l_templateImages[ _templateId ] = _session.templateImages()[ _templateId ];
+        l_x[ _templateId ]              = _results[ _templateId ].x;
+        l_y[ _templateId ]              = _results[ _templateId ].y;
+        l_score[ _templateId ]          = _results[ _templateId ].score;
+        l_found[ _templateId ]          = _results[ _templateId ].found;
+        l_frame[ _templateId ]          = _results[ _templateId ].frame;
+    }
+    /// @endcode
+    //! <b>[fill]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return (
+        Rcpp::DataFrame::create(
+            Rcpp::Named( "template" )         = l_templateImages,
+            Rcpp::Named( "x" )                = l_x,
+            Rcpp::Named( "y" )                = l_y,
+            Rcpp::Named( "score" )            = l_score,
+            Rcpp::Named( "found" )            = l_found,
+            Rcpp::Named( "frame" )            = l_frame,
+            Rcpp::Named( "stringsAsFactors" ) = false
+        )
+    );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Convert run loop events to R data frame.
+/// @param[in] _session Session events belong to.
+/// @param[in] _events Events in order they happened.
+/// @return Data frame with template, x, y, score, found, frame and clicked columns.
+///////////////
+static Rcpp::DataFrame toDataFrame(
+    const matchingSession_t&             _session,
+    const std::vector< sessionEvent_t >& _events
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const size_t          l_eventsCount = _events.size();
+    Rcpp::CharacterVector l_templateImages( l_eventsCount );
+    Rcpp::NumericVector   l_x( l_eventsCount );
+    Rcpp::NumericVector   l_y( l_eventsCount );
+    Rcpp::NumericVector   l_score( l_eventsCount );
+    Rcpp::LogicalVector   l_found( l_eventsCount );
+    Rcpp::NumericVector   l_frame( l_eventsCount );
+    Rcpp::LogicalVector   l_clicked( l_eventsCount );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[fill]</b>
+    /// @code{.cpp}
+    for ( size_t _eventIndex = 0; _eventIndex < l_eventsCount; _eventIndex++ ) {
+        const sessionEvent_t& l_event = _events[ _eventIndex ];
+
+        l_templateImages[ _eventIndex ] = _session.templateImages()[ l_event.templateId ];
+        l_x[ _eventIndex ]              = l_event.result.x;
+        l_y[ _eventIndex ]              = l_event.result.y;
+        l_score[ _eventIndex ]          = l_event.result.score;
+        l_found[ _eventIndex ]          = l_event.result.found;
+        l_frame[ _eventIndex ]          = l_event.result.frame;
+        l_clicked[ _eventIndex ]        = l_event.clicked;
+    }
+    /// @endcode
+    //! <b>[fill]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return (
+        Rcpp::DataFrame::create(
+            Rcpp::Named( "template" )         = l_templateImages,
+            Rcpp::Named( "x" )                = l_x,
+            Rcpp::Named( "y" )                = l_y,
+            Rcpp::Named( "score" )            = l_score,
+            Rcpp::Named( "found" )            = l_found,
+            Rcpp::Named( "frame" )            = l_frame,
+            Rcpp::Named( "clicked" )          = l_clicked,
+            Rcpp::Named( "stringsAsFactors" ) = false
+        )
+    );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Convert results of session windows to R data frame.
+/// @param[in] _session Session results belong to.
+/// @param[in] _windowResults Results ordered by window ID.
+/// @return Data frame with window, template, x, y, score, found and frame columns.
+///////////////
+static Rcpp::DataFrame toDataFrame(
+    const matchingSession_t&             _session,
+    const std::vector< windowResult_t >& _windowResults
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const size_t          l_resultsCount = _windowResults.size();
+    Rcpp::IntegerVector   l_windowIds( l_resultsCount );
+    Rcpp::CharacterVector l_templateImages( l_resultsCount );
+    Rcpp::NumericVector   l_x( l_resultsCount );
+    Rcpp::NumericVector   l_y( l_resultsCount );
+    Rcpp::NumericVector   l_score( l_resultsCount );
+    Rcpp::LogicalVector   l_found( l_resultsCount );
+    Rcpp::NumericVector   l_frame( l_resultsCount );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[fill]</b>
+    /// @code{.cpp}
+    for ( size_t _resultIndex = 0; _resultIndex < l_resultsCount; _resultIndex++ ) {
+        const windowResult_t& l_windowResult = _windowResults[ _resultIndex ];
+
+        l_windowIds[ _resultIndex ]      = static_cast< int >( l_windowResult.windowId );
+        l_templateImages[ _resultIndex ] = _session.templateImages()[ l_windowResult.templateId ];
+        l_x[ _resultIndex ]              = l_windowResult.result.x;
+        l_y[ _resultIndex ]              = l_windowResult.result.y;
+        l_score[ _resultIndex ]          = l_windowResult.result.score;
+        l_found[ _resultIndex ]          = l_windowResult.result.found;
+        l_frame[ _resultIndex ]          = l_windowResult.result.frame;
+    }
+    /// @endcode
+    //! <b>[fill]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return (
+        Rcpp::DataFrame::create(
+            Rcpp::Named( "window" )           = l_windowIds,
+            Rcpp::Named( "template" )         = l_templateImages,
+            Rcpp::Named( "x" )                = l_x,
+            Rcpp::Named( "y" )                = l_y,
+            Rcpp::Named( "score" )            = l_score,
+            Rcpp::Named( "found" )            = l_found,
+            Rcpp::Named( "frame" )            = l_frame,
+            Rcpp::Named( "stringsAsFactors" ) = false
+        )
+    );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+static int sessionAddTemplate( matchingSession_t* _session, std::string _templateImage ) {
+    return ( static_cast< int >( _session->addTemplate( _templateImage ) ) );
+}
+
+static void sessionSetWindow( matchingSession_t* _session, std::string _windowName ) {
+    _session->setWindow( _windowName );
+}
+
+static void sessionSetFrameRing( matchingSession_t* _session, std::string _ringName, bool _isFileBacked ) {
+    _session->setFrameRing( _ringName, _isFileBacked );
+}
+
+static void sessionSetRecorder( matchingSession_t* _session, std::string _path, bool _isCompressed ) {
+    _session->setRecorder( _path, _isCompressed );
+}
+
+static void sessionSetReplay( matchingSession_t* _session, std::string _path, bool _isRealTime ) {
+    _session->setReplay( _path, _isRealTime );
+}
+
+static bool sessionIsReplayFinished( matchingSession_t* _session ) {
+    return ( _session->isReplayFinished() );
+}
+
+static Rcpp::DataFrame sessionRecordedResults( matchingSession_t* _session ) {
+    return ( toDataFrame( *_session, _session->recordedResults() ) );
+}
+
+static void sessionSetShowResult( matchingSession_t* _session, bool _showResult ) {
+    _session->setShowResult( _showResult );
+}
+
+static void sessionSetIncremental( matchingSession_t* _session, bool _isIncremental ) {
+    _session->setIncremental( _isIncremental );
+}
+
+static int sessionAddWindow( matchingSession_t* _session, std::string _windowName, Rcpp::IntegerVector _templateIds ) {
+    return (
+        static_cast< int >(
+            _session->addWindow( _windowName, std::vector< size_t >( _templateIds.begin(), _templateIds.end() ) )
+        )
+    );
+}
+
+static Rcpp::DataFrame sessionMatchWindows( matchingSession_t* _session ) {
+    return ( toDataFrame( *_session, _session->matchWindows() ) );
+}
+
+static void sessionSetCaptureScale( matchingSession_t* _session, int _downscale ) {
+    _session->setCaptureScale( static_cast< uint32_t >( std::max( _downscale, 0 ) ) );
+}
+
+static void sessionSetTuningProfile( matchingSession_t* _session, std::string _path ) {
+    _session->setTuningProfile( _path );
+}
+
+static Rcpp::DataFrame sessionTunings( matchingSession_t* _session ) {
+    const std::vector< std::string >      l_templateImages = _session->templateImages();
+    const std::vector< templateTuning_t > l_tunings        = _session->templateTunings();
+    Rcpp::CharacterVector                 l_strategies( l_tunings.size() );
+    Rcpp::NumericVector                   l_costs( l_tunings.size() );
+    Rcpp::LogicalVector                   l_isTuned( l_tunings.size() );
+
+    for ( size_t _templateId = 0; _templateId < l_tunings.size(); _templateId++ ) {
+        l_strategies[ _templateId ] = matchStrategyName( l_tunings[ _templateId ].strategy );
+        l_costs[ _templateId ]      = ( l_tunings[ _templateId ].cost.count() / 1000.0 );
+        l_isTuned[ _templateId ]    = ( l_tunings[ _templateId ].hash != 0 );
+    }
+
+    return (
+        Rcpp::DataFrame::create(
+            Rcpp::Named( "template" )         = l_templateImages,
+            Rcpp::Named( "strategy" )         = l_strategies,
+            Rcpp::Named( "costMicroseconds" ) = l_costs,
+            Rcpp::Named( "tuned" )            = l_isTuned,
+            Rcpp::Named( "stringsAsFactors" ) = false
+        )
+    );
+}
+
+static Rcpp::DataFrame sessionMatchFile( matchingSession_t* _session, std::string _sourceImage ) {
+    return ( toDataFrame( *_session, _session->matchFile( _sourceImage ) ) );
+}
+
+static Rcpp::DataFrame sessionMatchWindow( matchingSession_t* _session ) {
+    return ( toDataFrame( *_session, _session->matchWindow() ) );
+}
+
+static Rcpp::NumericVector sessionMatchStream(
+    matchingSession_t* _session,
+    std::string        _source,
+    std::string        _outputPath,
+    std::string        _extension
+) {
+    const streamStatistics_t l_statistics = _session->matchStream( _source, _outputPath, _extension );
+
+    return (
+        Rcpp::NumericVector::create(
+            Rcpp::Named( "frames" )     = l_statistics.framesCount,
+            Rcpp::Named( "detections" ) = l_statistics.detectionsCount,
+            Rcpp::Named( "seconds" )    = l_statistics.seconds,
+            Rcpp::Named( "wait" )       = l_statistics.waitSeconds,
+            Rcpp::Named( "fps" )        = l_statistics.framesPerSecond
+        )
+    );
+}
+
+static void sessionSetScoreThreshold( matchingSession_t* _session, double _threshold ) {
+    _session->setScoreThreshold( _threshold );
+}
+
+static Rcpp::DataFrame sessionResults( matchingSession_t* _session ) {
+    return ( toDataFrame( *_session, _session->results().snapshot() ) );
+}
+
+static void sessionAddClickRule(
+    matchingSession_t* _session,
+    int                _templateId,
+    double             _coordinateX,
+    double             _coordinateY,
+    double             _tolerance,
+    double             _cooldownMilliseconds,
+    std::string        _windowName
+) {
+    clickRule_t l_rule;
+
+    l_rule.templateId = _templateId;
+    l_rule.x          = _coordinateX;
+    l_rule.y          = _coordinateY;
+    l_rule.tolerance  = _tolerance;
+    l_rule.windowName = _windowName;
+    l_rule.cooldown   = std::chrono::milliseconds( static_cast< int64_t >( _cooldownMilliseconds ) );
+
+    _session->addClickRule( l_rule );
+}
+
+static void sessionSetTemplateSchedule(
+    matchingSession_t* _session,
+    int                _templateId,
+    int                _priority,
+    double             _minimumIntervalMilliseconds,
+    double             _deadlineMilliseconds
+) {
+    templateSchedule_t l_schedule;
+
+    l_schedule.priority        = _priority;
+    l_schedule.minimumInterval = std::chrono::milliseconds( static_cast< int64_t >( _minimumIntervalMilliseconds ) );
+    l_schedule.deadline        = std::chrono::milliseconds( static_cast< int64_t >( _deadlineMilliseconds ) );
+
+    _session->setTemplateSchedule( _templateId, l_schedule );
+}
+
+static void sessionSetFrameBudget( matchingSession_t* _session, double _frameBudgetMilliseconds ) {
+    _session->setFrameBudget(
+        std::chrono::microseconds( static_cast< int64_t >( _frameBudgetMilliseconds * 1000 ) )
+    );
+}
+
+static void sessionStart( matchingSession_t* _session, double _framesPerSecond ) {
+    _session->start( _framesPerSecond );
+}
+
+static void sessionStop( matchingSession_t* _session ) {
+    _session->stop();
+}
+
+static bool sessionIsRunning( matchingSession_t* _session ) {
+    return ( _session->isRunning() );
+}
+
+static Rcpp::DataFrame sessionEvents( matchingSession_t* _session ) {
+    return ( toDataFrame( *_session, _session->popEvents() ) );
+}
+
+static Rcpp::NumericVector sessionFrames( matchingSession_t* _session ) {
+    return (
+        Rcpp::NumericVector::create(
+            Rcpp::Named( "frames" ) = _session->framesCount(),
+            Rcpp::Named( "missed" ) = _session->missedFramesCount()
+        )
+    );
+}
+
+static void sessionSetLowLatency(
+    matchingSession_t*  _session,
+    int                 _captureCore,
+    Rcpp::IntegerVector _matcherCores,
+    bool                _isPrefaulting,
+    bool                _isBusyPolling,
+    double              _latencyTargetMilliseconds
+) {
+    lowLatency_t l_lowLatency;
+
+    l_lowLatency.captureCore   = _captureCore;
+    l_lowLatency.matcherCores  = std::vector< int >( _matcherCores.begin(), _matcherCores.end() );
+    l_lowLatency.isPrefaulting = _isPrefaulting;
+    l_lowLatency.isBusyPolling = _isBusyPolling;
+    l_lowLatency.latencyTarget = std::chrono::microseconds( static_cast< int64_t >( _latencyTargetMilliseconds * 1000 ) );
+
+    _session->setLowLatency( l_lowLatency );
+}
+
+static Rcpp::NumericVector sessionLatency( matchingSession_t* _session ) {
+    const latencyReport_t l_report = _session->latencyReport();
+
+    return (
+        Rcpp::NumericVector::create(
+            Rcpp::Named( "target" )  = ( l_report.target * 1000 ),
+            Rcpp::Named( "median" )  = ( l_report.median * 1000 ),
+            Rcpp::Named( "p99" )     = ( l_report.p99 * 1000 ),
+            Rcpp::Named( "maximum" ) = ( l_report.maximum * 1000 ),
+            Rcpp::Named( "frames" )  = l_report.framesCount,
+            Rcpp::Named( "dropped" ) = l_report.droppedFramesCount,
+            Rcpp::Named( "met" )     = l_report.isMet
+        )
+    );
+}
+
+//! <b>[module]</b>
+/// Loaded from R with \c Rcpp::Module("matcher", PACKAGE = dll) ,
+/// template IDs are zero-based rows of returned data frames.
+/// Run loop never calls into R, its events are taken with \c events() .
+/// @code{.cpp}
+RCPP_MODULE( matcher ) {
+    Rcpp::class_< matchingSession_t >( "Matcher" )
+        .constructor< uint32_t >( "Session with comparison method" )
+        .constructor< uint32_t, size_t >( "Session with comparison method and threads count" )
+        .method( "addTemplate", &sessionAddTemplate, "Load template, returns template ID" )
+        .method( "setWindow", &sessionSetWindow, "Open capture of window" )
+        .method( "addWindow", &sessionAddWindow, "Add window with template IDs searched on it, all if empty, returns window ID" )
+        .method( "matchWindows", &sessionMatchWindows, "Capture every added window and match its templates" )
+        .method( "setCaptureScale", &sessionSetCaptureScale, "Capture window downscaled on X server, results stay in window coordinates" )
+        .method( "setFrameRing", &sessionSetFrameRing, "Take window frames from frame ring of capture process" )
+        .method( "setShowResult", &sessionSetShowResult, "Show found images in window" )
+        .method( "setIncremental", &sessionSetIncremental, "Recompute only changed tiles of window frames" )
+        .method( "setTuningProfile", &sessionSetTuningProfile, "Tune matching strategy of templates, keep tunings in profile file" )
+        .method( "tunings", &sessionTunings, "Matching strategy and cost of templates" )
+        .method( "setRecorder", &sessionSetRecorder, "Record window frames with results to frame stream" )
+        .method( "setReplay", &sessionSetReplay, "Take window frames from recorded frame stream" )
+        .method( "replayFinished", &sessionIsReplayFinished, "All recorded frames were matched" )
+        .method( "recordedResults", &sessionRecordedResults, "Results recorded with last replayed frame" )
+        .method( "matchFile", &sessionMatchFile, "Match all templates on image file" )
+        .method( "matchWindow", &sessionMatchWindow, "Capture window and match all templates" )
+        .method( "matchStream", &sessionMatchStream, "Match video or images directory, write detections to CSV or JSON" )
+        .method( "setScoreThreshold", &sessionSetScoreThreshold, "Score of stream detection, NA for method default" )
+        .method( "results", &sessionResults, "Latest results" )
+        .method( "addClickRule", &sessionAddClickRule, "Click template found near coordinates from run loop, on window of frames if window is empty" )
+        .method( "setTemplateSchedule", &sessionSetTemplateSchedule, "Priority, minimum interval and deadline of template" )
+        .method( "setFrameBudget", &sessionSetFrameBudget, "Milliseconds of matching time per frame" )
+        .method( "start", &sessionStart, "Start native run loop with frame rate" )
+        .method( "stop", &sessionStop, "Stop native run loop" )
+        .method( "isRunning", &sessionIsRunning, "Native run loop is started" )
+        .method( "events", &sessionEvents, "Take queued run loop events" )
+        .method( "frames", &sessionFrames, "Run loop frames and missed deadlines counts" )
+        .method( "setLowLatency", &sessionSetLowLatency, "Capture core, matcher cores, prefault, busy poll and latency target milliseconds of run loop" )
+        .method( "latency", &sessionLatency, "Run loop capture to result milliseconds against target" );
+}
+/// @endcode
+//! <b>[module]</b>
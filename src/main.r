@@ -45,6 +45,7 @@ enum <- function(...) {
 # TM_CCORR_NORMED  - 3
 # TM_CCOEFF        - 4
 # TM_CCOEFF_NORMED - 5
+# FEATURES (ORB)   - 6, tolerates scale, rotation and partial occlusion
 # More on https://docs.opencv.org/4.x/df/dfb/group__imgproc__object.html
 
 match_method <- 1
@@ -62,10 +63,10 @@ data        <- new.env()
 coordinates <- new.env()
 
 if (.Platform$OS.type == "windows") {
-    dyn.load("matching.dll")
+    dll <- dyn.load("matching.dll")
 
 } else if (.Platform$OS.type == "unix") {
-    dyn.load("matching.so")
+    dll <- dyn.load("matching.so")
 }
 
 for (file_index in seq_len(length(files))) {
@@ -96,79 +97,80 @@ for (file_index in seq_len(length(files))) {
 print("data:")
 mget(ls(data), envir = data)
 
+results <- .Call(
+    "matchingMethodDirectory",
+    as.integer(match_method),
+    image_file_directory,
+    image_file_extension
+)
+
+for (result_index in seq_len(nrow(results))) {
+    value <- sub(
+        paste("\\", image_file_extension, "$", sep = ""),
+        "",
+        sub("^template\\.", "", basename(results$template[result_index])),
+        ignore.case = TRUE
+    )
+
+    coordinates[[value]] <- c(
+        results$x[result_index],
+        results$y[result_index]
+    )
+}
+
+print("coordinates:")
+mget(ls(coordinates), envir = coordinates)
+
+window_name <- "Window Name"
+
+Sys.sleep(3)
+
+matcher     <- Rcpp::Module("matcher", PACKAGE = dll)
+session     <- new(matcher$Matcher, as.integer(match_method))
+template_id <- new.env()
+
 for (key_index in seq_len(length(data))) {
     key <- ls(data)[key_index]
 
     for (value_index in seq_len(length(data[[key]]))) {
         value <- data[[key]][value_index]
 
-        returned_value <- .C(
-            "matchingMethodFile",
-            match_method = as.integer(match_method),
-            source_image = paste(
-                paste(image_file_directory, "/", sep = ""),
-                "sample.",
-                key,
-                image_file_extension,
-                sep = ""
-            ),
-            template_images = paste(
+        template_id[[value]] <- session$addTemplate(
+            paste(
                 paste(image_file_directory, "/", sep = ""),
                 "template.",
                 value,
                 image_file_extension,
                 sep = ""
-            ),
-            search_results = as.double(1:2),
-            show_result    = FALSE
-        )
-
-        coordinates[[value]] <- c(
-            returned_value$search_results[1],
-            returned_value$search_results[2]
+            )
         )
     }
 }
 
-print("coordinates:")
-mget(ls(coordinates), envir = coordinates)
+for (value in ls(template_id)) {
+    coordinate <- coordinates[[value]]
 
-window_name <- "Window Name"
+    session$addClickRule(
+        template_id[[value]],
+        coordinate[1],
+        coordinate[2],
+        0,
+        1000,
+        window_name
+    )
+}
 
-Sys.sleep(3)
+frames_per_second <- 30
+
+session$setShowResult(TRUE)
+session$setWindow(window_name)
+session$start(frames_per_second)
 
 while (TRUE) {
-    for (key_index in seq_len(length(data))) {
-        key <- ls(data)[key_index]
-
-        for (value_index in seq_len(length(data[[key]]))) {
-            value      <- data[[key]][value_index]
-            coordinate <- coordinates[[value]]
-
-            returned_value <- .C(
-                "matchingMethodWindow",
-                match_method       = as.integer(match_method),
-                source_window_name = window_name,
-                template_images    = paste(
-                    paste(image_file_directory, "/", sep = ""),
-                    "template.",
-                    value,
-                    image_file_extension,
-                    sep = ""
-                ),
-                search_results = as.double(1:2),
-                show_result    = TRUE
-            )
+    events <- session$events()
 
-            if (coordinate == returned_value$search_results) {
-                returned_value <- .C(
-                    "leftMouseClick",
-                    window_name = window_name,
-                    x = as.integer(coordinate[1]),
-                    y = as.integer(coordinate[2])
-                )
-            }
-        }
+    if (nrow(events) > 0) {
+        print(events)
     }
 
     Sys.sleep(1)
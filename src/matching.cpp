@@ -8,15 +8,26 @@
 
 #else // _WIN32
 
+#include <fcntl.h>
 #include <unistd.h>
 #include <regex.h>
 #include <sys/types.h>
 #include <sys/select.h>
 #include <sys/shm.h>
 #include <sys/ipc.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/extensions/Xrender.h>
 #include <X11/extensions/XShm.h>
+#include <X11/extensions/XTest.h>
 
 #endif // _WIN32
 
@@ -41,9 +52,12 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+#include <opencv4/opencv2/calib3d.hpp>
+#include <opencv4/opencv2/features2d.hpp>
 #include <opencv4/opencv2/highgui.hpp>
 #include <opencv4/opencv2/imgcodecs.hpp>
 #include <opencv4/opencv2/imgproc.hpp>
+#include <opencv4/opencv2/videoio.hpp>
 
 // Copyright (c) 2012 - present, Victor Zverovich
 
@@ -59,11 +73,24 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <fmt/core.h>
 
+#include "matching.hpp"
+
+#include <algorithm>
 #include <array>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <deque>
+#include <filesystem>
+#include <future>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <string>
 #include <stdlib.h>
 #include <stdexcept>
@@ -73,6 +100,44 @@
 //! <b>[define]</b>
 /// @code{.cpp}
 #define RESULT_WINDOW_NAME "Result window"
+#define FEATURE_MATCH_METHOD ( cv::TM_CCOEFF_NORMED + 1 )
+#define TEMPLATE_FEATURES_COUNT 500
+#define IMAGE_FEATURES_COUNT 5000
+#define FEATURE_RATIO_THRESHOLD 0.75
+#define FEATURE_MINIMUM_INLIERS 8
+#define FEATURE_REPROJECTION_THRESHOLD 3.0
+#define FEATURE_PATCH_SIZE 19
+#define CHANGE_TILE_SIZE 64
+#define TILE_HASH_PRIME 0x9E3779B97F4A7C15ULL
+#define FRAME_RING_MAGIC 0x474E495245524D46ULL // "FMRERING"
+#define FRAME_RING_VERSION 2
+#define FRAME_STREAM_MAGIC 0x4D52545345524D46ULL // "FMRESTRM"
+#define FRAME_STREAM_VERSION 1
+#define FRAME_STREAM_ALIGNMENT 64
+#define FRAME_STREAM_PNG_COMPRESSION 1
+#define FRAME_STREAM_QUEUE_SIZE 4 // Frames waiting for PNG encoding
+#define METRICS_SUB_BUCKET_BITS 4
+#define METRICS_SUB_BUCKETS_COUNT ( 1 << METRICS_SUB_BUCKET_BITS )
+#define METRICS_BUCKETS_COUNT ( ( 40 - METRICS_SUB_BUCKET_BITS + 1 ) * METRICS_SUB_BUCKETS_COUNT ) // Up to 2^40 ns
+#define METRICS_TEMPLATES_COUNT 64
+#define METRICS_BACKLOG 8
+#define METRICS_POLL_INTERVAL 100 // Milliseconds
+#define METRICS_REQUEST_TIMEOUT 100 // Milliseconds
+#define PYRAMID_MINIMUM_SIZE 8 // Smallest side of half resolution template
+#define PYRAMID_MARGIN 4 // Pixels around doubled coarse location searched on full resolution
+#define TUNE_ITERATIONS 3
+#define TUNE_LOCATION_TOLERANCE 2 // Pixels per axis strategy may differ from direct matching
+#define TUNING_PROFILE_VERSION 1
+#define SQDIFF_NORMED_THRESHOLD 0.1 // Default maximum score of stream detection
+#define CCORR_NORMED_THRESHOLD 0.95 // Default minimum score of stream detection
+#define CCOEFF_NORMED_THRESHOLD 0.8 // Default minimum score of stream detection
+#define BATCH_MINIMUM_TEMPLATES 4 // Same size templates correlated together
+#define BATCH_MAXIMUM_TEMPLATE_AREA ( 48 * 48 ) // Larger templates are left to DFT of matchTemplate
+#define BATCH_TILE_BYTES ( 128 * 1024 ) // Patch matrix of one tile, fits L2 cache with templates matrix
+#define LOW_LATENCY_WARMUP_FRAMES 2 // Frames matched before run loop starts, so buffers are faulted in
+#define FRAME_TIME_SMOOTHING 8 // Previous frames weight in expected matching time
+#define LOW_LATENCY_MAXIMUM_DROPS 4 // Stale ring frames dropped in a row before one is matched anyway
+#define FRAME_RING_HEADER_SIZE ( ( ( sizeof( frameRingHeader_t ) + CACHE_LINE_SIZE - 1 ) / CACHE_LINE_SIZE ) * CACHE_LINE_SIZE )
 /// @endcode
 //! <b>[define]</b>
 
@@ -96,846 +161,8528 @@ enum click_t {
 /// @endcode
 //! <b>[enum]</b>
 
-#ifdef _WIN32
+//! <b>[struct]</b>
+/// @code{.cpp}
+struct templateFeatures_t {
+    cv::Size                    size;
+    std::vector< cv::KeyPoint > keypoints;
+    cv::Mat                     descriptors;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[typedef]</b>
+/// Closed polygons of found templates to draw.
+/// @code{.cpp}
+typedef std::vector< std::vector< cv::Point > > outlines_t;
+/// @endcode
+//! <b>[typedef]</b>
+
+//! <b>[struct]</b>
+/// Click waiting in input queue.
+/// @code{.cpp}
+struct clickRequest_t {
+    std::string                           windowName;
+    uint32_t                              x;
+    uint32_t                              y;
+    click_t                               button;
+    std::chrono::milliseconds             holdTime;
+    std::chrono::steady_clock::time_point captureTime; // Unset for clicks not decided on frame
+};
+/// @endcode
+//! <b>[struct]</b>
 
 ///////////////
-/// @brief Get \c cv::Mat object from window capture.
-/// @param[in] _sourceWindowName Window handle.
-/// @return Window capture.
+/// @brief \c cv::MatAllocator counting heap allocations of wrapped allocator.
 ///////////////
-static cv::Mat getMatFromWindow( const std::string& _sourceWindowName ) {
-    //! <b>[declare]</b>
-    /// @code{.cpp}
-    cv::Mat          l_sourceImage;
-    BITMAPINFOHEADER l_bitmapInfo;
-    /// @endcode
-    //! <b>[declare]</b>
+class countingMatAllocator_t : public cv::MatAllocator {
+public:
+    explicit countingMatAllocator_t( cv::MatAllocator* _matAllocator ) : m_matAllocator( _matAllocator ) {}
+
+    cv::UMatData* allocate(
+        int                _dimensionsCount,
+        const int*         _sizes,
+        int                _type,
+        void*              _data,
+        size_t*            _step,
+        cv::AccessFlag     _flags,
+        cv::UMatUsageFlags _usageFlags
+    ) const override {
+        //! <b>[count]</b>
+        /// User provided data is not a heap allocation.
+        /// @code{.cpp}
+        if ( !_data ) {
+            size_t l_bytes = CV_ELEM_SIZE( _type );
 
-    //! <b>[window_info]</b>
-    /// @code{.cpp}
-    HWND l_sourceWindowHandle                  = FindWindow( NULL, _sourceWindowName.c_str() );
-    HDC  l_handleWindowDeviceContext           = GetDC( l_sourceWindowHandle );
-    HDC  l_handleWindowCompatibleDeviceContext = CreateCompatibleDC( l_handleWindowDeviceContext );
+            for ( int _dimensionIndex = 0; _dimensionIndex < _dimensionsCount; _dimensionIndex++ ) {
+                l_bytes *= _sizes[ _dimensionIndex ];
+            }
 
-    SetStretchBltMode(
-        l_handleWindowCompatibleDeviceContext,
-        COLORONCOLOR
-    );
+            m_allocations.fetch_add( 1, std::memory_order_relaxed );
+            m_bytes.fetch_add( l_bytes, std::memory_order_relaxed );
+        }
+        /// @endcode
+        //! <b>[count]</b>
 
-    RECT l_windowSize;
+        //! <b>[return]</b>
+        /// End of function.
+        /// @code{.cpp}
+        return (
+            m_matAllocator->allocate(
+                _dimensionsCount,
+                _sizes,
+                _type,
+                _data,
+                _step,
+                _flags,
+                _usageFlags
+            )
+        );
+        /// @endcode
+        //! <b>[return]</b>
+    }
 
-    GetClientRect(
-        l_sourceWindowHandle,
-        &l_windowSize
-    );
+    bool allocate(
+        cv::UMatData*      _data,
+        cv::AccessFlag     _flags,
+        cv::UMatUsageFlags _usageFlags
+    ) const override {
+        return ( m_matAllocator->allocate( _data, _flags, _usageFlags ) );
+    }
 
-    uint32_t l_sourceHeight = l_windowSize.bottom;
-    uint32_t l_sourceWidth  = l_windowSize.right;
-    uint32_t l_strechHeight = ( l_windowSize.bottom / 1 );
-    uint32_t l_strechWidth  = ( l_windowSize.right / 1 );
-    /// @endcode
-    //! <b>[window_info]</b>
+    void deallocate( cv::UMatData* _data ) const override {
+        m_matAllocator->deallocate( _data );
+    }
 
-    //! <b>[window_capture]</b>
-    /// Create empty image.
-    /// @code{.cpp}
-    l_sourceImage.create(
-        l_strechHeight,
-        l_strechWidth,
-        CV_8UC4
-    );
-    /// @endcode
-    //! <b>[window_capture]</b>
+    uint64_t allocations( void ) const {
+        return ( m_allocations.load( std::memory_order_relaxed ) );
+    }
 
-    //! <b>[bitmap]</b>
-    /// Create and assign values.
-    /// @code{.cpp}
-    HBITMAP l_handleBitmapWindow = CreateCompatibleBitmap(
-        l_handleWindowDeviceContext,
-        l_strechWidth,
-        l_strechHeight
-    );
+    uint64_t bytes( void ) const {
+        return ( m_bytes.load( std::memory_order_relaxed ) );
+    }
 
-    l_bitmapInfo.biSize          = sizeof( BITMAPINFOHEADER );
-    l_bitmapInfo.biWidth         = l_strechWidth;
-    l_bitmapInfo.biHeight        = -l_strechHeight; // This is the line that makes it draw upside down or not
-    l_bitmapInfo.biPlanes        = 1;
-    l_bitmapInfo.biBitCount      = 32;
-    l_bitmapInfo.biCompression   = BI_RGB;
-    l_bitmapInfo.biSizeImage     = 0;
-    l_bitmapInfo.biXPelsPerMeter = 0;
-    l_bitmapInfo.biYPelsPerMeter = 0;
-    l_bitmapInfo.biClrUsed       = 0;
-    l_bitmapInfo.biClrImportant  = 0;
-    /// @endcode
-    //! <b>[bitmap]</b>
+private:
+    cv::MatAllocator*               m_matAllocator;
+    mutable std::atomic< uint64_t > m_allocations = { 0 };
+    mutable std::atomic< uint64_t > m_bytes       = { 0 };
+};
 
-    //! <b>[window_capture]</b>
-    /// Use the previously created device context with the bitmap.
-    /// @code{.cpp}
-    SelectObject(
-        l_handleWindowCompatibleDeviceContext,
-        l_handleBitmapWindow
-    );
-    /// @endcode
+///////////////
+/// @brief Get process wide counting allocator.
+/// @return Counting allocator over OpenCV standard one.
+///////////////
+static countingMatAllocator_t& getCountingMatAllocator( void ) {
+    static countingMatAllocator_t l_countingMatAllocator( cv::Mat::getStdAllocator() );
 
-    /// Copy from the window device context to the bitmap device context.
-    /// Change SRCCOPY to NOTSRCCOPY for wacky colors.
-    /// @code{.cpp}
-    StretchBlt(
-        l_handleWindowCompatibleDeviceContext,
-        0,
-        0,
-        l_strechWidth,
-        l_strechHeight,
-        l_handleWindowDeviceContext,
-        0,
-        0,
-        l_sourceWidth,
-        l_sourceHeight,
-        SRCCOPY
-    );
-    /// @endcode
+    return ( l_countingMatAllocator );
+}
 
-    /// Copy from l_handleWindowCompatibleDeviceContext to l_handleBitmapWindow.
-    /// @code{.cpp}
-    GetDIBits(
-        l_handleWindowCompatibleDeviceContext,
-        l_handleBitmapWindow,
-        0,
-        l_strechHeight,
-        l_sourceImage.data,
-        (BITMAPINFO*)&l_bitmapInfo,
-        DIB_RGB_COLORS
-    );
-    /// @endcode
-    //! <b>[window_capture]</b>
+void enableAllocationCounter( void ) {
+    cv::Mat::setDefaultAllocator( &getCountingMatAllocator() );
+}
 
-    //! <b>[clean]</b>
-    /// Avoid memory leak.
+uint64_t getMatAllocationsCount( void ) {
+    return ( getCountingMatAllocator().allocations() );
+}
+
+uint64_t getMatAllocatedBytes( void ) {
+    return ( getCountingMatAllocator().bytes() );
+}
+
+//! <b>[struct]</b>
+/// Complete trace event, fields are atomic so events are read while owner thread records.
+/// @code{.cpp}
+struct traceEvent_t {
+    std::atomic< const char* > name     = { nullptr };
+    std::atomic< int64_t >     start    = { 0 };  // Nanoseconds of steady clock
+    std::atomic< int64_t >     duration = { 0 };
+    std::atomic< int64_t >     argument = { -1 }; // Template ID, -1 for none
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[struct]</b>
+/// Ring of events written only by owner thread.
+/// @code{.cpp}
+struct traceBuffer_t {
+    std::unique_ptr< traceEvent_t[] > events   = std::unique_ptr< traceEvent_t[] >( new traceEvent_t[ TRACE_EVENTS_COUNT ] );
+    std::atomic< uint64_t >           head     = { 0 };
+    std::atomic< uint64_t >           tail     = { 0 }; // First event not cleared
+    uint32_t                          threadId = 0;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[struct]</b>
+/// Buffers of all threads that recorded events, kept after thread exit.
+/// @code{.cpp}
+struct traceRegistry_t {
+    std::mutex                                      mutex;
+    std::vector< std::shared_ptr< traceBuffer_t > > buffers;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Tracing switch.
+/// @details Constant initialized, so checking it needs no guard.
+/// @return Tracing is enabled.
+///////////////
+static std::atomic< bool >& getTracingFlag( void ) {
+    static std::atomic< bool > l_isTracingEnabled = { false };
+
+    return ( l_isTracingEnabled );
+}
+
+static traceRegistry_t& getTraceRegistry( void ) {
+    static traceRegistry_t l_traceRegistry;
+
+    return ( l_traceRegistry );
+}
+
+///////////////
+/// @brief Ring of calling thread, registered on first event.
+/// @return Trace buffer.
+///////////////
+static traceBuffer_t& getTraceBuffer( void ) {
+    //! <b>[declare]</b>
     /// @code{.cpp}
-    DeleteObject( l_handleBitmapWindow );
-    DeleteDC( l_handleWindowCompatibleDeviceContext );
-    ReleaseDC(
-        l_sourceWindowHandle,
-        l_handleWindowDeviceContext
-    );
+    thread_local std::shared_ptr< traceBuffer_t > l_traceBuffer;
     /// @endcode
-    //! <b>[clean]</b>
+    //! <b>[declare]</b>
 
-    //! <b>[color]</b>
-    /// Convert source image to template's color format.
+    //! <b>[register]</b>
     /// @code{.cpp}
-    cv::Mat t_l_image;
+    if ( !l_traceBuffer ) {
+        traceRegistry_t&              l_traceRegistry = getTraceRegistry();
+        std::lock_guard< std::mutex > l_lock( l_traceRegistry.mutex );
 
-    cv::cvtColor(
-        l_sourceImage,
-        t_l_image,
-        cv::COLOR_RGB2BGR
-    );
+        l_traceBuffer           = std::make_shared< traceBuffer_t >();
+        l_traceBuffer->threadId = ( l_traceRegistry.buffers.size() + 1 );
+
+        l_traceRegistry.buffers.push_back( l_traceBuffer );
+    }
     /// @endcode
-    //! <b>[color]</b>
+    //! <b>[register]</b>
 
     //! <b>[return]</b>
     /// End of function.
     /// @code{.cpp}
-    return ( t_l_image );
+    return ( *l_traceBuffer );
     /// @endcode
     //! <b>[return]</b>
 }
 
-#else // _WIN32
-
 ///////////////
-/// @brief Get \c Window to needed window by name on \c Display .
-/// @details Recursive function
-/// @param[in] _display \c Display pointer.
-/// @param[in] _window default root window.
-/// @param[in] _windowName Window name.
-/// @return \c Window information.
+/// @brief Records duration of scope as trace event.
+/// @details Does nothing but one flag check if tracing is disabled when scope starts.
+/// Name must be string literal, only pointer is kept.
 ///////////////
-static Window windowSearch(
-    Display*       _display,
-    Window         _window,
-    const regex_t* _windowNameRegExp
-) {
-    //! <b>[declare]</b>
-    /// @code{.cpp}
-    Window        l_window = 0;
-    Window        l_root;
-    Window        l_parent;
-    Window*       l_children;
-    uint32_t      l_childrenCount;
-    int           l_windowNamesCount = 0;
-    XTextProperty l_xTextProperty;
-    char**        l_windowNamesList  = NULL;
-    /// @endcode
-    //! <b>[declare]</b>
+class traceScope_t {
+public:
+    explicit traceScope_t( const char* _name, int64_t _argument = -1 ) {
+        if ( getTracingFlag().load( std::memory_order_relaxed ) ) {
+            m_name     = _name;
+            m_argument = _argument;
+            m_start    = std::chrono::steady_clock::now();
+        }
+    }
 
-    //! <b>[check]</b>
-    /// Compare root window name to received.
+    ~traceScope_t( void ) {
+        end();
+    }
+
+    traceScope_t( const traceScope_t& ) = delete;
+    traceScope_t& operator=( const traceScope_t& ) = delete;
+
+    ///////////////
+    /// @brief Record event now instead of at scope exit.
+    ///////////////
+    void end( void ) {
+        //! <b>[check]</b>
+        /// @code{.cpp}
+        if ( !m_name ) {
+            return;
+        }
+        /// @endcode
+        //! <b>[check]</b>
+
+        //! <b>[record]</b>
+        /// Slot is filled before head is published.
+        /// @code{.cpp}
+        traceBuffer_t& l_traceBuffer = getTraceBuffer();
+        const uint64_t l_head        = l_traceBuffer.head.load( std::memory_order_relaxed );
+        traceEvent_t&  l_event       = l_traceBuffer.events[ l_head % TRACE_EVENTS_COUNT ];
+
+        l_event.name.store( m_name, std::memory_order_relaxed );
+        l_event.start.store(
+            std::chrono::duration_cast< std::chrono::nanoseconds >( m_start.time_since_epoch() ).count(),
+            std::memory_order_relaxed
+        );
+        l_event.duration.store(
+            std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - m_start ).count(),
+            std::memory_order_relaxed
+        );
+        l_event.argument.store( m_argument, std::memory_order_relaxed );
+
+        l_traceBuffer.head.store( ( l_head + 1 ), std::memory_order_release );
+
+        m_name = nullptr;
+        /// @endcode
+        //! <b>[record]</b>
+    }
+
+private:
+    const char*                           m_name     = nullptr;
+    int64_t                               m_argument = -1;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+void enableTracing( bool _isEnabled ) {
+    getTracingFlag().store( _isEnabled, std::memory_order_relaxed );
+}
+
+bool isTracingEnabled( void ) {
+    return ( getTracingFlag().load( std::memory_order_relaxed ) );
+}
+
+size_t writeTrace( const std::string& _path ) {
+    //! <b>[declare]</b>
     /// @code{.cpp}
-    XGetWMName( _display, _window, &l_xTextProperty );
+    std::vector< std::shared_ptr< traceBuffer_t > > l_traceBuffers;
+    size_t                                          l_eventsCount = 0;
+    std::unique_ptr< FILE, int( * )( FILE* ) >      l_output( std::fopen( _path.c_str(), "w" ), std::fclose );
 
-    if ( l_xTextProperty.nitems > 0 ) {
-        Xutf8TextPropertyToTextList(
-            _display,
-            &l_xTextProperty,
-            &l_windowNamesList,
-            &l_windowNamesCount
+    if ( !l_output ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't open trace {}",
+                _path
+            )
         );
+    }
 
-        for (
-            int _windowNameIndex = 0;
-            _windowNameIndex < l_windowNamesCount;
-            _windowNameIndex++
-        ) {
-            if (
-                regexec(
-                    _windowNameRegExp,
-                    l_windowNamesList[ _windowNameIndex ],
-                    0,
-                    NULL,
-                    0
-                ) == 0
-            ) {
-                XFreeStringList( l_windowNamesList );
-                XFree( l_xTextProperty.value );
+    {
+        traceRegistry_t&              l_traceRegistry = getTraceRegistry();
+        std::lock_guard< std::mutex > l_lock( l_traceRegistry.mutex );
 
-                return ( _window );
-            }
-        }
+        l_traceBuffers = l_traceRegistry.buffers;
     }
 
-    XFreeStringList( l_windowNamesList );
-    XFree( l_xTextProperty.value );
+    std::fputs( "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", l_output.get() );
     /// @endcode
-    //! <b>[check]</b>
+    //! <b>[declare]</b>
 
-    //! <b>[check_next]</b>
-    /// Compare all window names to received.
+    for ( const std::shared_ptr< traceBuffer_t >& _traceBuffer : l_traceBuffers ) {
+        //! <b>[copy]</b>
+        /// Events are copied first, then those owner thread could overwrite meanwhile are dropped.
+        /// @code{.cpp}
+        const uint64_t              l_head  = _traceBuffer->head.load( std::memory_order_acquire );
+        const uint64_t              l_first = std::max(
+            ( ( l_head > TRACE_EVENTS_COUNT ) ? ( l_head - TRACE_EVENTS_COUNT ) : 0 ),
+            std::min( _traceBuffer->tail.load( std::memory_order_relaxed ), l_head )
+        );
+        std::vector< traceEvent_t > l_events( l_head - l_first );
+
+        for ( uint64_t _index = l_first; _index < l_head; _index++ ) {
+            const traceEvent_t& l_event = _traceBuffer->events[ _index % TRACE_EVENTS_COUNT ];
+            traceEvent_t&       l_copy  = l_events[ _index - l_first ];
+
+            l_copy.name.store( l_event.name.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+            l_copy.start.store( l_event.start.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+            l_copy.duration.store( l_event.duration.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+            l_copy.argument.store( l_event.argument.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+        }
+
+        std::atomic_thread_fence( std::memory_order_acquire );
+
+        const uint64_t l_newHead = _traceBuffer->head.load( std::memory_order_relaxed );
+        const uint64_t l_valid   = ( ( ( l_newHead + 1 ) > TRACE_EVENTS_COUNT ) ? ( l_newHead + 1 - TRACE_EVENTS_COUNT ) : 0 );
+        /// @endcode
+        //! <b>[copy]</b>
+
+        //! <b>[write]</b>
+        /// Complete events with microsecond timestamps, template ID goes to arguments.
+        /// @code{.cpp}
+        for ( uint64_t _index = std::max( l_first, l_valid ); _index < l_head; _index++ ) {
+            const traceEvent_t& l_event    = l_events[ _index - l_first ];
+            const int64_t       l_argument = l_event.argument.load( std::memory_order_relaxed );
+
+            fmt::print(
+                l_output.get(),
+                "{}{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}",
+                ( l_eventsCount ? ",\n" : "\n" ),
+                l_event.name.load( std::memory_order_relaxed ),
+                _traceBuffer->threadId,
+                ( l_event.start.load( std::memory_order_relaxed ) / 1000.0 ),
+                ( l_event.duration.load( std::memory_order_relaxed ) / 1000.0 )
+            );
+
+            if ( l_argument >= 0 ) {
+                fmt::print( l_output.get(), ",\"args\":{{\"template\":{}}}", l_argument );
+            }
+
+            std::fputs( "}", l_output.get() );
+
+            l_eventsCount++;
+        }
+        /// @endcode
+        //! <b>[write]</b>
+    }
+
+    //! <b>[close]</b>
+    /// @code{.cpp}
+    std::fputs( "\n]}\n", l_output.get() );
+
+    if ( std::fflush( l_output.get() ) != 0 ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't write trace {}",
+                _path
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[close]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_eventsCount );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+void clearTrace( void ) {
+    traceRegistry_t&              l_traceRegistry = getTraceRegistry();
+    std::lock_guard< std::mutex > l_lock( l_traceRegistry.mutex );
+
+    for ( const std::shared_ptr< traceBuffer_t >& _traceBuffer : l_traceRegistry.buffers ) {
+        _traceBuffer->tail.store( _traceBuffer->head.load( std::memory_order_acquire ), std::memory_order_relaxed );
+    }
+}
+
+///////////////
+/// @brief Lock-free log-linear latency histogram in HDR style.
+/// @details Every power of two of nanoseconds is split into \c METRICS_SUB_BUCKETS_COUNT buckets,
+/// so recorded value is off by less than 1/16 of it. Values past last bucket go into it.
+///////////////
+class latencyHistogram_t {
+public:
+    void record( std::chrono::nanoseconds _latency ) {
+        const uint64_t l_value = static_cast< uint64_t >( std::max< int64_t >( _latency.count(), 0 ) );
+
+        m_buckets[ bucketIndex( l_value ) ].fetch_add( 1, std::memory_order_relaxed );
+        m_sum.fetch_add( l_value, std::memory_order_relaxed );
+    }
+
+    ///////////////
+    /// @brief Take counts of all buckets.
+    /// @param[out] _counts Counts indexed by bucket.
+    /// @return Recorded values count.
+    ///////////////
+    uint64_t snapshot( std::vector< uint64_t >& _counts ) const {
+        uint64_t l_count = 0;
+
+        _counts.resize( METRICS_BUCKETS_COUNT );
+
+        for ( size_t _bucketIndex = 0; _bucketIndex < METRICS_BUCKETS_COUNT; _bucketIndex++ ) {
+            _counts[ _bucketIndex ] = m_buckets[ _bucketIndex ].load( std::memory_order_relaxed );
+            l_count                += _counts[ _bucketIndex ];
+        }
+
+        return ( l_count );
+    }
+
+    double sum( void ) const {
+        return ( m_sum.load( std::memory_order_relaxed ) / 1e9 );
+    }
+
+    ///////////////
+    /// @brief Highest value equivalent to the one at quantile.
+    /// @param[in] _counts Bucket counts from \c snapshot .
+    /// @param[in] _count Recorded values count from \c snapshot .
+    /// @param[in] _quantile Quantile from 0 to 1.
+    /// @return Seconds, 0 if nothing was recorded.
+    ///////////////
+    static double quantile( const std::vector< uint64_t >& _counts, uint64_t _count, double _quantile ) {
+        //! <b>[rank]</b>
+        /// @code{.cpp}
+        const uint64_t l_rank = std::max< uint64_t >(
+            static_cast< uint64_t >( std::ceil( _quantile * _count ) ),
+            1
+        );
+        uint64_t       l_seen = 0;
+        /// @endcode
+        //! <b>[rank]</b>
+
+        //! <b>[find]</b>
+        /// @code{.cpp}
+        for ( size_t _bucketIndex = 0; ( _bucketIndex < _counts.size() ) && _count; _bucketIndex++ ) {
+            l_seen += _counts[ _bucketIndex ];
+
+            if ( l_seen >= l_rank ) {
+                return ( bucketLimit( _bucketIndex ) / 1e9 );
+            }
+        }
+        /// @endcode
+        //! <b>[find]</b>
+
+        //! <b>[return]</b>
+        /// End of function.
+        /// @code{.cpp}
+        return ( 0 );
+        /// @endcode
+        //! <b>[return]</b>
+    }
+
+private:
+    ///////////////
+    /// @brief Bucket of value, values below \c METRICS_SUB_BUCKETS_COUNT have own buckets.
+    /// @param[in] _value Nanoseconds.
+    /// @return Bucket index.
+    ///////////////
+    static size_t bucketIndex( uint64_t _value ) {
+        if ( _value < METRICS_SUB_BUCKETS_COUNT ) {
+            return ( _value );
+        }
+
+        const uint32_t l_shift = ( 63 - __builtin_clzll( _value ) - METRICS_SUB_BUCKET_BITS );
+        const size_t   l_index = (
+            ( ( l_shift + 1 ) * METRICS_SUB_BUCKETS_COUNT ) +
+            ( ( _value >> l_shift ) - METRICS_SUB_BUCKETS_COUNT )
+        );
+
+        return ( std::min< size_t >( l_index, ( METRICS_BUCKETS_COUNT - 1 ) ) );
+    }
+
+    ///////////////
+    /// @brief Highest value of bucket.
+    /// @param[in] _bucketIndex Bucket index.
+    /// @return Nanoseconds.
+    ///////////////
+    static uint64_t bucketLimit( size_t _bucketIndex ) {
+        if ( _bucketIndex < METRICS_SUB_BUCKETS_COUNT ) {
+            return ( _bucketIndex );
+        }
+
+        const uint32_t l_shift    = ( ( _bucketIndex / METRICS_SUB_BUCKETS_COUNT ) - 1 );
+        const uint64_t l_mantissa = ( METRICS_SUB_BUCKETS_COUNT + ( _bucketIndex % METRICS_SUB_BUCKETS_COUNT ) );
+
+        return ( ( ( l_mantissa + 1 ) << l_shift ) - 1 );
+    }
+
+    std::atomic< uint64_t > m_buckets[ METRICS_BUCKETS_COUNT ] = {};
+    std::atomic< uint64_t > m_sum = { 0 };
+};
+
+//! <b>[struct]</b>
+/// Process wide counters, updated with relaxed atomics only.
+/// @code{.cpp}
+struct metrics_t {
+    std::atomic< uint64_t >               framesCaptured = { 0 };
+    std::atomic< uint64_t >               framesSkipped  = { 0 }; // Run loop deadlines missed
+    std::atomic< int64_t >                queuedTasks    = { 0 }; // Thread pool indices not taken yet
+    latencyHistogram_t                    captureToClick;
+    std::unique_ptr< latencyHistogram_t[] > templates = std::unique_ptr< latencyHistogram_t[] >( new latencyHistogram_t[ METRICS_TEMPLATES_COUNT ]() ); // Last one takes higher IDs
+};
+/// @endcode
+//! <b>[struct]</b>
+
+static metrics_t& getMetrics( void ) {
+    static metrics_t l_metrics;
+
+    return ( l_metrics );
+}
+
+std::string formatMetrics( bool _isJson ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    metrics_t&              l_metrics = getMetrics();
+    std::string             l_text;
+    std::vector< uint64_t > l_counts;
+    const double            l_quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+    auto templateLabel = []( size_t _templateId ) {
+        return (
+            ( _templateId == ( METRICS_TEMPLATES_COUNT - 1 ) )
+            ? std::string( "other" )
+            : std::to_string( _templateId )
+        );
+    };
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[counters]</b>
+    /// @code{.cpp}
+    const uint64_t l_framesCaptured = l_metrics.framesCaptured.load( std::memory_order_relaxed );
+    const uint64_t l_framesSkipped  = l_metrics.framesSkipped.load( std::memory_order_relaxed );
+    const int64_t  l_queuedTasks    = std::max< int64_t >( l_metrics.queuedTasks.load( std::memory_order_relaxed ), 0 );
+    const size_t   l_queuedClicks   = pendingClicksCount();
+    const uint64_t l_allocations    = getMatAllocationsCount();
+    const uint64_t l_bytes          = getMatAllocatedBytes();
+    /// @endcode
+    //! <b>[counters]</b>
+
+    if ( _isJson ) {
+        //! <b>[json]</b>
+        /// Latencies are summaries in seconds.
+        /// @code{.cpp}
+        auto summary = [ & ]( const latencyHistogram_t& _histogram ) {
+            const uint64_t l_count = _histogram.snapshot( l_counts );
+
+            return (
+                fmt::format(
+                    "{{\"count\":{},\"sum\":{},\"p50\":{},\"p90\":{},\"p99\":{},\"p999\":{}}}",
+                    l_count,
+                    _histogram.sum(),
+                    latencyHistogram_t::quantile( l_counts, l_count, 0.5 ),
+                    latencyHistogram_t::quantile( l_counts, l_count, 0.9 ),
+                    latencyHistogram_t::quantile( l_counts, l_count, 0.99 ),
+                    latencyHistogram_t::quantile( l_counts, l_count, 0.999 )
+                )
+            );
+        };
+
+        l_text = fmt::format(
+            "{{\"frames_captured\":{},\"frames_skipped\":{},\"pool_queue_depth\":{},\"click_queue_depth\":{},"
+            "\"mat_allocations\":{},\"mat_allocated_bytes\":{},\"capture_to_click\":{},\"templates\":{{",
+            l_framesCaptured,
+            l_framesSkipped,
+            l_queuedTasks,
+            l_queuedClicks,
+            l_allocations,
+            l_bytes,
+            summary( l_metrics.captureToClick )
+        );
+
+        bool l_isFirst = true;
+
+        for ( size_t _templateId = 0; _templateId < METRICS_TEMPLATES_COUNT; _templateId++ ) {
+            const latencyHistogram_t& l_histogram = l_metrics.templates[ _templateId ];
+
+            if ( !l_histogram.snapshot( l_counts ) ) {
+                continue;
+            }
+
+            l_text += fmt::format(
+                "{}\"{}\":{}",
+                ( l_isFirst ? "" : "," ),
+                templateLabel( _templateId ),
+                summary( l_histogram )
+            );
+
+            l_isFirst = false;
+        }
+
+        l_text += "}}\n";
+        /// @endcode
+        //! <b>[json]</b>
+
+        return ( l_text );
+    }
+
+    //! <b>[prometheus]</b>
+    /// Text exposition format, latencies are summaries in seconds.
+    /// @code{.cpp}
+    auto summary = [ & ]( const char* _name, const std::string& _label, const latencyHistogram_t& _histogram ) {
+        const uint64_t    l_count     = _histogram.snapshot( l_counts );
+        const std::string l_separator = ( _label.empty() ? "" : "," );
+        const std::string l_labels    = ( _label.empty() ? "" : ( "{" + _label + "}" ) );
+
+        if ( !l_count ) {
+            return;
+        }
+
+        for ( const double _quantile : l_quantiles ) {
+            l_text += fmt::format(
+                "{}{{{}{}quantile=\"{}\"}} {}\n",
+                _name,
+                _label,
+                l_separator,
+                _quantile,
+                latencyHistogram_t::quantile( l_counts, l_count, _quantile )
+            );
+        }
+
+        l_text += fmt::format( "{}_sum{} {}\n", _name, l_labels, _histogram.sum() );
+        l_text += fmt::format( "{}_count{} {}\n", _name, l_labels, l_count );
+    };
+
+    l_text = fmt::format(
+        "# HELP matching_frames_captured_total Frames taken from window, frame ring, replay or stream.\n"
+        "# TYPE matching_frames_captured_total counter\n"
+        "matching_frames_captured_total {}\n"
+        "# HELP matching_frames_skipped_total Frames skipped by run loop running past deadline.\n"
+        "# TYPE matching_frames_skipped_total counter\n"
+        "matching_frames_skipped_total {}\n"
+        "# HELP matching_pool_queue_depth Template tasks waiting for thread pool workers.\n"
+        "# TYPE matching_pool_queue_depth gauge\n"
+        "matching_pool_queue_depth {}\n"
+        "# HELP matching_click_queue_depth Clicks queued or in flight.\n"
+        "# TYPE matching_click_queue_depth gauge\n"
+        "matching_click_queue_depth {}\n"
+        "# HELP matching_mat_allocations_total Heap allocations of images.\n"
+        "# TYPE matching_mat_allocations_total counter\n"
+        "matching_mat_allocations_total {}\n"
+        "# HELP matching_mat_allocated_bytes_total Bytes of heap allocations of images.\n"
+        "# TYPE matching_mat_allocated_bytes_total counter\n"
+        "matching_mat_allocated_bytes_total {}\n"
+        "# HELP matching_capture_to_click_seconds Frame capture to click injection latency.\n"
+        "# TYPE matching_capture_to_click_seconds summary\n",
+        l_framesCaptured,
+        l_framesSkipped,
+        l_queuedTasks,
+        l_queuedClicks,
+        l_allocations,
+        l_bytes
+    );
+
+    summary( "matching_capture_to_click_seconds", "", l_metrics.captureToClick );
+
+    l_text += (
+        "# HELP matching_template_seconds Matching latency of template.\n"
+        "# TYPE matching_template_seconds summary\n"
+    );
+
+    for ( size_t _templateId = 0; _templateId < METRICS_TEMPLATES_COUNT; _templateId++ ) {
+        summary(
+            "matching_template_seconds",
+            fmt::format( "template=\"{}\"", templateLabel( _templateId ) ),
+            l_metrics.templates[ _templateId ]
+        );
+    }
+    /// @endcode
+    //! <b>[prometheus]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_text );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+#ifndef _WIN32
+
+///////////////
+/// @brief Unix domain socket server answering every connection with metrics.
+/// @details Connections are served one after another on own thread, slow client can't hold it longer than timeouts.
+/// Throws ios_base::failure at error.
+///////////////
+class metricsServer_t {
+public:
+    explicit metricsServer_t( const std::string& _socketPath );
+    ~metricsServer_t( void );
+
+    metricsServer_t( const metricsServer_t& ) = delete;
+    metricsServer_t& operator=( const metricsServer_t& ) = delete;
+
+private:
+    void run( void );
+    void serve( int _client );
+
+    std::string         m_socketPath;
+    int                 m_descriptor = -1;
+    std::atomic< bool > m_isStopping = { false };
+    std::thread         m_thread;
+};
+
+metricsServer_t::metricsServer_t( const std::string& _socketPath ) : m_socketPath( _socketPath ) {
+    //! <b>[address]</b>
+    /// @code{.cpp}
+    sockaddr_un l_address = {};
+
+    l_address.sun_family = AF_UNIX;
+
+    if ( _socketPath.empty() || ( _socketPath.size() >= sizeof( l_address.sun_path ) ) ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Bad metrics socket path {}",
+                _socketPath
+            )
+        );
+    }
+
+    std::memcpy( l_address.sun_path, _socketPath.c_str(), _socketPath.size() );
+    /// @endcode
+    //! <b>[address]</b>
+
+    //! <b>[listen]</b>
+    /// Stale socket of the same path is replaced.
+    /// @code{.cpp}
+    unlink( _socketPath.c_str() );
+
+    m_descriptor = socket( AF_UNIX, ( SOCK_STREAM | SOCK_CLOEXEC ), 0 );
+
+    if (
+        ( m_descriptor < 0 ) ||
+        ( bind( m_descriptor, reinterpret_cast< sockaddr* >( &l_address ), sizeof( l_address ) ) != 0 ) ||
+        ( listen( m_descriptor, METRICS_BACKLOG ) != 0 )
+    ) {
+        const int l_error = errno;
+
+        if ( m_descriptor >= 0 ) {
+            close( m_descriptor );
+        }
+
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't listen on metrics socket {}: {}",
+                _socketPath,
+                strerror( l_error )
+            )
+        );
+    }
+
+    m_thread = std::thread( &metricsServer_t::run, this );
+    /// @endcode
+    //! <b>[listen]</b>
+}
+
+metricsServer_t::~metricsServer_t( void ) {
+    m_isStopping.store( true, std::memory_order_relaxed );
+    m_thread.join();
+
+    close( m_descriptor );
+    unlink( m_socketPath.c_str() );
+}
+
+///////////////
+/// @brief Accept loop, stop flag is checked every \c METRICS_POLL_INTERVAL milliseconds.
+///////////////
+void metricsServer_t::run( void ) {
+    pollfd l_poll = { m_descriptor, POLLIN, 0 };
+
+    while ( !m_isStopping.load( std::memory_order_relaxed ) ) {
+        if ( poll( &l_poll, 1, METRICS_POLL_INTERVAL ) <= 0 ) {
+            continue;
+        }
+
+        const int l_client = accept4( m_descriptor, NULL, NULL, SOCK_CLOEXEC );
+
+        if ( l_client >= 0 ) {
+            serve( l_client );
+            close( l_client );
+        }
+    }
+}
+
+///////////////
+/// @brief Answer one client.
+/// @details Client that sends nothing within \c METRICS_REQUEST_TIMEOUT milliseconds gets Prometheus text.
+/// @param[in] _client Client descriptor.
+///////////////
+void metricsServer_t::serve( int _client ) {
+    //! <b>[request]</b>
+    /// Only start of request is looked at.
+    /// @code{.cpp}
+    std::array< char, 1024 > l_request = {};
+    pollfd                   l_poll    = { _client, POLLIN, 0 };
+    ssize_t                  l_read    = 0;
+
+    if ( poll( &l_poll, 1, METRICS_REQUEST_TIMEOUT ) > 0 ) {
+        l_read = recv( _client, l_request.data(), ( l_request.size() - 1 ), 0 );
+    }
+
+    const std::string l_requestText( l_request.data(), std::max< ssize_t >( l_read, 0 ) );
+    const bool        l_isHttp = ( l_requestText.compare( 0, 4, "GET " ) == 0 );
+    const bool        l_isJson = ( l_requestText.find( "json" ) != std::string::npos );
+    /// @endcode
+    //! <b>[request]</b>
+
+    //! <b>[response]</b>
+    /// @code{.cpp}
+    std::string l_response = formatMetrics( l_isJson );
+
+    if ( l_isHttp ) {
+        l_response = fmt::format(
+            "HTTP/1.0 200 OK\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}",
+            ( l_isJson ? "application/json" : "text/plain; version=0.0.4" ),
+            l_response.size(),
+            l_response
+        );
+    }
+    /// @endcode
+    //! <b>[response]</b>
+
+    //! <b>[send]</b>
+    /// Client that stops reading is dropped after timeout.
+    /// @code{.cpp}
+    const timeval l_timeout = { 0, ( METRICS_REQUEST_TIMEOUT * 1000 ) };
+    size_t        l_sent    = 0;
+
+    setsockopt( _client, SOL_SOCKET, SO_SNDTIMEO, &l_timeout, sizeof( l_timeout ) );
+
+    while ( l_sent < l_response.size() ) {
+        const ssize_t l_count = send( _client, ( l_response.data() + l_sent ), ( l_response.size() - l_sent ), MSG_NOSIGNAL );
+
+        if ( l_count <= 0 ) {
+            break;
+        }
+
+        l_sent += l_count;
+    }
+    /// @endcode
+    //! <b>[send]</b>
+}
+
+#else // _WIN32
+
+class metricsServer_t {
+public:
+    explicit metricsServer_t( const std::string& _socketPath ) {
+        throw std::ios_base::failure( "Metrics socket is not supported" );
+    }
+};
+
+#endif // _WIN32
+
+///////////////
+/// @brief Get slot of process wide metrics server.
+/// @return Server, empty if not started.
+///////////////
+static std::unique_ptr< metricsServer_t >& getMetricsServer( void ) {
+    static std::unique_ptr< metricsServer_t > l_metricsServer;
+
+    return ( l_metricsServer );
+}
+
+static std::mutex& getMetricsServerMutex( void ) {
+    static std::mutex l_metricsServerMutex;
+
+    return ( l_metricsServerMutex );
+}
+
+void startMetricsServer( const std::string& _socketPath ) {
+    std::lock_guard< std::mutex > l_lock( getMetricsServerMutex() );
+
+    /// Everything server thread reads is created first, so it outlives server at exit.
+    getMetrics();
+    pendingClicksCount();
+    enableAllocationCounter();
+
+    getMetricsServer().reset();
+    getMetricsServer().reset( new metricsServer_t( _socketPath ) );
+}
+
+void stopMetricsServer( void ) {
+    std::lock_guard< std::mutex > l_lock( getMetricsServerMutex() );
+
+    getMetricsServer().reset();
+}
+
+matPool_t::lease_t::lease_t( matPool_t* _pool, cv::Mat&& _mat ) : m_pool( _pool ), m_mat( std::move( _mat ) ) {}
+
+matPool_t::lease_t::lease_t( lease_t&& _lease ) noexcept : m_pool( _lease.m_pool ), m_mat( std::move( _lease.m_mat ) ) {
+    _lease.m_pool = nullptr;
+}
+
+matPool_t::lease_t& matPool_t::lease_t::operator=( lease_t&& _lease ) noexcept {
+    if ( this != &_lease ) {
+        if ( m_pool ) {
+            m_pool->release( std::move( m_mat ) );
+        }
+
+        m_pool        = _lease.m_pool;
+        m_mat         = std::move( _lease.m_mat );
+        _lease.m_pool = nullptr;
+    }
+
+    return ( *this );
+}
+
+matPool_t::lease_t::~lease_t( void ) {
+    if ( m_pool ) {
+        m_pool->release( std::move( m_mat ) );
+    }
+}
+
+matPool_t::lease_t matPool_t::acquire( int _rows, int _cols, int _type ) {
+    //! <b>[reuse]</b>
+    /// Take free buffer of the same geometry.
+    /// @code{.cpp}
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        auto l_buffers = m_buffers.find( std::make_tuple( _rows, _cols, _type ) );
+
+        if ( ( l_buffers != m_buffers.end() ) && !l_buffers->second.empty() ) {
+            cv::Mat l_buffer = std::move( l_buffers->second.back() );
+
+            l_buffers->second.pop_back();
+
+            return ( lease_t( this, std::move( l_buffer ) ) );
+        }
+    }
+    /// @endcode
+    //! <b>[reuse]</b>
+
+    //! <b>[allocate]</b>
+    /// Warm-up or new geometry.
+    /// @code{.cpp}
+    m_allocations.fetch_add( 1, std::memory_order_relaxed );
+
+    return ( lease_t( this, cv::Mat( _rows, _cols, _type ) ) );
+    /// @endcode
+    //! <b>[allocate]</b>
+}
+
+void matPool_t::release( cv::Mat&& _mat ) {
+    //! <b>[check]</b>
+    /// Buffers referenced elsewhere can't be reused.
+    /// @code{.cpp}
+    if ( _mat.empty() || ( _mat.u && ( _mat.u->refcount > 1 ) ) ) {
+        return;
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[store]</b>
+    /// Keyed by current geometry, buffer could be recreated while leased.
+    /// @code{.cpp}
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_buffers[ std::make_tuple( _mat.rows, _mat.cols, _mat.type() ) ].push_back( std::move( _mat ) );
+    /// @endcode
+    //! <b>[store]</b>
+}
+
+///////////////
+/// @brief Get whether current thread is a pool worker.
+/// @return Flag of current thread.
+///////////////
+static bool& isWorkerThread( void ) {
+    static thread_local bool l_isWorkerThread = false;
+
+    return ( l_isWorkerThread );
+}
+
+threadPool_t::threadPool_t( size_t _threadsCount ) {
+    //! <b>[start]</b>
+    /// Caller of \c parallelFor is one of workers.
+    /// @code{.cpp}
+    for ( size_t _threadIndex = 1; _threadIndex < _threadsCount; _threadIndex++ ) {
+        m_threads.emplace_back( &threadPool_t::run, this );
+    }
+    /// @endcode
+    //! <b>[start]</b>
+}
+
+threadPool_t::~threadPool_t( void ) {
+    //! <b>[stop]</b>
+    /// @code{.cpp}
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        m_isStopping = true;
+    }
+
+    m_condition.notify_all();
+
+    for ( std::thread& _thread : m_threads ) {
+        _thread.join();
+    }
+    /// @endcode
+    //! <b>[stop]</b>
+}
+
+///////////////
+/// @brief Worker thread loop.
+///////////////
+void threadPool_t::run( void ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    uint64_t l_generation = 0;
+
+    isWorkerThread() = true;
+    /// @endcode
+    //! <b>[declare]</b>
+
+    for ( ;; ) {
+        //! <b>[wait]</b>
+        /// Wait for next range.
+        /// @code{.cpp}
+        const std::function< void( size_t ) >* l_task;
+        size_t                                 l_count;
+
+        {
+            std::unique_lock< std::mutex > l_lock( m_mutex );
+
+            m_condition.wait(
+                l_lock,
+                [ & ]{ return ( m_isStopping || ( m_generation != l_generation ) ); }
+            );
+
+            if ( m_isStopping ) {
+                break;
+            }
+
+            l_generation = m_generation;
+            l_task       = m_task;
+            l_count      = m_count;
+        }
+        /// @endcode
+        //! <b>[wait]</b>
+
+        //! <b>[work]</b>
+        /// @code{.cpp}
+        work( *l_task, l_count );
+        /// @endcode
+        //! <b>[work]</b>
+
+        //! <b>[done]</b>
+        /// Range is over only when every worker left it.
+        /// @code{.cpp}
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        if ( ++m_finishedWorkers == m_threads.size() ) {
+            m_doneCondition.notify_one();
+        }
+        /// @endcode
+        //! <b>[done]</b>
+    }
+}
+
+///////////////
+/// @brief Take indices of range until it is exhausted.
+/// @param[in] _task Task to run with index.
+/// @param[in] _count Indices count.
+///////////////
+void threadPool_t::work( const std::function< void( size_t ) >& _task, size_t _count ) {
+    std::atomic< int64_t >& l_queuedTasks = getMetrics().queuedTasks;
+
+    for (
+        size_t _index = m_nextIndex.fetch_add( 1, std::memory_order_relaxed );
+        _index < _count;
+        _index = m_nextIndex.fetch_add( 1, std::memory_order_relaxed )
+    ) {
+        l_queuedTasks.fetch_sub( 1, std::memory_order_relaxed );
+
+        try {
+            _task( _index );
+
+        } catch ( ... ) {
+            //! <b>[error]</b>
+            /// Keep first exception and skip rest of range, skipped indices leave queue.
+            /// @code{.cpp}
+            std::lock_guard< std::mutex > l_lock( m_mutex );
+
+            if ( !m_exception ) {
+                m_exception = std::current_exception();
+            }
+
+            const size_t l_nextIndex = m_nextIndex.exchange( _count, std::memory_order_relaxed );
+
+            if ( l_nextIndex < _count ) {
+                l_queuedTasks.fetch_sub( ( _count - l_nextIndex ), std::memory_order_relaxed );
+            }
+            /// @endcode
+            //! <b>[error]</b>
+        }
+    }
+}
+
+void threadPool_t::parallelFor( size_t _count, const std::function< void( size_t ) >& _task ) {
+    //! <b>[inline]</b>
+    /// Nested ranges run inline, workers are busy with outer one.
+    /// @code{.cpp}
+    if ( isWorkerThread() || m_threads.empty() || ( _count == 1 ) ) {
+        for ( size_t _index = 0; _index < _count; _index++ ) {
+            _task( _index );
+        }
+
+        return;
+    }
+    /// @endcode
+    //! <b>[inline]</b>
+
+    //! <b>[start]</b>
+    /// @code{.cpp}
+    std::lock_guard< std::mutex > l_parallelForLock( m_parallelForMutex );
+
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        m_task            = &_task;
+        m_count           = _count;
+        m_finishedWorkers = 0;
+        m_exception       = nullptr;
+        m_nextIndex.store( 0, std::memory_order_relaxed );
+        m_generation++;
+    }
+
+    getMetrics().queuedTasks.fetch_add( _count, std::memory_order_relaxed );
+
+    m_condition.notify_all();
+    /// @endcode
+    //! <b>[start]</b>
+
+    //! <b>[work]</b>
+    /// @code{.cpp}
+    isWorkerThread() = true;
+    work( _task, _count );
+    isWorkerThread() = false;
+    /// @endcode
+    //! <b>[work]</b>
+
+    //! <b>[wait]</b>
+    /// @code{.cpp}
+    std::unique_lock< std::mutex > l_lock( m_mutex );
+
+    m_doneCondition.wait(
+        l_lock,
+        [ this ]{ return ( m_finishedWorkers == m_threads.size() ); }
+    );
+
+    if ( m_exception ) {
+        std::rethrow_exception( m_exception );
+    }
+    /// @endcode
+    //! <b>[wait]</b>
+}
+
+#ifndef _WIN32
+
+///////////////
+/// @brief Get cores thread may run on.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _thread Started thread.
+/// @return Core indices.
+///////////////
+static std::vector< int > getThreadCores( std::thread& _thread ) {
+    //! <b>[get]</b>
+    /// @code{.cpp}
+    cpu_set_t l_cores;
+
+    const int l_error = pthread_getaffinity_np( _thread.native_handle(), sizeof( l_cores ), &l_cores );
+
+    if ( l_error ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't get thread cores: {}",
+                strerror( l_error )
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[get]</b>
+
+    //! <b>[convert]</b>
+    /// @code{.cpp}
+    std::vector< int > l_coreIndices;
+
+    for ( int _core = 0; _core < CPU_SETSIZE; _core++ ) {
+        if ( CPU_ISSET( _core, &l_cores ) ) {
+            l_coreIndices.push_back( _core );
+        }
+    }
+    /// @endcode
+    //! <b>[convert]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_coreIndices );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Let thread run only on cores.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _thread Started thread.
+/// @param[in] _cores Core indices.
+///////////////
+static void setThreadCores( std::thread& _thread, const std::vector< int >& _cores ) {
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    cpu_set_t l_cores;
+
+    CPU_ZERO( &l_cores );
+
+    for ( const int _core : _cores ) {
+        if ( ( _core < 0 ) || ( _core >= CPU_SETSIZE ) ) {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "Wrong core {}",
+                    _core
+                )
+            );
+        }
+
+        CPU_SET( _core, &l_cores );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[pin]</b>
+    /// @code{.cpp}
+    const int l_error = pthread_setaffinity_np( _thread.native_handle(), sizeof( l_cores ), &l_cores );
+
+    if ( l_error ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't pin thread: {}",
+                strerror( l_error )
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[pin]</b>
+}
+
+//! <b>[struct]</b>
+/// Memory lock is process wide, it is held while any run loop needs it.
+/// @code{.cpp}
+struct memoryLocks_t {
+    std::mutex mutex;
+    size_t     count = 0; // Run loops holding lock
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Get memory lock holders of process.
+/// @return Process wide memory lock holders.
+///////////////
+static memoryLocks_t& getMemoryLocks( void ) {
+    static memoryLocks_t l_memoryLocks;
+
+    return ( l_memoryLocks );
+}
+
+///////////////
+/// @brief Fault in and lock every page process has mapped now, pages mapped later aren't locked.
+/// @details Every caller locks pages mapped since previous one, memory is unlocked by last \c unlockMemory .
+/// Failure, usually memory lock limit, is only reported.
+///////////////
+static void lockMemory( void ) {
+    memoryLocks_t&                l_memoryLocks = getMemoryLocks();
+    std::lock_guard< std::mutex > l_lock( l_memoryLocks.mutex );
+
+    l_memoryLocks.count++;
+
+    if ( mlockall( MCL_CURRENT ) != 0 ) {
+        fmt::print( stderr, "Can't lock memory, buffers may be paged out: {}\n", strerror( errno ) );
+    }
+}
+
+///////////////
+/// @brief Release memory lock, memory is unlocked when no caller of \c lockMemory holds it.
+///////////////
+static void unlockMemory( void ) {
+    memoryLocks_t&                l_memoryLocks = getMemoryLocks();
+    std::lock_guard< std::mutex > l_lock( l_memoryLocks.mutex );
+
+    if ( l_memoryLocks.count && !--l_memoryLocks.count ) {
+        munlockall();
+    }
+}
+
+#else // _WIN32
+
+static std::vector< int > getThreadCores( std::thread& _thread ) {
+    throw std::ios_base::failure( "Thread pinning is not supported" );
+}
+
+static void setThreadCores( std::thread& _thread, const std::vector< int >& _cores ) {
+    throw std::ios_base::failure( "Thread pinning is not supported" );
+}
+
+static void lockMemory( void ) {}
+
+static void unlockMemory( void ) {}
+
+#endif // _WIN32
+
+///////////////
+/// @brief Pin thread to core.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _thread Started thread.
+/// @param[in] _core Core index.
+///////////////
+static void pinThread( std::thread& _thread, int _core ) {
+    setThreadCores( _thread, { _core } );
+}
+
+void threadPool_t::pin( const std::vector< int >& _cores ) {
+    //! <b>[save]</b>
+    /// Cores before first pin are kept, so pinning again doesn't lose them.
+    /// @code{.cpp}
+    if ( m_unpinnedCores.empty() ) {
+        for ( std::thread& _thread : m_threads ) {
+            m_unpinnedCores.push_back( getThreadCores( _thread ) );
+        }
+    }
+    /// @endcode
+    //! <b>[save]</b>
+
+    //! <b>[pin]</b>
+    /// @code{.cpp}
+    for ( size_t _threadIndex = 0; ( _threadIndex < m_threads.size() ) && !_cores.empty(); _threadIndex++ ) {
+        pinThread( m_threads[ _threadIndex ], _cores[ _threadIndex % _cores.size() ] );
+    }
+    /// @endcode
+    //! <b>[pin]</b>
+}
+
+void threadPool_t::unpin( void ) {
+    //! <b>[restore]</b>
+    /// Failure leaves worker pinned, it is only reported.
+    /// @code{.cpp}
+    for ( size_t _threadIndex = 0; _threadIndex < m_unpinnedCores.size(); _threadIndex++ ) {
+        try {
+            setThreadCores( m_threads[ _threadIndex ], m_unpinnedCores[ _threadIndex ] );
+
+        } catch ( const std::exception& _exception ) {
+            fmt::print( stderr, "Thread pool: {}\n", _exception.what() );
+        }
+    }
+
+    m_unpinnedCores.clear();
+    /// @endcode
+    //! <b>[restore]</b>
+}
+
+#ifdef _WIN32
+
+///////////////
+/// @brief Get \c cv::Mat object from window capture.
+/// @param[in] _sourceWindowName Window handle.
+/// @param[in] _matPool Pool to borrow image from.
+/// @param[in] _downscale Capture is this many times smaller than window, stretched by GDI. Optional.
+/// @return Window capture.
+///////////////
+static matPool_t::lease_t getMatFromWindow(
+    const std::string& _sourceWindowName,
+    matPool_t&         _matPool,
+    uint32_t           _downscale = 1
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    matPool_t::lease_t l_sourceImage;
+    BITMAPINFOHEADER   l_bitmapInfo;
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[window_info]</b>
+    /// @code{.cpp}
+    HWND l_sourceWindowHandle                  = FindWindow( NULL, _sourceWindowName.c_str() );
+    HDC  l_handleWindowDeviceContext           = GetDC( l_sourceWindowHandle );
+    HDC  l_handleWindowCompatibleDeviceContext = CreateCompatibleDC( l_handleWindowDeviceContext );
+
+    SetStretchBltMode(
+        l_handleWindowCompatibleDeviceContext,
+        ( ( _downscale > 1 ) ? HALFTONE : COLORONCOLOR )
+    );
+    SetBrushOrgEx(
+        l_handleWindowCompatibleDeviceContext,
+        0,
+        0,
+        NULL
+    );
+
+    RECT l_windowSize;
+
+    GetClientRect(
+        l_sourceWindowHandle,
+        &l_windowSize
+    );
+
+    uint32_t l_sourceHeight = l_windowSize.bottom;
+    uint32_t l_sourceWidth  = l_windowSize.right;
+    uint32_t l_strechHeight = ( ( l_windowSize.bottom + _downscale - 1 ) / _downscale );
+    uint32_t l_strechWidth  = ( ( l_windowSize.right + _downscale - 1 ) / _downscale );
+    /// @endcode
+    //! <b>[window_info]</b>
+
+    //! <b>[window_capture]</b>
+    /// Borrow empty image.
+    /// @code{.cpp}
+    l_sourceImage = _matPool.acquire(
+        l_strechHeight,
+        l_strechWidth,
+        CV_8UC4
+    );
+    /// @endcode
+    //! <b>[window_capture]</b>
+
+    //! <b>[bitmap]</b>
+    /// Create and assign values.
+    /// @code{.cpp}
+    HBITMAP l_handleBitmapWindow = CreateCompatibleBitmap(
+        l_handleWindowDeviceContext,
+        l_strechWidth,
+        l_strechHeight
+    );
+
+    l_bitmapInfo.biSize          = sizeof( BITMAPINFOHEADER );
+    l_bitmapInfo.biWidth         = l_strechWidth;
+    l_bitmapInfo.biHeight        = -l_strechHeight; // This is the line that makes it draw upside down or not
+    l_bitmapInfo.biPlanes        = 1;
+    l_bitmapInfo.biBitCount      = 32;
+    l_bitmapInfo.biCompression   = BI_RGB;
+    l_bitmapInfo.biSizeImage     = 0;
+    l_bitmapInfo.biXPelsPerMeter = 0;
+    l_bitmapInfo.biYPelsPerMeter = 0;
+    l_bitmapInfo.biClrUsed       = 0;
+    l_bitmapInfo.biClrImportant  = 0;
+    /// @endcode
+    //! <b>[bitmap]</b>
+
+    //! <b>[window_capture]</b>
+    /// Use the previously created device context with the bitmap.
+    /// @code{.cpp}
+    SelectObject(
+        l_handleWindowCompatibleDeviceContext,
+        l_handleBitmapWindow
+    );
+    /// @endcode
+
+    /// Copy from the window device context to the bitmap device context.
+    /// Change SRCCOPY to NOTSRCCOPY for wacky colors.
+    /// @code{.cpp}
+    traceScope_t l_captureTrace( "StretchBlt" );
+
+    StretchBlt(
+        l_handleWindowCompatibleDeviceContext,
+        0,
+        0,
+        l_strechWidth,
+        l_strechHeight,
+        l_handleWindowDeviceContext,
+        0,
+        0,
+        l_sourceWidth,
+        l_sourceHeight,
+        SRCCOPY
+    );
+    /// @endcode
+
+    /// Copy from l_handleWindowCompatibleDeviceContext to l_handleBitmapWindow.
+    /// @code{.cpp}
+    GetDIBits(
+        l_handleWindowCompatibleDeviceContext,
+        l_handleBitmapWindow,
+        0,
+        l_strechHeight,
+        l_sourceImage->data,
+        (BITMAPINFO*)&l_bitmapInfo,
+        DIB_RGB_COLORS
+    );
+
+    l_captureTrace.end();
+    /// @endcode
+    //! <b>[window_capture]</b>
+
+    //! <b>[clean]</b>
+    /// Avoid memory leak.
+    /// @code{.cpp}
+    DeleteObject( l_handleBitmapWindow );
+    DeleteDC( l_handleWindowCompatibleDeviceContext );
+    ReleaseDC(
+        l_sourceWindowHandle,
+        l_handleWindowDeviceContext
+    );
+    /// @endcode
+    //! <b>[clean]</b>
+
+    //! <b>[color]</b>
+    /// Convert source image to template's color format.
+    /// @code{.cpp}
+    matPool_t::lease_t t_l_image = _matPool.acquire(
+        l_strechHeight,
+        l_strechWidth,
+        CV_8UC3
+    );
+    traceScope_t       l_colorTrace( "cvtColor" );
+
+    cv::cvtColor(
+        *l_sourceImage,
+        *t_l_image,
+        cv::COLOR_RGB2BGR
+    );
+    /// @endcode
+    //! <b>[color]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( t_l_image );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Capture of one window.
+/// @details Window handle is resolved on every capture.
+///////////////
+class windowCapture_t {
+public:
+    explicit windowCapture_t( const std::string& _windowName, const windowCapture_t* = NULL ) : m_windowName( _windowName ) {}
+
+    void capture(
+        matPool_t&          _matPool,
+        matPool_t::lease_t& _image,
+        uint32_t            _captureWidth  = 0,
+        uint32_t            _captureHeight = 0,
+        uint32_t            _downscale     = 1
+    ) {
+        _image = getMatFromWindow( m_windowName, _matPool, _downscale );
+    }
+
+private:
+    std::string m_windowName;
+};
+
+#else // _WIN32
+
+//! <b>[struct]</b>
+/// X error handler shared by traps of all threads.
+/// @code{.cpp}
+struct xErrorTraps_t {
+    std::mutex    mutex;
+    size_t        count           = 0;    // Traps alive
+    XErrorHandler previousHandler = NULL; // Handler of errors outside of traps
+};
+/// @endcode
+//! <b>[struct]</b>
+
+static xErrorTraps_t& getXErrorTraps( void ) {
+    static xErrorTraps_t l_xErrorTraps;
+
+    return ( l_xErrorTraps );
+}
+
+///////////////
+/// @brief Get error code of trap alive on current thread.
+/// @return Error code, \c NULL outside of trap.
+///////////////
+static int*& trappedXError( void ) {
+    static thread_local int* l_trappedXError = NULL;
+
+    return ( l_trappedXError );
+}
+
+///////////////
+/// @brief Keep first error of trapped requests, other errors go to previous handler.
+/// @details Errors are handled on thread reading them, that is thread which made the request.
+/// @param[in] _display Display connection.
+/// @param[in] _event Error.
+/// @return Ignored by Xlib.
+///////////////
+static int handleXError( Display* _display, XErrorEvent* _event ) {
+    //! <b>[trapped]</b>
+    /// @code{.cpp}
+    if ( trappedXError() ) {
+        if ( !*trappedXError() ) {
+            *trappedXError() = _event->error_code;
+        }
+
+        return ( 0 );
+    }
+    /// @endcode
+    //! <b>[trapped]</b>
+
+    //! <b>[previous]</b>
+    /// Xlib default handler exits process.
+    /// @code{.cpp}
+    const XErrorHandler l_previousHandler = getXErrorTraps().previousHandler;
+
+    return ( l_previousHandler ? l_previousHandler( _display, _event ) : 0 );
+    /// @endcode
+    //! <b>[previous]</b>
+}
+
+///////////////
+/// @brief Collect X errors of requests made on current thread while alive, instead of exiting process.
+/// @details Handler is installed while any trap is alive. Errors arrive after request,
+/// so \c isFailed and destructor wait for server to process every request first.
+/// Requests already answered by reply need no extra round trip, so a checked capture syncs at most once.
+///////////////
+class xErrorTrap_t {
+public:
+    explicit xErrorTrap_t( Display* _display ) : m_display( _display ), m_previousTrap( trappedXError() ) {
+        xErrorTraps_t&                l_xErrorTraps = getXErrorTraps();
+        std::lock_guard< std::mutex > l_lock( l_xErrorTraps.mutex );
+
+        if ( !l_xErrorTraps.count++ ) {
+            l_xErrorTraps.previousHandler = XSetErrorHandler( handleXError );
+        }
+
+        trappedXError() = &m_errorCode;
+    }
+
+    ~xErrorTrap_t( void ) {
+        sync();
+
+        trappedXError() = m_previousTrap;
+
+        xErrorTraps_t&                l_xErrorTraps = getXErrorTraps();
+        std::lock_guard< std::mutex > l_lock( l_xErrorTraps.mutex );
+
+        if ( !--l_xErrorTraps.count ) {
+            XSetErrorHandler( l_xErrorTraps.previousHandler );
+        }
+    }
+
+    xErrorTrap_t( const xErrorTrap_t& ) = delete;
+    xErrorTrap_t& operator=( const xErrorTrap_t& ) = delete;
+
+    ///////////////
+    /// @brief Any request since trap creation failed.
+    /// @return Request failed.
+    ///////////////
+    bool isFailed( void ) {
+        sync();
+
+        return ( m_errorCode != 0 );
+    }
+
+private:
+    ///////////////
+    /// @brief Wait for server to process requests sent after last reply.
+    ///////////////
+    void sync( void ) {
+        if ( LastKnownRequestProcessed( m_display ) != ( NextRequest( m_display ) - 1 ) ) {
+            XSync( m_display, False );
+        }
+    }
+
+    Display* m_display;
+    int*     m_previousTrap;
+    int      m_errorCode = 0;
+};
+
+///////////////
+/// @brief Get \c Window to needed window by name on \c Display .
+/// @details Recursive function
+/// @param[in] _display \c Display pointer.
+/// @param[in] _window default root window.
+/// @param[in] _windowName Window name.
+/// @return \c Window information.
+///////////////
+static Window windowSearch(
+    Display*       _display,
+    Window         _window,
+    const regex_t* _windowNameRegExp
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    Window        l_window = 0;
+    Window        l_root;
+    Window        l_parent;
+    Window*       l_children;
+    uint32_t      l_childrenCount;
+    int           l_windowNamesCount = 0;
+    XTextProperty l_xTextProperty    = {};   // Left empty if window is gone
+    char**        l_windowNamesList  = NULL;
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[check]</b>
+    /// Compare root window name to received.
+    /// @code{.cpp}
+    XGetWMName( _display, _window, &l_xTextProperty );
+
+    if ( l_xTextProperty.nitems > 0 ) {
+        Xutf8TextPropertyToTextList(
+            _display,
+            &l_xTextProperty,
+            &l_windowNamesList,
+            &l_windowNamesCount
+        );
+
+        for (
+            int _windowNameIndex = 0;
+            _windowNameIndex < l_windowNamesCount;
+            _windowNameIndex++
+        ) {
+            if (
+                regexec(
+                    _windowNameRegExp,
+                    l_windowNamesList[ _windowNameIndex ],
+                    0,
+                    NULL,
+                    0
+                ) == 0
+            ) {
+                XFreeStringList( l_windowNamesList );
+                XFree( l_xTextProperty.value );
+
+                return ( _window );
+            }
+        }
+    }
+
+    XFreeStringList( l_windowNamesList );
+    XFree( l_xTextProperty.value );
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[check_next]</b>
+    /// Compare all window names to received.
+    /// @code{.cpp}
+    if (
+        XQueryTree(
+            _display,
+            _window,
+            &l_root,
+            &l_parent,
+            &l_children,
+            &l_childrenCount
+        )
+    ) {
+        for (
+            uint32_t _childrenIndex = 0;
+            _childrenIndex < l_childrenCount;
+            ++_childrenIndex
+        ) {
+            l_window = windowSearch( _display, l_children[ _childrenIndex ], _windowNameRegExp );
+
+            if ( l_window ) {
+                break;
+            }
+        }
+
+        XFree( l_children );
+    }
+    /// @endcode
+    //! <b>[check_next]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_window );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Get \c Window to needed window by name.
+/// @param[in] _display Display connection to search on.
+/// @param[in] _windowName Window name.
+/// @return \c Window information.
+///////////////
+static Window getWindowByName( Display* _display, std::string _windowName ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    traceScope_t l_trace( "getWindowByName" );
+
+    regex_t l_windowNameRegExp;
+
+    regcomp(
+        &l_windowNameRegExp,
+        _windowName.c_str(),
+        REG_EXTENDED | REG_ICASE
+    );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[search]</b>
+    /// Get \c Window by window name. Windows destroyed while tree is walked are skipped.
+    /// @code{.cpp}
+    xErrorTrap_t l_errorTrap( _display );
+
+    Window l_window = windowSearch(
+        _display,
+        XDefaultRootWindow( _display ),
+        &l_windowNameRegExp
+    );
+    /// @endcode
+    //! <b>[search]</b>
+
+    //! <b>[close]</b>
+    /// @code{.cpp}
+    regfree( &l_windowNameRegExp );
+    /// @endcode
+    //! <b>[close]</b>
+
+    //! <b>[error]</b>
+    /// @code{.cpp}
+    if ( !l_window ) {
+        fmt::print(
+            stderr,
+            "Window search failed: {}\n",
+            _windowName
+        );
+    }
+    /// @endcode
+    //! <b>[error]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_window );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Shared memory capture of one window.
+/// @details Display connection, window and shared memory segment are kept between frames
+/// and recreated only when capture size or scale changes. Captures of one session share display connection.
+/// Downscaled capture is rendered by XRender on the server, only downscaled pixels are transferred.
+/// Window gone since last capture is searched again by name, X errors are thrown as ios_base::failure.
+///////////////
+class windowCapture_t {
+public:
+    explicit windowCapture_t( const std::string& _windowName, const windowCapture_t* _sharedCapture = NULL );
+    ~windowCapture_t( void );
+
+    windowCapture_t( const windowCapture_t& ) = delete;
+    windowCapture_t& operator=( const windowCapture_t& ) = delete;
+
+    void capture(
+        matPool_t&          _matPool,
+        matPool_t::lease_t& _image,
+        uint32_t            _captureWidth  = 0,
+        uint32_t            _captureHeight = 0,
+        uint32_t            _downscale     = 1
+    );
+
+private:
+    void resolve( XWindowAttributes& _windowAttributes );
+    void attach( uint32_t _captureWidth, uint32_t _captureHeight, uint32_t _downscale );
+    void attachRender( const XWindowAttributes& _windowAttributes, uint32_t _downscale );
+    void detach( void );
+
+    std::string                m_windowName;
+    std::shared_ptr< Display > m_display;
+    Window                     m_window;
+    XShmSegmentInfo            m_shminfo;
+    XImage*                    m_xImage          = NULL;
+    bool                       m_isRender        = false; // XRender extension is present
+    bool                       m_isSharedPixmaps = false; // Server can render straight into shared memory
+    uint32_t                   m_downscale       = 1;
+    Pixmap                     m_pixmap          = 0;     // Downscaled capture, shared memory one if supported
+    Picture                    m_windowPicture   = 0;     // Window with downscaling transform
+    Picture                    m_pixmapPicture   = 0;
+};
+
+///////////////
+/// @brief Open display connection or share one and resolve window.
+/// @details Captures sharing connection are used from one thread at a time.
+/// Throws ios_base::failure at error.
+/// @param[in] _windowName Window name.
+/// @param[in] _sharedCapture Capture to share display connection with, own connection if \c NULL .
+///////////////
+windowCapture_t::windowCapture_t( const std::string& _windowName, const windowCapture_t* _sharedCapture ) : m_windowName( _windowName ) {
+    //! <b>[declare]</b>
+    /// Connection is closed with last capture using it.
+    /// @code{.cpp}
+    if ( _sharedCapture ) {
+        m_display = _sharedCapture->m_display;
+
+    } else {
+        m_display.reset( XOpenDisplay( NULL ), XCloseDisplay );
+    }
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[error]</b>
+    /// @code{.cpp}
+    if ( !m_display ) {
+        throw std::ios_base::failure( "Can't open display" );
+    }
+    /// @endcode
+    //! <b>[error]</b>
+
+    //! <b>[search]</b>
+    /// @code{.cpp}
+    m_window = getWindowByName( m_display.get(), _windowName );
+
+    if ( !m_window ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't find window {}",
+                _windowName
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[search]</b>
+
+    //! <b>[extensions]</b>
+    /// Without XRender downscaled capture is resized on client.
+    /// @code{.cpp}
+    int  l_eventBase;
+    int  l_errorBase;
+    int  l_majorVersion;
+    int  l_minorVersion;
+    Bool l_isSharedPixmaps = False;
+
+    m_isRender = XRenderQueryExtension( m_display.get(), &l_eventBase, &l_errorBase );
+
+    XShmQueryVersion( m_display.get(), &l_majorVersion, &l_minorVersion, &l_isSharedPixmaps );
+
+    m_isSharedPixmaps = ( l_isSharedPixmaps && ( XShmPixmapFormat( m_display.get() ) == ZPixmap ) );
+    /// @endcode
+    //! <b>[extensions]</b>
+}
+
+///////////////
+/// @brief Release shared memory segment, display connection is closed by last capture sharing it.
+///////////////
+windowCapture_t::~windowCapture_t( void ) {
+    //! <b>[close]</b>
+    /// @code{.cpp}
+    detach();
+    /// @endcode
+    //! <b>[close]</b>
+}
+
+///////////////
+/// @brief Get window attributes, window gone since last capture is searched again by name.
+/// @details Throws ios_base::failure if window is not found.
+/// @param[out] _windowAttributes Window attributes.
+///////////////
+void windowCapture_t::resolve( XWindowAttributes& _windowAttributes ) {
+    //! <b>[attributes]</b>
+    /// @code{.cpp}
+    {
+        xErrorTrap_t l_errorTrap( m_display.get() );
+
+        if ( XGetWindowAttributes( m_display.get(), m_window, &_windowAttributes ) && !l_errorTrap.isFailed() ) {
+            return;
+        }
+    }
+    /// @endcode
+    //! <b>[attributes]</b>
+
+    //! <b>[search]</b>
+    /// Restarted application has new window, resources of old one are released.
+    /// @code{.cpp}
+    detach();
+
+    m_window = getWindowByName( m_display.get(), m_windowName );
+
+    xErrorTrap_t l_errorTrap( m_display.get() );
+
+    if ( !m_window || !XGetWindowAttributes( m_display.get(), m_window, &_windowAttributes ) || l_errorTrap.isFailed() ) {
+        m_window = 0;
+
+        throw std::ios_base::failure(
+            fmt::format(
+                "Window {} is gone",
+                m_windowName
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[search]</b>
+}
+
+///////////////
+/// @brief Create shared memory image of capture size.
+/// @param[in] _captureWidth Capture width, downscaled.
+/// @param[in] _captureHeight Capture height, downscaled.
+/// @param[in] _downscale Times window is larger than capture.
+///////////////
+void windowCapture_t::attach( uint32_t _captureWidth, uint32_t _captureHeight, uint32_t _downscale ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    XWindowAttributes l_windowAttributes;
+
+    XGetWindowAttributes(
+        m_display.get(),
+        m_window,
+        &l_windowAttributes
+    );
+
+    Screen* l_screen = l_windowAttributes.screen;
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[canvas]</b>
+    /// @code{.cpp}
+    m_xImage = XShmCreateImage(
+        m_display.get(),
+        DefaultVisualOfScreen( l_screen ),
+        DefaultDepthOfScreen( l_screen ),
+        ZPixmap,
+        NULL,
+        &m_shminfo,
+        _captureWidth,
+        _captureHeight
+    );
+    /// @endcode
+    //! <b>[canvas]</b>
+
+    //! <b>[prepare]</b>
+    /// Prepare window information to capture.
+    /// @code{.cpp}
+    m_shminfo.shmid = shmget(
+        IPC_PRIVATE,
+        ( m_xImage->bytes_per_line * m_xImage->height ),
+        ( IPC_CREAT | 0777 )
+    );
+    m_shminfo.shmaddr  = m_xImage->data = static_cast< char* >( shmat( m_shminfo.shmid, 0, 0 ) );
+    m_shminfo.readOnly = false;
+    /// @endcode
+    //! <b>[prepare]</b>
+
+    //! <b>[error]</b>
+    /// @code{.cpp}
+    if ( !m_shminfo.shmid ) {
+        fmt::print(
+            stderr,
+            "Fatal shminfo error!"
+        );
+    }
+    /// @endcode
+    //! <b>[error]</b>
+
+    //! <b>[attach]</b>
+    /// Attach to display with \c m_shminfo .
+    /// @code{.cpp}
+    XShmAttach( m_display.get(), &m_shminfo );
+
+    m_downscale = _downscale;
+
+    if ( m_isRender && ( _downscale > 1 ) ) {
+        attachRender( l_windowAttributes, _downscale );
+    }
+    /// @endcode
+    //! <b>[attach]</b>
+}
+
+///////////////
+/// @brief Create pixmap downscaled window is rendered to.
+/// @details Window picture is scaled by transform and averaged by box filter of scale size,
+/// so every capture pixel is mean of window pixels it covers.
+/// Pixmap shares memory of capture image if server supports shared pixmaps.
+/// @param[in] _windowAttributes Window attributes.
+/// @param[in] _downscale Times window is larger than capture.
+///////////////
+void windowCapture_t::attachRender( const XWindowAttributes& _windowAttributes, uint32_t _downscale ) {
+    //! <b>[pixmap]</b>
+    /// @code{.cpp}
+    Screen* l_screen = _windowAttributes.screen;
+
+    if ( m_isSharedPixmaps ) {
+        m_pixmap = XShmCreatePixmap(
+            m_display.get(),
+            RootWindowOfScreen( l_screen ),
+            m_shminfo.shmaddr,
+            &m_shminfo,
+            m_xImage->width,
+            m_xImage->height,
+            m_xImage->depth
+        );
+
+    } else {
+        m_pixmap = XCreatePixmap(
+            m_display.get(),
+            RootWindowOfScreen( l_screen ),
+            m_xImage->width,
+            m_xImage->height,
+            m_xImage->depth
+        );
+    }
+    /// @endcode
+    //! <b>[pixmap]</b>
+
+    //! <b>[pictures]</b>
+    /// Child windows are included, as in \c XShmGetImage of window.
+    /// @code{.cpp}
+    XRenderPictureAttributes l_pictureAttributes;
+
+    l_pictureAttributes.subwindow_mode = IncludeInferiors;
+
+    m_windowPicture = XRenderCreatePicture(
+        m_display.get(),
+        m_window,
+        XRenderFindVisualFormat( m_display.get(), _windowAttributes.visual ),
+        CPSubwindowMode,
+        &l_pictureAttributes
+    );
+    m_pixmapPicture = XRenderCreatePicture(
+        m_display.get(),
+        m_pixmap,
+        XRenderFindVisualFormat( m_display.get(), DefaultVisualOfScreen( l_screen ) ),
+        0,
+        NULL
+    );
+    /// @endcode
+    //! <b>[pictures]</b>
+
+    //! <b>[transform]</b>
+    /// Capture pixel ( x, y ) samples window around ( x * scale, y * scale ).
+    /// @code{.cpp}
+    const XFixed l_scale     = XDoubleToFixed( _downscale );
+    XTransform   l_transform = { {
+        { l_scale, 0, 0 },
+        { 0, l_scale, 0 },
+        { 0, 0, XDoubleToFixed( 1 ) }
+    } };
+
+    XRenderSetPictureTransform( m_display.get(), m_windowPicture, &l_transform );
+
+    std::vector< XFixed > l_filterParameters(
+        ( 2 + ( _downscale * _downscale ) ),
+        XDoubleToFixed( 1.0 / ( _downscale * _downscale ) )
+    );
+
+    l_filterParameters[ 0 ] = XDoubleToFixed( _downscale );
+    l_filterParameters[ 1 ] = XDoubleToFixed( _downscale );
+
+    XRenderSetPictureFilter(
+        m_display.get(),
+        m_windowPicture,
+        FilterConvolution,
+        l_filterParameters.data(),
+        l_filterParameters.size()
+    );
+    /// @endcode
+    //! <b>[transform]</b>
+}
+
+///////////////
+/// @brief Release shared memory image.
+///////////////
+void windowCapture_t::detach( void ) {
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    if ( !m_xImage ) {
+        return;
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[close]</b>
+    /// Segment is marked for removal once both sides are detached.
+    /// Window picture is already freed by server if window is gone.
+    /// @code{.cpp}
+    xErrorTrap_t l_errorTrap( m_display.get() );
+
+    if ( m_windowPicture ) {
+        XRenderFreePicture( m_display.get(), m_windowPicture );
+        XRenderFreePicture( m_display.get(), m_pixmapPicture );
+        XFreePixmap( m_display.get(), m_pixmap );
+
+        m_windowPicture = 0;
+        m_pixmapPicture = 0;
+        m_pixmap        = 0;
+    }
+
+    XShmDetach( m_display.get(), &m_shminfo );
+    XDestroyImage( m_xImage );
+    shmdt( m_shminfo.shmaddr );
+    shmctl( m_shminfo.shmid, IPC_RMID, NULL );
+
+    m_xImage = NULL;
+    /// @endcode
+    //! <b>[close]</b>
+}
+
+///////////////
+/// @brief Capture window to pooled image.
+/// @details Capture width and height should be less or equal to window's.
+/// Downscaled capture of window region is rounded up to whole pixels.
+/// @param[in] _matPool Pool to borrow converted image from.
+/// @param[out] _image Window capture.
+/// @param[in] _captureWidth Capture width. Optional.
+/// @param[in] _captureHeight Capture height. Optional.
+/// @param[in] _downscale Capture is this many times smaller than window. Optional.
+///////////////
+void windowCapture_t::capture(
+    matPool_t&          _matPool,
+    matPool_t::lease_t& _image,
+    uint32_t            _captureWidth,
+    uint32_t            _captureHeight,
+    uint32_t            _downscale
+) {
+    //! <b>[declare]</b>
+    /// Without XRender window is captured in full and resized on client.
+    /// @code{.cpp}
+    XWindowAttributes l_windowAttributes;
+
+    resolve( l_windowAttributes );
+
+    if ( !_captureWidth ) {
+        _captureWidth = l_windowAttributes.width;
+    }
+
+    if ( !_captureHeight ) {
+        _captureHeight = l_windowAttributes.height;
+    }
+
+    const uint32_t l_downscale    = std::max< uint32_t >( _downscale, 1 );
+    const uint32_t l_renderScale  = ( m_isRender ? l_downscale : 1 );
+    const uint32_t l_renderWidth  = ( ( _captureWidth + l_renderScale - 1 ) / l_renderScale );
+    const uint32_t l_renderHeight = ( ( _captureHeight + l_renderScale - 1 ) / l_renderScale );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[canvas]</b>
+    /// Shared memory image is reused while capture size and scale are the same.
+    /// Errors of capture requests are collected until it is read.
+    /// @code{.cpp}
+    xErrorTrap_t l_errorTrap( m_display.get() );
+
+    if (
+        !m_xImage ||
+        ( static_cast< uint32_t >( m_xImage->width ) != l_renderWidth ) ||
+        ( static_cast< uint32_t >( m_xImage->height ) != l_renderHeight ) ||
+        ( m_downscale != l_renderScale )
+    ) {
+        detach();
+        attach( l_renderWidth, l_renderHeight, l_renderScale );
+    }
+    /// @endcode
+    //! <b>[canvas]</b>
+
+    //! <b>[capture]</b>
+    /// Shared pixmap is filled by server in place, once composite is done.
+    /// @code{.cpp}
+    if ( m_windowPicture ) {
+        traceScope_t l_captureTrace( "XRenderComposite" );
+
+        XRenderComposite(
+            m_display.get(),
+            PictOpSrc,
+            m_windowPicture,
+            None,
+            m_pixmapPicture,
+            0,
+            0,
+            0,
+            0,
+            0,
+            0,
+            l_renderWidth,
+            l_renderHeight
+        );
+
+        if ( m_isSharedPixmaps ) {
+            XSync( m_display.get(), False );
+
+        } else {
+            XShmGetImage(
+                m_display.get(),
+                m_pixmap,
+                m_xImage,
+                0,
+                0,
+                0x00ffffff
+            );
+        }
+
+    } else {
+        traceScope_t l_captureTrace( "XShmGetImage" );
+
+        XShmGetImage(
+            m_display.get(),
+            m_window,
+            m_xImage,
+            0,
+            0,
+            0x00ffffff
+        );
+    }
+    /// @endcode
+    //! <b>[capture]</b>
+
+    //! <b>[check_capture]</b>
+    /// Window resized or unmapped during capture gives no image, shared memory image is recreated on next frame.
+    /// @code{.cpp}
+    if ( l_errorTrap.isFailed() ) {
+        detach();
+
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't capture window {}",
+                m_windowName
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[check_capture]</b>
+
+    //! <b>[color]</b>
+    /// Convert source image to template's color format.
+    /// @code{.cpp}
+    cv::Mat l_image = cv::Mat(
+        l_renderHeight,
+        l_renderWidth,
+        CV_8UC4,
+        m_xImage->data,
+        m_xImage->bytes_per_line
+    );
+
+    _image = _matPool.acquire( l_renderHeight, l_renderWidth, CV_8UC3 );
+
+    traceScope_t l_colorTrace( "cvtColor" );
+
+    cv::cvtColor(
+        l_image,
+        *_image,
+        cv::COLOR_RGB2BGR
+    );
+
+    l_colorTrace.end();
+    /// @endcode
+    //! <b>[color]</b>
+
+    //! <b>[resize]</b>
+    /// Fallback of server downscaling, averages the same pixels.
+    /// @code{.cpp}
+    if ( l_renderScale != l_downscale ) {
+        matPool_t::lease_t l_resizedImage = _matPool.acquire(
+            ( ( _captureHeight + l_downscale - 1 ) / l_downscale ),
+            ( ( _captureWidth + l_downscale - 1 ) / l_downscale ),
+            CV_8UC3
+        );
+        traceScope_t       l_resizeTrace( "resize" );
+
+        cv::resize( *_image, *l_resizedImage, l_resizedImage->size(), 0, 0, cv::INTER_AREA );
+
+        _image = std::move( l_resizedImage );
+    }
+    /// @endcode
+    //! <b>[resize]</b>
+}
+
+///////////////
+/// @brief Get \c cv::Mat object from window capture.
+/// @details Capture width and height should be less or equal to window's.
+/// Capture of every window is kept open between calls.
+/// @param[in] _sourceWindowName Window handle.
+/// @param[in] _matPool Pool to borrow image from.
+/// @param[in] _captureWidth Capture width. Optional.
+/// @param[in] _captureHeight Capture height. Optional.
+/// @param[in] _downscale Capture is this many times smaller than window. Optional.
+/// @return Window capture.
+///////////////
+static matPool_t::lease_t getMatFromWindow(
+    const std::string& _sourceWindowName,
+    matPool_t&         _matPool,
+    uint32_t           _captureWidth  = 0,
+    uint32_t           _captureHeight = 0,
+    uint32_t           _downscale     = 1
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    static std::map< std::string, std::unique_ptr< windowCapture_t > > l_windowCaptures;
+    static std::mutex                                                   l_windowCapturesMutex;
+
+    std::lock_guard< std::mutex > l_lock( l_windowCapturesMutex );
+
+    std::unique_ptr< windowCapture_t >& l_windowCapture = l_windowCaptures[ _sourceWindowName ];
+    matPool_t::lease_t                  l_image;
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[capture]</b>
+    /// Failed capture is dropped from cache, next call opens window again.
+    /// @code{.cpp}
+    try {
+        if ( !l_windowCapture ) {
+            l_windowCapture.reset( new windowCapture_t( _sourceWindowName ) );
+        }
+
+        l_windowCapture->capture(
+            _matPool,
+            l_image,
+            _captureWidth,
+            _captureHeight,
+            _downscale
+        );
+
+    } catch ( ... ) {
+        l_windowCaptures.erase( _sourceWindowName );
+
+        throw;
+    }
+    /// @endcode
+    //! <b>[capture]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_image );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+#endif // _WIN32
+
+///////////////
+/// @brief Get template image.
+/// @details Template is loaded once per process, next calls return cached image.
+/// Throws ios_base::failure at error.
+/// @param[in] _templateImage Template image path.
+/// @return Template image.
+///////////////
+static const cv::Mat& getTemplateImage( const std::string& _templateImage ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    static std::map< std::string, cv::Mat > l_templateImagesCache;
+    static std::mutex                       l_templateImagesCacheMutex;
+
+    std::lock_guard< std::mutex > l_lock( l_templateImagesCacheMutex );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[check_cache]</b>
+    /// Map never erases, so returned reference stays valid.
+    /// @code{.cpp}
+    auto l_cachedImage = l_templateImagesCache.find( _templateImage );
+
+    if ( l_cachedImage != l_templateImagesCache.end() ) {
+        return ( l_cachedImage->second );
+    }
+    /// @endcode
+    //! <b>[check_cache]</b>
+
+    //! <b>[load_template]</b>
+    /// Load template image.
+    /// @code{.cpp}
+    traceScope_t l_trace( "imread" );
+
+    cv::Mat l_templateImage = cv::imread( _templateImage, cv::IMREAD_COLOR );
+
+    l_trace.end();
+
+    if ( l_templateImage.empty() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't read template image {}",
+                _templateImage
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[load_template]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_templateImagesCache[ _templateImage ] = l_templateImage );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Create ORB detector shared by templates and source images.
+/// @param[in] _featuresCount Maximum number of features to retain.
+/// @return ORB detector.
+///////////////
+static cv::Ptr< cv::ORB > createFeatureDetector( uint32_t _featuresCount ) {
+    //! <b>[return]</b>
+    /// Patch size is the same for both sides, otherwise descriptors are not comparable.
+    /// @code{.cpp}
+    return (
+        cv::ORB::create(
+            _featuresCount,
+            1.2f,
+            8,
+            FEATURE_PATCH_SIZE, // Edge threshold
+            0,
+            2,
+            cv::ORB::HARRIS_SCORE,
+            FEATURE_PATCH_SIZE
+        )
+    );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Get ORB keypoints and descriptors of template.
+/// @details Template is loaded and detected once per process, next calls return cached features.
+/// Throws ios_base::failure at error.
+/// @param[in] _templateImage Template image path.
+/// @return Template features.
+///////////////
+static const templateFeatures_t& getTemplateFeatures( const std::string& _templateImage ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    static std::map< std::string, templateFeatures_t > l_templateFeaturesCache;
+    static std::mutex                                   l_templateFeaturesCacheMutex;
+
+    std::lock_guard< std::mutex > l_lock( l_templateFeaturesCacheMutex );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[check_cache]</b>
+    /// Map never erases, so returned reference stays valid.
+    /// @code{.cpp}
+    auto l_cachedFeatures = l_templateFeaturesCache.find( _templateImage );
+
+    if ( l_cachedFeatures != l_templateFeaturesCache.end() ) {
+        return ( l_cachedFeatures->second );
+    }
+    /// @endcode
+    //! <b>[check_cache]</b>
+
+    //! <b>[load_template]</b>
+    /// Template image is shared with pixel matching.
+    /// @code{.cpp}
+    cv::Mat l_templateImage;
+
+    cv::cvtColor(
+        getTemplateImage( _templateImage ),
+        l_templateImage,
+        cv::COLOR_BGR2GRAY
+    );
+    /// @endcode
+    //! <b>[load_template]</b>
+
+    //! <b>[detect]</b>
+    /// @code{.cpp}
+    templateFeatures_t l_templateFeatures;
+
+    l_templateFeatures.size = l_templateImage.size();
+
+    createFeatureDetector( TEMPLATE_FEATURES_COUNT )->detectAndCompute(
+        l_templateImage,
+        cv::noArray(),
+        l_templateFeatures.keypoints,
+        l_templateFeatures.descriptors
+    );
+    /// @endcode
+    //! <b>[detect]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_templateFeaturesCache[ _templateImage ] = std::move( l_templateFeatures ) );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Add matching time of template to its histogram.
+/// @param[in] _templateId Template ID.
+/// @param[in] _latency Matching time.
+///////////////
+static void recordTemplateLatency( size_t _templateId, std::chrono::nanoseconds _latency ) {
+    getMetrics().templates[ std::min< size_t >( _templateId, ( METRICS_TEMPLATES_COUNT - 1 ) ) ].record( _latency );
+}
+
+///////////////
+/// @brief Runs task on thread pool for every template or only for selected ones.
+/// @param[in] _threadPool Pool to run task on.
+/// @param[in] _templatesCount Templates count.
+/// @param[in,out] _selection Selected templates, time spent on each is stored. All templates if \c NULL .
+/// @param[in] _task Task taking template ID.
+/// @param[in] _sharedCosts Time spent on template before task, indexed by template ID and added to its time. None if \c NULL .
+///////////////
+static void forEachTemplate(
+    threadPool_t&                                  _threadPool,
+    size_t                                         _templatesCount,
+    templateSelection_t*                           _selection,
+    const std::function< void( size_t ) >&         _task,
+    const std::vector< std::chrono::nanoseconds >* _sharedCosts = NULL
+) {
+    //! <b>[shared_cost]</b>
+    /// @code{.cpp}
+    auto sharedCost = [ _sharedCosts ]( size_t _templateId ) {
+        return ( _sharedCosts ? ( *_sharedCosts )[ _templateId ] : std::chrono::nanoseconds( 0 ) );
+    };
+    /// @endcode
+    //! <b>[shared_cost]</b>
+
+    //! <b>[all]</b>
+    /// @code{.cpp}
+    if ( !_selection ) {
+        _threadPool.parallelFor(
+            _templatesCount,
+            [ & ]( size_t _templateId ) {
+                const std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+                traceScope_t                                l_trace( "template", _templateId );
+
+                _task( _templateId );
+
+                l_trace.end();
+
+                recordTemplateLatency( _templateId, ( ( std::chrono::steady_clock::now() - l_start ) + sharedCost( _templateId ) ) );
+            }
+        );
+
+        return;
+    }
+    /// @endcode
+    //! <b>[all]</b>
+
+    //! <b>[selected]</b>
+    /// @code{.cpp}
+    _selection->durations.assign( _selection->templateIds.size(), std::chrono::nanoseconds( 0 ) );
+
+    _threadPool.parallelFor(
+        _selection->templateIds.size(),
+        [ & ]( size_t _selectionIndex ) {
+            const std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+            traceScope_t                                l_trace( "template", _selection->templateIds[ _selectionIndex ] );
+
+            _task( _selection->templateIds[ _selectionIndex ] );
+
+            l_trace.end();
+
+            _selection->durations[ _selectionIndex ] = (
+                ( std::chrono::steady_clock::now() - l_start ) +
+                sharedCost( _selection->templateIds[ _selectionIndex ] )
+            );
+
+            recordTemplateLatency( _selection->templateIds[ _selectionIndex ], _selection->durations[ _selectionIndex ] );
+        }
+    );
+    /// @endcode
+    //! <b>[selected]</b>
+}
+
+///////////////
+/// @brief Locates templates by ORB features instead of pixel correlation.
+/// @details Source image features are detected once and indexed with LSH,
+/// every template is matched against that shared index and located by homography.
+/// Templates without enough inliers are published as not found.
+/// Throws ios_base::failure at error.
+/// @param[in] _image 2D image array where the search is running.
+/// @param[in] _templateImages Searched templates, index is template ID.
+/// @param[in] _results Table to publish results to.
+/// @param[in] _frame Frame sequence number.
+/// @param[in] _matPool Pool to borrow buffers from.
+/// @param[in] _threadPool Pool to match templates on.
+/// @param[out] _outlines Outlines of found images, not collected if \c NULL .
+/// @param[in,out] _selection Templates to match, all if \c NULL .
+/// @param[in] _downscale Times window is larger than image, published centers are multiplied by it.
+///////////////
+static void matchTemplatesFeatures(
+    const cv::Mat&                    _image,
+    const std::vector< std::string >& _templateImages,
+    matchResults_t&                   _results,
+    uint64_t                          _frame,
+    matPool_t&                        _matPool,
+    threadPool_t&                     _threadPool,
+    outlines_t*                       _outlines,
+    templateSelection_t*              _selection,
+    uint32_t                          _downscale
+) {
+    //! <b>[detect]</b>
+    /// Detect source image features once for all templates.
+    /// @code{.cpp}
+    matPool_t::lease_t          l_grayImage = _matPool.acquire( _image.rows, _image.cols, CV_8UC1 );
+    std::vector< cv::KeyPoint > l_imageKeypoints;
+    cv::Mat                     l_imageDescriptors;
+
+    cv::cvtColor(
+        _image,
+        *l_grayImage,
+        cv::COLOR_BGR2GRAY
+    );
+
+    createFeatureDetector( IMAGE_FEATURES_COUNT )->detectAndCompute(
+        *l_grayImage,
+        cv::noArray(),
+        l_imageKeypoints,
+        l_imageDescriptors
+    );
+
+    if ( l_imageDescriptors.empty() ) {
+        forEachTemplate(
+            _threadPool,
+            _templateImages.size(),
+            _selection,
+            [ & ]( size_t _templateId ) {
+                _results.publish( _templateId, { 0, 0, 0, _frame, false } );
+            }
+        );
+
+        return;
+    }
+    /// @endcode
+    //! <b>[detect]</b>
+
+    //! <b>[index]</b>
+    /// Index binary descriptors with locality sensitive hashing.
+    /// @code{.cpp}
+    cv::FlannBasedMatcher l_matcher(
+        cv::makePtr< cv::flann::LshIndexParams >(
+            6,  // Table number
+            12, // Key size
+            1   // Multi probe level
+        ),
+        cv::makePtr< cv::flann::SearchParams >( 50 )
+    );
+
+    l_matcher.add( { l_imageDescriptors } );
+    l_matcher.train();
+
+    std::mutex l_outlinesMutex;
+    /// @endcode
+    //! <b>[index]</b>
+
+    auto matchTemplate = [ & ]( size_t _templateId ) {
+        //! <b>[declare]</b>
+        /// @code{.cpp}
+        const templateFeatures_t& l_templateFeatures = getTemplateFeatures( _templateImages[ _templateId ] );
+        std::vector< std::vector< cv::DMatch > > l_matches;
+        std::vector< cv::Point2f > l_templatePoints;
+        std::vector< cv::Point2f > l_imagePoints;
+        matchResult_t l_result;
+
+        l_result.frame = _frame;
+
+        if ( l_templateFeatures.descriptors.rows < FEATURE_MINIMUM_INLIERS ) {
+            _results.publish( _templateId, l_result );
+
+            return;
+        }
+        /// @endcode
+        //! <b>[declare]</b>
+
+        //! <b>[match_descriptors]</b>
+        /// Keep matches passing ratio test.
+        /// @code{.cpp}
+        l_matcher.knnMatch(
+            l_templateFeatures.descriptors,
+            l_matches,
+            2
+        );
+
+        for ( const std::vector< cv::DMatch >& _neighbours : l_matches ) {
+            if (
+                _neighbours.empty() ||
+                (
+                    ( _neighbours.size() > 1 ) &&
+                    ( _neighbours[ 0 ].distance >= ( FEATURE_RATIO_THRESHOLD * _neighbours[ 1 ].distance ) )
+                )
+            ) {
+                continue;
+            }
+
+            l_templatePoints.push_back( l_templateFeatures.keypoints[ _neighbours[ 0 ].queryIdx ].pt );
+            l_imagePoints.push_back( l_imageKeypoints[ _neighbours[ 0 ].trainIdx ].pt );
+        }
+
+        if ( l_templatePoints.size() < FEATURE_MINIMUM_INLIERS ) {
+            _results.publish( _templateId, l_result );
+
+            return;
+        }
+        /// @endcode
+        //! <b>[match_descriptors]</b>
+
+        //! <b>[homography]</b>
+        /// Estimate template placement on source image.
+        /// @code{.cpp}
+        cv::Mat l_inliersMask;
+        cv::Mat l_homography = cv::findHomography(
+            l_templatePoints,
+            l_imagePoints,
+            cv::RANSAC,
+            FEATURE_REPROJECTION_THRESHOLD,
+            l_inliersMask
+        );
+        const int l_inliersCount = (
+            l_homography.empty()
+            ? 0
+            : cv::countNonZero( l_inliersMask )
+        );
+
+        if ( l_inliersCount < FEATURE_MINIMUM_INLIERS ) {
+            _results.publish( _templateId, l_result );
+
+            return;
+        }
+        /// @endcode
+        //! <b>[homography]</b>
+
+        //! <b>[project]</b>
+        /// Project template corners and center to source image.
+        /// @code{.cpp}
+        const float l_width  = static_cast< float >( l_templateFeatures.size.width );
+        const float l_height = static_cast< float >( l_templateFeatures.size.height );
+
+        std::vector< cv::Point2f > l_templateCorners = {
+            cv::Point2f( 0, 0 ),
+            cv::Point2f( l_width, 0 ),
+            cv::Point2f( l_width, l_height ),
+            cv::Point2f( 0, l_height ),
+            cv::Point2f( ( l_width / 2 ), ( l_height / 2 ) )
+        };
+        std::vector< cv::Point2f > l_imageCorners;
+
+        cv::perspectiveTransform(
+            l_templateCorners,
+            l_imageCorners,
+            l_homography
+        );
+
+        const cv::Point2f l_center = l_imageCorners.back();
+
+        l_imageCorners.pop_back();
+        /// @endcode
+        //! <b>[project]</b>
+
+        //! <b>[publish]</b>
+        /// Publish template center, inliers count is the score.
+        /// @code{.cpp}
+        l_result.x     = static_cast< uint32_t >( std::max( ( l_center.x * _downscale ), 0.0f ) );
+        l_result.y     = static_cast< uint32_t >( std::max( ( l_center.y * _downscale ), 0.0f ) );
+        l_result.score = l_inliersCount;
+        l_result.found = true;
+
+        _results.publish( _templateId, l_result );
+        /// @endcode
+        //! <b>[publish]</b>
+
+        //! <b>[outline]</b>
+        /// Collect outline only if result is shown.
+        /// @code{.cpp}
+        if ( _outlines ) {
+            std::lock_guard< std::mutex > l_lock( l_outlinesMutex );
+
+            _outlines->emplace_back(
+                l_imageCorners.begin(),
+                l_imageCorners.end()
+            );
+        }
+        /// @endcode
+        //! <b>[outline]</b>
+    };
+
+    //! <b>[match_templates]</b>
+    /// Matching templates against shared source image index.
+    /// @code{.cpp}
+    forEachTemplate(
+        _threadPool,
+        _templateImages.size(),
+        _selection,
+        std::ref( matchTemplate )
+    );
+    /// @endcode
+    //! <b>[match_templates]</b>
+}
+
+///////////////
+/// @brief Hash of image tile.
+/// @details Four independent lanes take 8 bytes each, so the loop is not bound by one multiply chain.
+/// Every step is a bijection of lane state, changing any single word always changes the hash.
+/// @param[in] _image Image.
+/// @param[in] _tile Tile of image.
+/// @return Tile hash.
+///////////////
+static uint64_t hashTile( const cv::Mat& _image, const cv::Rect& _tile ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const size_t l_elementSize = _image.elemSize();
+    const size_t l_rowSize     = ( _tile.width * l_elementSize );
+    uint64_t     l_lanes[ 4 ]  = { 1, 2, 3, 4 };
+    uint64_t     l_word;
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[hash]</b>
+    /// @code{.cpp}
+    for ( int _row = _tile.y; _row < ( _tile.y + _tile.height ); _row++ ) {
+        const uint8_t* l_data = ( _image.ptr< uint8_t >( _row ) + ( _tile.x * l_elementSize ) );
+        size_t         l_offset = 0;
+
+        for ( ; ( l_offset + 32 ) <= l_rowSize; l_offset += 32 ) {
+            for ( size_t _lane = 0; _lane < 4; _lane++ ) {
+                std::memcpy( &l_word, ( l_data + l_offset + ( _lane * 8 ) ), sizeof( l_word ) );
+
+                l_lanes[ _lane ] = ( ( l_lanes[ _lane ] ^ l_word ) * TILE_HASH_PRIME );
+            }
+        }
+
+        for ( ; ( l_offset + 8 ) <= l_rowSize; l_offset += 8 ) {
+            std::memcpy( &l_word, ( l_data + l_offset ), sizeof( l_word ) );
+
+            l_lanes[ 0 ] = ( ( l_lanes[ 0 ] ^ l_word ) * TILE_HASH_PRIME );
+        }
+
+        for ( ; l_offset < l_rowSize; l_offset++ ) {
+            l_lanes[ 1 ] = ( ( l_lanes[ 1 ] ^ l_data[ l_offset ] ) * TILE_HASH_PRIME );
+        }
+    }
+    /// @endcode
+    //! <b>[hash]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return (
+        l_lanes[ 0 ] ^
+        ( ( l_lanes[ 1 ] << 17 ) | ( l_lanes[ 1 ] >> 47 ) ) ^
+        ( ( l_lanes[ 2 ] << 31 ) | ( l_lanes[ 2 ] >> 33 ) ) ^
+        ( ( l_lanes[ 3 ] << 47 ) | ( l_lanes[ 3 ] >> 17 ) )
+    );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Keeps response maps between frames and recomputes only offsets over changed tiles.
+/// @details Frame is split to \c CHANGE_TILE_SIZE tiles, tile is changed if its hash differs from previous frame.
+/// Changes are collected per template until it is matched, so templates skipped by scheduler stay correct.
+/// \c match may run concurrently for different templates, \c detect may not.
+///////////////
+class incrementalMatcher_t {
+public:
+    ///////////////
+    /// @brief Hash tiles of new frame and remember changed ones.
+    /// @param[in] _image New frame.
+    /// @param[in] _templatesCount Templates count, all responses are dropped if it changes.
+    /// @return Anything changed.
+    ///////////////
+    bool detect( const cv::Mat& _image, size_t _templatesCount );
+
+    ///////////////
+    /// @brief Bring response map of template up to date with last detected frame.
+    /// @param[in] _templateId Template ID.
+    /// @param[in] _image Last detected frame.
+    /// @param[in] _templateImage Template image.
+    /// @param[in] _matchMethod Parameter specifying the comparison method.
+    /// @return Response map of template.
+    ///////////////
+    const cv::Mat& match(
+        size_t         _templateId,
+        const cv::Mat& _image,
+        const cv::Mat& _templateImage,
+        uint32_t       _matchMethod
+    );
+
+    ///////////////
+    /// @brief Bring response maps of templates of the same size up to date with \c matchTemplateBatch .
+    /// @details Changed cells of any of them are recomputed for all at once, unchanged values are equal anyway.
+    /// Runs on caller thread before templates are matched, not concurrently with \c match .
+    /// @param[in] _templateIds Template IDs.
+    /// @param[in] _image Last detected frame.
+    /// @param[in] _templateImages Templates of the same size and type as each other and image, in order of IDs.
+    /// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes .
+    /// @param[in] _matPool Pool to borrow buffers from.
+    /// @param[in] _threadPool Pool to compute response rows on.
+    /// @param[out] _responses Response map of every template, in order of IDs.
+    ///////////////
+    void matchBatch(
+        const std::vector< size_t >&         _templateIds,
+        const cv::Mat&                       _image,
+        const std::vector< const cv::Mat* >& _templateImages,
+        uint32_t                             _matchMethod,
+        matPool_t&                           _matPool,
+        threadPool_t&                        _threadPool,
+        std::vector< cv::Mat >&              _responses
+    );
+
+private:
+    void forEachChangedCells(
+        const std::vector< uint8_t >&                   _changedTiles,
+        cv::Size                                        _responseSize,
+        cv::Size                                        _templateSize,
+        const std::function< void( const cv::Rect& ) >& _update
+    ) const;
+
+    //! <b>[struct]</b>
+    /// @code{.cpp}
+    struct response_t {
+        cv::Mat                image;
+        std::vector< uint8_t > changedTiles; // Changed since response was computed
+        bool                   isValid = false;
+    };
+    /// @endcode
+    //! <b>[struct]</b>
+
+    cv::Size                  m_imageSize;
+    int                       m_imageType = -1;
+    int                       m_tilesColumns = 0;
+    int                       m_tilesRows    = 0;
+    std::vector< uint64_t >   m_tileHashes;
+    std::vector< response_t > m_responses;
+};
+
+bool incrementalMatcher_t::detect( const cv::Mat& _image, size_t _templatesCount ) {
+    //! <b>[reset]</b>
+    /// New size or templates drop everything.
+    /// @code{.cpp}
+    const bool l_isReset = (
+        ( _image.size() != m_imageSize ) ||
+        ( _image.type() != m_imageType ) ||
+        ( _templatesCount != m_responses.size() )
+    );
+
+    if ( l_isReset ) {
+        m_imageSize    = _image.size();
+        m_imageType    = _image.type();
+        m_tilesColumns = ( ( _image.cols + CHANGE_TILE_SIZE - 1 ) / CHANGE_TILE_SIZE );
+        m_tilesRows    = ( ( _image.rows + CHANGE_TILE_SIZE - 1 ) / CHANGE_TILE_SIZE );
+
+        m_tileHashes.assign( ( m_tilesColumns * m_tilesRows ), 0 );
+        m_responses.assign( _templatesCount, response_t() );
+    }
+    /// @endcode
+    //! <b>[reset]</b>
+
+    //! <b>[hash]</b>
+    /// @code{.cpp}
+    std::vector< uint8_t > l_changedTiles( m_tileHashes.size(), 0 );
+    bool                   l_isChanged = l_isReset;
+
+    for ( int _tileRow = 0; _tileRow < m_tilesRows; _tileRow++ ) {
+        for ( int _tileColumn = 0; _tileColumn < m_tilesColumns; _tileColumn++ ) {
+            const cv::Rect l_tile = (
+                cv::Rect(
+                    ( _tileColumn * CHANGE_TILE_SIZE ),
+                    ( _tileRow * CHANGE_TILE_SIZE ),
+                    CHANGE_TILE_SIZE,
+                    CHANGE_TILE_SIZE
+                ) &
+                cv::Rect( 0, 0, _image.cols, _image.rows )
+            );
+            const size_t   l_tileIndex = ( ( _tileRow * m_tilesColumns ) + _tileColumn );
+            const uint64_t l_tileHash  = hashTile( _image, l_tile );
+
+            if ( l_tileHash != m_tileHashes[ l_tileIndex ] ) {
+                m_tileHashes[ l_tileIndex ]   = l_tileHash;
+                l_changedTiles[ l_tileIndex ] = 1;
+                l_isChanged                   = true;
+            }
+        }
+    }
+    /// @endcode
+    //! <b>[hash]</b>
+
+    //! <b>[collect]</b>
+    /// @code{.cpp}
+    if ( l_isChanged && !l_isReset ) {
+        for ( response_t& _response : m_responses ) {
+            for ( size_t _tileIndex = 0; _tileIndex < l_changedTiles.size(); _tileIndex++ ) {
+                _response.changedTiles[ _tileIndex ] |= l_changedTiles[ _tileIndex ];
+            }
+        }
+    }
+    /// @endcode
+    //! <b>[collect]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_isChanged );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+const cv::Mat& incrementalMatcher_t::match(
+    size_t         _templateId,
+    const cv::Mat& _image,
+    const cv::Mat& _templateImage,
+    uint32_t       _matchMethod
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    response_t&    l_response = m_responses[ _templateId ];
+    const cv::Size l_responseSize(
+        ( _image.cols - _templateImage.cols + 1 ),
+        ( _image.rows - _templateImage.rows + 1 )
+    );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[full]</b>
+    /// First match computes whole response.
+    /// @code{.cpp}
+    if ( !l_response.isValid || ( l_response.image.size() != l_responseSize ) ) {
+        cv::matchTemplate( _image, _templateImage, l_response.image, _matchMethod );
+
+        l_response.changedTiles.assign( m_tileHashes.size(), 0 );
+        l_response.isValid = true;
+
+        return ( l_response.image );
+    }
+    /// @endcode
+    //! <b>[full]</b>
+
+    //! <b>[update]</b>
+    /// Every value depends only on image under template, so partial result equals full one.
+    /// Writing into response ROI of the same size and type doesn't reallocate it.
+    /// @code{.cpp}
+    forEachChangedCells(
+        l_response.changedTiles,
+        l_responseSize,
+        _templateImage.size(),
+        [ & ]( const cv::Rect& _cells ) {
+            cv::Mat l_cellsResponse = l_response.image( _cells );
+
+            cv::matchTemplate(
+                _image(
+                    cv::Rect(
+                        _cells.x,
+                        _cells.y,
+                        ( _cells.width + _templateImage.cols - 1 ),
+                        ( _cells.height + _templateImage.rows - 1 )
+                    )
+                ),
+                _templateImage,
+                l_cellsResponse,
+                _matchMethod
+            );
+        }
+    );
+
+    std::fill( l_response.changedTiles.begin(), l_response.changedTiles.end(), 0 );
+    /// @endcode
+    //! <b>[update]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_response.image );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Call update for every run of response cells whose template footprint overlaps changed tile.
+/// @details Response is split to cells of tile size. Cell is changed if footprint of template
+/// at any of its offsets overlaps changed tile, neighbour changed cells of a row make one run.
+/// @param[in] _changedTiles Changed tiles flags.
+/// @param[in] _responseSize Response map size.
+/// @param[in] _templateSize Template size.
+/// @param[in] _update Recomputes response in rectangle of cells, clipped to response.
+///////////////
+void incrementalMatcher_t::forEachChangedCells(
+    const std::vector< uint8_t >&                   _changedTiles,
+    cv::Size                                        _responseSize,
+    cv::Size                                        _templateSize,
+    const std::function< void( const cv::Rect& ) >& _update
+) const {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const int l_cellsColumns = ( ( _responseSize.width + CHANGE_TILE_SIZE - 1 ) / CHANGE_TILE_SIZE );
+    const int l_cellsRows    = ( ( _responseSize.height + CHANGE_TILE_SIZE - 1 ) / CHANGE_TILE_SIZE );
+
+    auto isCellChanged = [ & ]( int _cellColumn, int _cellRow ) {
+        const int l_lastTileColumn = std::min(
+            ( m_tilesColumns - 1 ),
+            ( ( ( _cellColumn + 1 ) * CHANGE_TILE_SIZE ) + _templateSize.width - 2 ) / CHANGE_TILE_SIZE
+        );
+        const int l_lastTileRow = std::min(
+            ( m_tilesRows - 1 ),
+            ( ( ( _cellRow + 1 ) * CHANGE_TILE_SIZE ) + _templateSize.height - 2 ) / CHANGE_TILE_SIZE
+        );
+
+        for ( int _tileRow = _cellRow; _tileRow <= l_lastTileRow; _tileRow++ ) {
+            for ( int _tileColumn = _cellColumn; _tileColumn <= l_lastTileColumn; _tileColumn++ ) {
+                if ( _changedTiles[ ( _tileRow * m_tilesColumns ) + _tileColumn ] ) {
+                    return ( true );
+                }
+            }
+        }
+
+        return ( false );
+    };
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[runs]</b>
+    /// @code{.cpp}
+    for ( int _cellRow = 0; _cellRow < l_cellsRows; _cellRow++ ) {
+        int _cellColumn = 0;
+
+        while ( _cellColumn < l_cellsColumns ) {
+            if ( !isCellChanged( _cellColumn, _cellRow ) ) {
+                _cellColumn++;
+
+                continue;
+            }
+
+            const int l_firstCellColumn = _cellColumn;
+
+            while ( ( _cellColumn < l_cellsColumns ) && isCellChanged( _cellColumn, _cellRow ) ) {
+                _cellColumn++;
+            }
+
+            _update(
+                cv::Rect(
+                    ( l_firstCellColumn * CHANGE_TILE_SIZE ),
+                    ( _cellRow * CHANGE_TILE_SIZE ),
+                    ( ( _cellColumn - l_firstCellColumn ) * CHANGE_TILE_SIZE ),
+                    CHANGE_TILE_SIZE
+                ) &
+                cv::Rect( cv::Point( 0, 0 ), _responseSize )
+            );
+        }
+    }
+    /// @endcode
+    //! <b>[runs]</b>
+}
+
+const char* matchStrategyName( matchStrategy_t _strategy ) {
+    static const char* const l_names[ MATCH_STRATEGY_COUNT ] = {
+        "direct",
+        "gray",
+        "pyramid",
+        "gray_pyramid"
+    };
+
+    return ( ( _strategy < MATCH_STRATEGY_COUNT ) ? l_names[ _strategy ] : "unknown" );
+}
+
+static bool isGrayStrategy( matchStrategy_t _strategy ) {
+    return ( ( _strategy == MATCH_STRATEGY_GRAY ) || ( _strategy == MATCH_STRATEGY_GRAY_PYRAMID ) );
+}
+
+static bool isPyramidStrategy( matchStrategy_t _strategy ) {
+    return ( ( _strategy == MATCH_STRATEGY_PYRAMID ) || ( _strategy == MATCH_STRATEGY_GRAY_PYRAMID ) );
+}
+
+//! <b>[struct]</b>
+/// Template converted for strategy.
+/// @code{.cpp}
+struct templateVariant_t {
+    cv::Mat image;  // Color or gray
+    cv::Mat coarse; // Half resolution, empty if template is too small for pyramid
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Get cached template converted for strategy.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _templateImage Template image path.
+/// @param[in] _isGray Single channel variant.
+/// @return Template variant, reference stays valid.
+///////////////
+static const templateVariant_t& getTemplateVariant( const std::string& _templateImage, bool _isGray ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    static std::map< std::pair< std::string, bool >, templateVariant_t > l_templateVariantsCache;
+    static std::mutex                                                    l_templateVariantsCacheMutex;
+
+    const cv::Mat&                l_templateImage = getTemplateImage( _templateImage );
+    std::lock_guard< std::mutex > l_lock( l_templateVariantsCacheMutex );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[check_cache]</b>
+    /// Map never erases, so returned reference stays valid.
+    /// @code{.cpp}
+    auto l_cachedVariant = l_templateVariantsCache.find( { _templateImage, _isGray } );
+
+    if ( l_cachedVariant != l_templateVariantsCache.end() ) {
+        return ( l_cachedVariant->second );
+    }
+    /// @endcode
+    //! <b>[check_cache]</b>
+
+    //! <b>[convert]</b>
+    /// @code{.cpp}
+    templateVariant_t& l_templateVariant = l_templateVariantsCache[ { _templateImage, _isGray } ];
+
+    if ( _isGray ) {
+        cv::cvtColor( l_templateImage, l_templateVariant.image, cv::COLOR_BGR2GRAY );
+
+    } else {
+        l_templateVariant.image = l_templateImage;
+    }
+
+    if (
+        ( l_templateImage.cols >= ( PYRAMID_MINIMUM_SIZE * 2 ) ) &&
+        ( l_templateImage.rows >= ( PYRAMID_MINIMUM_SIZE * 2 ) )
+    ) {
+        cv::pyrDown( l_templateVariant.image, l_templateVariant.coarse );
+    }
+    /// @endcode
+    //! <b>[convert]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_templateVariant );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Template downscaled as frames captured with the same scale.
+/// @details Variant is made once per process and scale, next calls return cached image.
+/// Throws ios_base::failure at error.
+/// @param[in] _templateImage Template image path.
+/// @param[in] _downscale Times template is larger than returned image.
+/// @return Downscaled template image.
+///////////////
+static const cv::Mat& getScaledTemplateImage( const std::string& _templateImage, uint32_t _downscale ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    static std::map< std::pair< std::string, uint32_t >, cv::Mat > l_scaledTemplatesCache;
+    static std::mutex                                               l_scaledTemplatesCacheMutex;
+
+    const cv::Mat&                l_templateImage = getTemplateImage( _templateImage );
+    std::lock_guard< std::mutex > l_lock( l_scaledTemplatesCacheMutex );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[check_cache]</b>
+    /// Map never erases, so returned reference stays valid.
+    /// @code{.cpp}
+    cv::Mat& l_scaledTemplate = l_scaledTemplatesCache[ { _templateImage, _downscale } ];
+
+    if ( !l_scaledTemplate.empty() ) {
+        return ( l_scaledTemplate );
+    }
+    /// @endcode
+    //! <b>[check_cache]</b>
+
+    //! <b>[resize]</b>
+    /// Area interpolation averages the same pixels as box filter of downscaled capture.
+    /// @code{.cpp}
+    cv::resize(
+        l_templateImage,
+        l_scaledTemplate,
+        cv::Size(
+            std::max< int >( ( l_templateImage.cols / _downscale ), 1 ),
+            std::max< int >( ( l_templateImage.rows / _downscale ), 1 )
+        ),
+        0,
+        0,
+        cv::INTER_AREA
+    );
+
+    return ( l_scaledTemplate );
+    /// @endcode
+    //! <b>[resize]</b>
+}
+
+//! <b>[struct]</b>
+/// Frame converted once for all templates, only conversions some strategy needs are made.
+/// @code{.cpp}
+struct strategyFrames_t {
+    cv::Mat            image;      // Frame as given
+    matPool_t::lease_t gray;
+    matPool_t::lease_t coarse;     // Half resolution of frame
+    matPool_t::lease_t coarseGray; // Half resolution of gray frame
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Convert frame for strategies.
+/// @param[in] _image Frame.
+/// @param[in] _isGray Make gray frame.
+/// @param[in] _isPyramid Make half resolution frame of color frame.
+/// @param[in] _isGrayPyramid Make half resolution frame of gray frame.
+/// @param[in] _matPool Pool to borrow buffers from.
+/// @param[out] _frames Converted frames.
+///////////////
+static void prepareStrategyFrames(
+    const cv::Mat&    _image,
+    bool              _isGray,
+    bool              _isPyramid,
+    bool              _isGrayPyramid,
+    matPool_t&        _matPool,
+    strategyFrames_t& _frames
+) {
+    const cv::Size l_coarseSize( ( ( _image.cols + 1 ) / 2 ), ( ( _image.rows + 1 ) / 2 ) );
+
+    _frames.image = _image;
+
+    if ( _isGray || _isGrayPyramid ) {
+        traceScope_t l_trace( "cvtColor" );
+
+        _frames.gray = _matPool.acquire( _image.rows, _image.cols, CV_8UC1 );
+
+        cv::cvtColor( _image, *_frames.gray, cv::COLOR_BGR2GRAY );
+    }
+
+    if ( _isPyramid ) {
+        traceScope_t l_trace( "pyrDown" );
+
+        _frames.coarse = _matPool.acquire( l_coarseSize.height, l_coarseSize.width, _image.type() );
+
+        cv::pyrDown( _image, *_frames.coarse, l_coarseSize );
+    }
+
+    if ( _isGrayPyramid ) {
+        traceScope_t l_trace( "pyrDown" );
+
+        _frames.coarseGray = _matPool.acquire( l_coarseSize.height, l_coarseSize.width, CV_8UC1 );
+
+        cv::pyrDown( *_frames.gray, *_frames.coarseGray, l_coarseSize );
+    }
+}
+
+///////////////
+/// @brief Best location of response map.
+/// @details For SQDIFF and SQDIFF_NORMED, the best matches are lower values. For all the other methods, the higher the better.
+/// Result is not normalized, extremum location is the same and the raw value is kept as score.
+/// @param[in] _response Response map.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+/// @param[out] _location Best location.
+/// @param[out] _value Response at best location.
+///////////////
+static void locateBest(
+    const cv::Mat& _response,
+    uint32_t       _matchMethod,
+    cv::Point&     _location,
+    double&        _value
+) {
+    //! <b>[best_match]</b>
+    /// Localizing the best match with minMaxLoc.
+    /// @code{.cpp}
+    double    l_minimumValue;
+    double    l_maximumValue;
+    cv::Point l_minimumLocation;
+    cv::Point l_maximumLocation;
+
+    cv::minMaxLoc(
+        _response,
+        &l_minimumValue,
+        &l_maximumValue,
+        &l_minimumLocation,
+        &l_maximumLocation,
+        cv::Mat()
+    );
+    /// @endcode
+    //! <b>[best_match]</b>
+
+    //! <b>[match_loc]</b>
+    /// @code{.cpp}
+    if ( ( _matchMethod == cv::TM_SQDIFF ) || ( _matchMethod == cv::TM_SQDIFF_NORMED ) ) {
+        _location = l_minimumLocation;
+        _value    = l_minimumValue;
+
+    } else {
+        _location = l_maximumLocation;
+        _value    = l_maximumValue;
+    }
+    /// @endcode
+    //! <b>[match_loc]</b>
+}
+
+///////////////
+/// @brief Locate template with gray or pyramid strategy.
+/// @details Pyramid strategy searches half resolution frame and refines location
+/// within \c PYRAMID_MARGIN pixels of it on full resolution. Template too small for pyramid is searched directly.
+/// Throws ios_base::failure at error.
+/// @param[in] _strategy Strategy other than direct.
+/// @param[in] _frames Frames converted for strategy, only read.
+/// @param[in] _templateImage Template image path.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+/// @param[in] _matPool Pool to borrow buffers from.
+/// @param[out] _location Top left corner of best location.
+/// @param[out] _value Score at best location.
+///////////////
+static void locateWithStrategy(
+    matchStrategy_t         _strategy,
+    strategyFrames_t&       _frames,
+    const std::string&      _templateImage,
+    uint32_t                _matchMethod,
+    matPool_t&              _matPool,
+    cv::Point&              _location,
+    double&                 _value
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const bool               l_isGray          = isGrayStrategy( _strategy );
+    const templateVariant_t& l_templateVariant = getTemplateVariant( _templateImage, l_isGray );
+    const cv::Mat&           l_image           = ( l_isGray ? *_frames.gray : _frames.image );
+    cv::Rect                 l_searchArea( 0, 0, l_image.cols, l_image.rows );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[coarse]</b>
+    /// Search area shrinks to neighbourhood of coarse location.
+    /// @code{.cpp}
+    if ( isPyramidStrategy( _strategy ) && !l_templateVariant.coarse.empty() ) {
+        const cv::Mat&     l_coarseImage = ( l_isGray ? *_frames.coarseGray : *_frames.coarse );
+        matPool_t::lease_t l_coarseResponse = _matPool.acquire(
+            ( l_coarseImage.rows - l_templateVariant.coarse.rows + 1 ),
+            ( l_coarseImage.cols - l_templateVariant.coarse.cols + 1 ),
+            CV_32FC1
+        );
+        cv::Point          l_coarseLocation;
+        double             l_coarseValue;
+
+        cv::matchTemplate( l_coarseImage, l_templateVariant.coarse, *l_coarseResponse, _matchMethod );
+
+        locateBest( *l_coarseResponse, _matchMethod, l_coarseLocation, l_coarseValue );
+
+        l_searchArea = (
+            cv::Rect(
+                ( ( l_coarseLocation.x * 2 ) - PYRAMID_MARGIN ),
+                ( ( l_coarseLocation.y * 2 ) - PYRAMID_MARGIN ),
+                ( l_templateVariant.image.cols + ( PYRAMID_MARGIN * 2 ) ),
+                ( l_templateVariant.image.rows + ( PYRAMID_MARGIN * 2 ) )
+            ) & l_searchArea
+        );
+    }
+    /// @endcode
+    //! <b>[coarse]</b>
+
+    //! <b>[fine]</b>
+    /// @code{.cpp}
+    const cv::Mat      l_searchImage = l_image( l_searchArea );
+    matPool_t::lease_t l_response    = _matPool.acquire(
+        ( l_searchImage.rows - l_templateVariant.image.rows + 1 ),
+        ( l_searchImage.cols - l_templateVariant.image.cols + 1 ),
+        CV_32FC1
+    );
+
+    cv::matchTemplate( l_searchImage, l_templateVariant.image, *l_response, _matchMethod );
+
+    locateBest( *l_response, _matchMethod, _location, _value );
+
+    _location += l_searchArea.tl();
+    /// @endcode
+    //! <b>[fine]</b>
+}
+
+///////////////
+/// @brief Correlate many templates of the same size and type with image in one pass.
+/// @details Response row is split to tiles of \c BATCH_TILE_BYTES patches. Patches of a tile are unrolled
+/// into matrix rows and multiplied by matrix of all templates, so every tile of image is read once
+/// for all templates. Normalization follows cv::matchTemplate, windows sums come from integral images.
+/// @param[in] _image Image, 8-bit or 32-bit floating-point.
+/// @param[in] _templateImages Templates of the same size and type as each other and image.
+/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes .
+/// @param[in] _matPool Pool to borrow buffers from.
+/// @param[in] _threadPool Pool to compute response rows on.
+/// @param[out] _responses Response map of every template.
+///////////////
+static void matchTemplateBatch(
+    const cv::Mat&                         _image,
+    const std::vector< const cv::Mat* >&   _templateImages,
+    uint32_t                               _matchMethod,
+    matPool_t&                             _matPool,
+    threadPool_t&                          _threadPool,
+    std::vector< matPool_t::lease_t >&     _responses
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    traceScope_t l_trace( "matchTemplateBatch" );
+
+    const int      l_channels       = _image.channels();
+    const cv::Size l_templateSize   = _templateImages.front()->size();
+    const int      l_patchSize      = ( l_templateSize.area() * l_channels );
+    const int      l_templatesCount = static_cast< int >( _templateImages.size() );
+    const cv::Size l_responseSize(
+        ( _image.cols - l_templateSize.width + 1 ),
+        ( _image.rows - l_templateSize.height + 1 )
+    );
+    const int      l_tileWidth      = std::max( 1, std::min( l_responseSize.width, static_cast< int >( BATCH_TILE_BYTES / ( l_patchSize * sizeof( float ) ) ) ) );
+    const bool     l_isCoefficient  = ( ( _matchMethod == cv::TM_CCOEFF ) || ( _matchMethod == cv::TM_CCOEFF_NORMED ) );
+    const bool     l_isNormed       = ( ( _matchMethod == cv::TM_SQDIFF_NORMED ) || ( _matchMethod == cv::TM_CCORR_NORMED ) || ( _matchMethod == cv::TM_CCOEFF_NORMED ) );
+    const bool     l_isSquared      = ( ( _matchMethod == cv::TM_SQDIFF ) || ( _matchMethod == cv::TM_SQDIFF_NORMED ) );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[frame]</b>
+    /// Image is converted once, integral images are needed only for window sums of normalized and squared methods.
+    /// @code{.cpp}
+    matPool_t::lease_t l_frame      = _matPool.acquire( _image.rows, _image.cols, CV_32FC( l_channels ) );
+    matPool_t::lease_t l_sum;
+    matPool_t::lease_t l_squaredSum;
+
+    _image.convertTo( *l_frame, CV_32F );
+
+    if ( l_isNormed || l_isSquared ) {
+        l_sum        = _matPool.acquire( ( _image.rows + 1 ), ( _image.cols + 1 ), CV_64FC( l_channels ) );
+        l_squaredSum = _matPool.acquire( ( _image.rows + 1 ), ( _image.cols + 1 ), CV_64FC( l_channels ) );
+
+        cv::integral( *l_frame, *l_sum, *l_squaredSum, CV_64F, CV_64F );
+    }
+    /// @endcode
+    //! <b>[frame]</b>
+
+    //! <b>[templates]</b>
+    /// Template is a row of templates matrix. Coefficient methods correlate with template without its mean,
+    /// which equals correlation of both centered.
+    /// @code{.cpp}
+    matPool_t::lease_t    l_templates = _matPool.acquire( l_templatesCount, l_patchSize, CV_32FC1 );
+    std::vector< double > l_templateSquaredSums( l_templatesCount );
+
+    for ( int _templateIndex = 0; _templateIndex < l_templatesCount; _templateIndex++ ) {
+        cv::Mat l_templateRow = l_templates->row( _templateIndex ).reshape( l_channels, l_templateSize.height );
+
+        _templateImages[ _templateIndex ]->convertTo( l_templateRow, CV_32F );
+
+        if ( l_isCoefficient ) {
+            l_templateRow -= cv::mean( l_templateRow );
+        }
+
+        l_templateSquaredSums[ _templateIndex ] = l_templateRow.dot( l_templateRow );
+
+        _responses[ _templateIndex ] = _matPool.acquire( l_responseSize.height, l_responseSize.width, CV_32FC1 );
+    }
+    /// @endcode
+    //! <b>[templates]</b>
+
+    auto correlateRow = [ & ]( size_t _row ) {
+        //! <b>[buffers]</b>
+        /// @code{.cpp}
+        const int          l_row      = static_cast< int >( _row );
+        const size_t       l_rowBytes = ( l_templateSize.width * l_channels * sizeof( float ) );
+        matPool_t::lease_t l_patches  = _matPool.acquire( l_tileWidth, l_patchSize, CV_32FC1 );
+        matPool_t::lease_t l_products = _matPool.acquire( l_tileWidth, l_templatesCount, CV_32FC1 );
+
+        auto windowSum = [ & ]( const cv::Mat& _integral, int _left, int _channel ) {
+            const double* l_top    = _integral.ptr< double >( l_row );
+            const double* l_bottom = _integral.ptr< double >( l_row + l_templateSize.height );
+            const int     l_first  = ( ( _left * l_channels ) + _channel );
+            const int     l_last   = ( ( ( _left + l_templateSize.width ) * l_channels ) + _channel );
+
+            return ( l_bottom[ l_last ] - l_bottom[ l_first ] - l_top[ l_last ] + l_top[ l_first ] );
+        };
+        /// @endcode
+        //! <b>[buffers]</b>
+
+        for ( int _tileColumn = 0; _tileColumn < l_responseSize.width; _tileColumn += l_tileWidth ) {
+            const int l_width = std::min( l_tileWidth, ( l_responseSize.width - _tileColumn ) );
+
+            //! <b>[unroll]</b>
+            /// Patch of every response column of tile becomes matrix row.
+            /// @code{.cpp}
+            for ( int _column = 0; _column < l_width; _column++ ) {
+                float* l_patch = l_patches->ptr< float >( _column );
+
+                for ( int _templateRow = 0; _templateRow < l_templateSize.height; _templateRow++ ) {
+                    std::memcpy(
+                        ( l_patch + ( _templateRow * l_templateSize.width * l_channels ) ),
+                        ( l_frame->ptr< float >( l_row + _templateRow ) + ( ( _tileColumn + _column ) * l_channels ) ),
+                        l_rowBytes
+                    );
+                }
+            }
+
+            cv::Mat l_tileProducts = l_products->rowRange( 0, l_width );
+
+            cv::gemm(
+                l_patches->rowRange( 0, l_width ),
+                *l_templates,
+                1,
+                cv::noArray(),
+                0,
+                l_tileProducts,
+                cv::GEMM_2_T
+            );
+            /// @endcode
+            //! <b>[unroll]</b>
+
+            //! <b>[normalize]</b>
+            /// The same formula as cv::matchTemplate, window sums are taken over all channels.
+            /// @code{.cpp}
+            for ( int _column = 0; _column < l_width; _column++ ) {
+                const int l_left         = ( _tileColumn + _column );
+                double    l_windowSquare = 0;
+                double    l_windowMean   = 0;
+
+                if ( l_isNormed || l_isSquared ) {
+                    for ( int _channel = 0; _channel < l_channels; _channel++ ) {
+                        const double l_sumValue = windowSum( *l_sum, l_left, _channel );
+
+                        l_windowSquare += windowSum( *l_squaredSum, l_left, _channel );
+
+                        if ( l_isCoefficient ) {
+                            l_windowMean += ( ( l_sumValue * l_sumValue ) / l_templateSize.area() );
+                        }
+                    }
+                }
+
+                for ( int _templateIndex = 0; _templateIndex < l_templatesCount; _templateIndex++ ) {
+                    double l_value = l_products->at< float >( _column, _templateIndex );
+
+                    if ( l_isSquared ) {
+                        l_value = ( l_windowSquare - ( 2 * l_value ) + l_templateSquaredSums[ _templateIndex ] );
+                    }
+
+                    if ( l_isNormed ) {
+                        const double l_norm = (
+                            std::sqrt( std::max( ( l_windowSquare - l_windowMean ), 0.0 ) ) *
+                            std::sqrt( l_templateSquaredSums[ _templateIndex ] )
+                        );
+
+                        if ( std::fabs( l_value ) < l_norm ) {
+                            l_value /= l_norm;
+
+                        } else if ( std::fabs( l_value ) < ( l_norm * 1.125 ) ) {
+                            l_value = ( ( l_value > 0 ) ? 1 : -1 );
+
+                        } else {
+                            l_value = ( ( _matchMethod != cv::TM_SQDIFF_NORMED ) ? 0 : 1 );
+                        }
+                    }
+
+                    ( *_responses[ _templateIndex ] ).at< float >( l_row, l_left ) = static_cast< float >( l_value );
+                }
+            }
+            /// @endcode
+            //! <b>[normalize]</b>
+        }
+    };
+
+    //! <b>[correlate]</b>
+    /// Every response row is independent, rows go to threads.
+    /// @code{.cpp}
+    _threadPool.parallelFor( static_cast< size_t >( l_responseSize.height ), correlateRow );
+    /// @endcode
+    //! <b>[correlate]</b>
+}
+
+void incrementalMatcher_t::matchBatch(
+    const std::vector< size_t >&         _templateIds,
+    const cv::Mat&                       _image,
+    const std::vector< const cv::Mat* >& _templateImages,
+    uint32_t                             _matchMethod,
+    matPool_t&                           _matPool,
+    threadPool_t&                        _threadPool,
+    std::vector< cv::Mat >&              _responses
+) {
+    //! <b>[declare]</b>
+    /// Changes of group are united, template without valid response makes whole response recomputed.
+    /// @code{.cpp}
+    const cv::Size                    l_templateSize = _templateImages.front()->size();
+    const cv::Size                    l_responseSize(
+        ( _image.cols - l_templateSize.width + 1 ),
+        ( _image.rows - l_templateSize.height + 1 )
+    );
+    std::vector< uint8_t >            l_changedTiles( m_tileHashes.size(), 0 );
+    std::vector< matPool_t::lease_t > l_cellsResponses( _templateIds.size() );
+    bool                              l_isFull = false;
+
+    for ( const size_t _templateId : _templateIds ) {
+        const response_t& l_response = m_responses[ _templateId ];
+
+        if ( !l_response.isValid || ( l_response.image.size() != l_responseSize ) ) {
+            l_isFull = true;
+
+            break;
+        }
+
+        for ( size_t _tileIndex = 0; _tileIndex < l_changedTiles.size(); _tileIndex++ ) {
+            l_changedTiles[ _tileIndex ] |= l_response.changedTiles[ _tileIndex ];
+        }
+    }
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[update]</b>
+    /// Every value depends only on image under template, so partial result equals full one.
+    /// Writing into response ROI of the same size and type doesn't reallocate it.
+    /// @code{.cpp}
+    auto update = [ & ]( const cv::Rect& _cells ) {
+        matchTemplateBatch(
+            _image(
+                cv::Rect(
+                    _cells.x,
+                    _cells.y,
+                    ( _cells.width + l_templateSize.width - 1 ),
+                    ( _cells.height + l_templateSize.height - 1 )
+                )
+            ),
+            _templateImages,
+            _matchMethod,
+            _matPool,
+            _threadPool,
+            l_cellsResponses
+        );
+
+        for ( size_t _index = 0; _index < _templateIds.size(); _index++ ) {
+            l_cellsResponses[ _index ]->copyTo( m_responses[ _templateIds[ _index ] ].image( _cells ) );
+        }
+    };
+
+    if ( l_isFull ) {
+        for ( const size_t _templateId : _templateIds ) {
+            m_responses[ _templateId ].image.create( l_responseSize, CV_32FC1 );
+        }
+
+        update( cv::Rect( cv::Point( 0, 0 ), l_responseSize ) );
+
+    } else {
+        forEachChangedCells( l_changedTiles, l_responseSize, l_templateSize, std::ref( update ) );
+    }
+    /// @endcode
+    //! <b>[update]</b>
+
+    //! <b>[responses]</b>
+    /// @code{.cpp}
+    for ( size_t _index = 0; _index < _templateIds.size(); _index++ ) {
+        response_t& l_response = m_responses[ _templateIds[ _index ] ];
+
+        l_response.changedTiles.assign( m_tileHashes.size(), 0 );
+        l_response.isValid = true;
+
+        _responses[ _index ] = l_response.image;
+    }
+    /// @endcode
+    //! <b>[responses]</b>
+}
+
+///////////////
+/// @brief Correlate groups of small templates of the same size with \c matchTemplateBatch .
+/// @details Templates with other strategy than direct, larger than \c BATCH_MAXIMUM_TEMPLATE_AREA
+/// or in groups smaller than \c BATCH_MINIMUM_TEMPLATES are left to cv::matchTemplate .
+/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes .
+/// @param[in] _image Image.
+/// @param[in] _templateImages Templates, index is template ID.
+/// @param[in] _selection Templates to match, all if \c NULL .
+/// @param[in] _strategies Strategies indexed by template ID, all direct if \c NULL .
+/// @param[in] _downscale Times templates are larger than image.
+/// @param[in] _matPool Pool to borrow buffers from.
+/// @param[in] _threadPool Pool to compute responses on.
+/// @param[in,out] _incrementalMatcher Response maps kept between frames, groups update only changed cells of them.
+/// Not kept if \c NULL .
+/// @param[out] _leases Pooled response maps of groups, they must outlive \c _responses . Unused if maps are kept.
+/// @param[out] _responses Response maps indexed by template ID, empty for templates not batched.
+/// @param[out] _costs Even share of group correlation time, indexed by template ID. Zero for templates not batched.
+///////////////
+static void batchTemplates(
+    uint32_t                                 _matchMethod,
+    const cv::Mat&                           _image,
+    const std::vector< std::string >&        _templateImages,
+    const templateSelection_t*               _selection,
+    const std::vector< matchStrategy_t >*    _strategies,
+    uint32_t                                 _downscale,
+    matPool_t&                               _matPool,
+    threadPool_t&                            _threadPool,
+    incrementalMatcher_t*                    _incrementalMatcher,
+    std::vector< matPool_t::lease_t >&       _leases,
+    std::vector< cv::Mat >&                  _responses,
+    std::vector< std::chrono::nanoseconds >& _costs
+) {
+    //! <b>[group]</b>
+    /// Templates are grouped by size and type.
+    /// @code{.cpp}
+    std::map< std::tuple< int, int, int >, std::vector< size_t > > l_groups;
+
+    auto groupTemplate = [ & ]( size_t _templateId ) {
+        if ( _strategies && ( _templateId < _strategies->size() ) && ( ( *_strategies )[ _templateId ] != MATCH_STRATEGY_DIRECT ) ) {
+            return;
+        }
+
+        const cv::Mat& l_templateImage = (
+            ( _downscale > 1 )
+            ? getScaledTemplateImage( _templateImages[ _templateId ], _downscale )
+            : getTemplateImage( _templateImages[ _templateId ] )
+        );
+
+        if (
+            ( l_templateImage.type() == _image.type() ) &&
+            ( l_templateImage.size().area() <= BATCH_MAXIMUM_TEMPLATE_AREA ) &&
+            ( l_templateImage.cols <= _image.cols ) &&
+            ( l_templateImage.rows <= _image.rows )
+        ) {
+            l_groups[ { l_templateImage.cols, l_templateImage.rows, l_templateImage.type() } ].push_back( _templateId );
+        }
+    };
+
+    if ( _selection ) {
+        for ( const size_t _templateId : _selection->templateIds ) {
+            groupTemplate( _templateId );
+        }
+
+    } else {
+        for ( size_t _templateId = 0; _templateId < _templateImages.size(); _templateId++ ) {
+            groupTemplate( _templateId );
+        }
+    }
+    /// @endcode
+    //! <b>[group]</b>
+
+    //! <b>[correlate]</b>
+    /// @code{.cpp}
+    for ( const std::pair< const std::tuple< int, int, int >, std::vector< size_t > >& _group : l_groups ) {
+        if ( _group.second.size() < BATCH_MINIMUM_TEMPLATES ) {
+            continue;
+        }
+
+        std::vector< const cv::Mat* >     l_groupTemplates;
+        std::vector< matPool_t::lease_t > l_groupLeases( _group.second.size() );
+        std::vector< cv::Mat >            l_groupResponses( _group.second.size() );
+
+        for ( const size_t _templateId : _group.second ) {
+            l_groupTemplates.push_back(
+                ( _downscale > 1 )
+                ? &getScaledTemplateImage( _templateImages[ _templateId ], _downscale )
+                : &getTemplateImage( _templateImages[ _templateId ] )
+            );
+        }
+
+        const std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+
+        if ( _incrementalMatcher ) {
+            _incrementalMatcher->matchBatch( _group.second, _image, l_groupTemplates, _matchMethod, _matPool, _threadPool, l_groupResponses );
+
+        } else {
+            matchTemplateBatch( _image, l_groupTemplates, _matchMethod, _matPool, _threadPool, l_groupLeases );
+
+            for ( size_t _index = 0; _index < _group.second.size(); _index++ ) {
+                l_groupResponses[ _index ] = *l_groupLeases[ _index ];
+            }
+        }
+
+        const std::chrono::nanoseconds l_cost = (
+            std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - l_start ) /
+            _group.second.size()
+        );
+
+        for ( size_t _index = 0; _index < _group.second.size(); _index++ ) {
+            _responses[ _group.second[ _index ] ] = l_groupResponses[ _index ];
+            _costs[ _group.second[ _index ] ]     = l_cost;
+
+            if ( !_incrementalMatcher ) {
+                _leases.push_back( std::move( l_groupLeases[ _index ] ) );
+            }
+        }
+    }
+    /// @endcode
+    //! <b>[correlate]</b>
+}
+
+///////////////
+/// @brief Compares a template against overlapped image regions.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes or \c FEATURE_MATCH_METHOD .
+/// @param[in] _image 2D image array where the search is running. It must be 8-bit or 32-bit floating-point.
+/// @param[in] _templateImages Searched templates, index is template ID. It must be not greater than the source image and have the same data type.
+/// @param[in] _results Table to publish results to, sized to templates count.
+/// @param[in] _matPool Pool to borrow buffers from.
+/// @param[in] _threadPool Pool to match templates on.
+/// @param[out] _outlines Outlines of found images, not collected if \c NULL .
+/// @param[in,out] _selection Templates to match, all if \c NULL . Not selected ones keep previous result.
+/// @param[in,out] _incrementalMatcher Response maps kept between frames, after \c detect on this image. Not kept if \c NULL .
+/// Used only by templates matched directly.
+/// @param[in] _strategies Strategies indexed by template ID, all templates are matched directly if \c NULL .
+/// @param[in] _downscale Times source is larger than image. Templates are downscaled as well and matched directly,
+/// published centers are in source coordinates, outlines in image coordinates.
+/// @param[in] _isCancelled Set when frame is superseded, templates not started yet are skipped. Never set if \c NULL .
+///////////////
+static void matchTemplates(
+    uint32_t   _matchMethod,
+    cv::Mat    _image,
+    const std::vector< std::string >& _templateImages,
+    matchResults_t& _results,
+    matPool_t& _matPool,
+    threadPool_t& _threadPool,
+    outlines_t* _outlines = NULL,
+    templateSelection_t* _selection = NULL,
+    incrementalMatcher_t* _incrementalMatcher = NULL,
+    const std::vector< matchStrategy_t >* _strategies = NULL,
+    uint32_t _downscale = 1,
+    const std::atomic< bool >* _isCancelled = NULL
+) {
+    //! <b>[check_image]</b>
+    /// @code{.cpp}
+    if ( _image.empty() ) {
+        throw std::ios_base::failure( "Can't read image cv::Mat" );
+    }
+    /// @endcode
+    //! <b>[check_image]</b>
+
+    //! <b>[check_cancelled]</b>
+    /// Frame superseded before matching started is not touched at all.
+    /// @code{.cpp}
+    auto isCancelled = [ _isCancelled ]{
+        return ( _isCancelled && _isCancelled->load( std::memory_order_relaxed ) );
+    };
+
+    if ( isCancelled() ) {
+        return;
+    }
+    /// @endcode
+    //! <b>[check_cancelled]</b>
+
+    //! <b>[frame]</b>
+    /// Every result of this call is published with the same frame sequence number.
+    /// @code{.cpp}
+    const uint64_t l_frame = _results.nextFrame();
+    /// @endcode
+    //! <b>[frame]</b>
+
+    //! <b>[match_features]</b>
+    /// Feature-based matching shares one source image detection between all templates.
+    /// @code{.cpp}
+    if ( _matchMethod == FEATURE_MATCH_METHOD ) {
+        matchTemplatesFeatures(
+            _image,
+            _templateImages,
+            _results,
+            l_frame,
+            _matPool,
+            _threadPool,
+            _outlines,
+            _selection,
+            _downscale
+        );
+
+        return;
+    }
+    /// @endcode
+    //! <b>[match_features]</b>
+
+    //! <b>[strategy_frames]</b>
+    /// Frame conversions are made once for all templates whose strategy needs them.
+    /// @code{.cpp}
+    strategyFrames_t l_strategyFrames;
+
+    if ( _strategies && ( _downscale == 1 ) ) {
+        bool l_isGray        = false;
+        bool l_isPyramid     = false;
+        bool l_isGrayPyramid = false;
+
+        for ( const matchStrategy_t _strategy : *_strategies ) {
+            l_isGray        |= ( _strategy == MATCH_STRATEGY_GRAY );
+            l_isPyramid     |= ( _strategy == MATCH_STRATEGY_PYRAMID );
+            l_isGrayPyramid |= ( _strategy == MATCH_STRATEGY_GRAY_PYRAMID );
+        }
+
+        prepareStrategyFrames( _image, l_isGray, l_isPyramid, l_isGrayPyramid, _matPool, l_strategyFrames );
+    }
+    /// @endcode
+    //! <b>[strategy_frames]</b>
+
+    //! <b>[batch]</b>
+    /// Small templates of the same size are correlated together, so image is read once per group.
+    /// Response maps kept between frames are updated together over changed cells of group.
+    /// Group correlation time is shared by its templates, so their latencies and costs include it.
+    /// @code{.cpp}
+    std::vector< matPool_t::lease_t >       l_batchLeases;
+    std::vector< cv::Mat >                  l_batchResponses( _templateImages.size() );
+    std::vector< std::chrono::nanoseconds > l_batchCosts( _templateImages.size(), std::chrono::nanoseconds( 0 ) );
+
+    if ( !isCancelled() ) {
+        batchTemplates(
+            _matchMethod,
+            _image,
+            _templateImages,
+            _selection,
+            ( ( _downscale == 1 ) ? _strategies : NULL ),
+            _downscale,
+            _matPool,
+            _threadPool,
+            _incrementalMatcher,
+            l_batchLeases,
+            l_batchResponses,
+            l_batchCosts
+        );
+    }
+    /// @endcode
+    //! <b>[batch]</b>
+
+    std::mutex l_outlinesMutex;
+
+    auto matchTemplate = [ & ]( size_t _templateId ) {
+        //! <b>[check_cancelled]</b>
+        /// Remaining templates of superseded frame are dropped, their results are not published.
+        /// @code{.cpp}
+        if ( isCancelled() ) {
+            return;
+        }
+        /// @endcode
+        //! <b>[check_cancelled]</b>
+
+        //! <b>[load_template]</b>
+        /// Get cached template image.
+        /// @code{.cpp}
+        const cv::Mat&        l_sourceTemplate = getTemplateImage( _templateImages[ _templateId ] );
+        const cv::Mat&        l_templateImage  = (
+            ( _downscale > 1 )
+            ? getScaledTemplateImage( _templateImages[ _templateId ], _downscale )
+            : l_sourceTemplate
+        );
+        const matchStrategy_t l_strategy       = (
+            ( _strategies && ( _downscale == 1 ) && ( _templateId < _strategies->size() ) )
+            ? ( *_strategies )[ _templateId ]
+            : MATCH_STRATEGY_DIRECT
+        );
+        cv::Point             l_matchLocation;
+        double                l_matchValue;
+        /// @endcode
+        //! <b>[load_template]</b>
+
+        if ( l_strategy != MATCH_STRATEGY_DIRECT ) {
+            //! <b>[match_strategy]</b>
+            /// Tuned templates are located on converted frames.
+            /// @code{.cpp}
+            traceScope_t l_matchTrace( matchStrategyName( l_strategy ), _templateId );
+
+            locateWithStrategy(
+                l_strategy,
+                l_strategyFrames,
+                _templateImages[ _templateId ],
+                _matchMethod,
+                _matPool,
+                l_matchLocation,
+                l_matchValue
+            );
+            /// @endcode
+            //! <b>[match_strategy]</b>
+
+        } else {
+            //! <b>[create_result_array]</b>
+            /// Borrow the result 2D image array, unless response is kept between frames or batched.
+            /// @code{.cpp}
+            matPool_t::lease_t l_resultLease;
+            cv::Mat            l_resultImage;
+
+            if ( !_incrementalMatcher && l_batchResponses[ _templateId ].empty() ) {
+                l_resultLease = _matPool.acquire(
+                    ( _image.rows - l_templateImage.rows + 1 ),
+                    ( _image.cols - l_templateImage.cols + 1 ),
+                    CV_32FC1
+                );
+            }
+            /// @endcode
+            //! <b>[create_result_array]</b>
+
+            //! <b>[match_template]</b>
+            /// Do Matching.
+            /// @code{.cpp}
+            traceScope_t l_matchTrace( "matchTemplate", _templateId );
+
+            if ( !l_batchResponses[ _templateId ].empty() ) {
+                l_resultImage = l_batchResponses[ _templateId ];
+
+            } else if ( _incrementalMatcher ) {
+                l_resultImage = _incrementalMatcher->match(
+                    _templateId,
+                    _image,
+                    l_templateImage,
+                    _matchMethod
+                );
+
+            } else {
+                cv::matchTemplate(
+                    _image,          // Source
+                    l_templateImage, // Trying to find this
+                    *l_resultLease,
+                    _matchMethod
+                );
+
+                l_resultImage = *l_resultLease;
+            }
+
+            l_matchTrace.end();
+            /// @endcode
+            //! <b>[match_template]</b>
+
+            //! <b>[best_match]</b>
+            /// Localizing the best match.
+            /// @code{.cpp}
+            traceScope_t l_locateTrace( "minMaxLoc", _templateId );
+
+            locateBest( l_resultImage, _matchMethod, l_matchLocation, l_matchValue );
+
+            l_locateTrace.end();
+            /// @endcode
+            //! <b>[best_match]</b>
+        }
+
+        //! <b>[publish]</b>
+        /// Publish template center, mapped back to source resolution.
+        /// @code{.cpp}
+        _results.publish(
+            _templateId,
+            {
+                static_cast< uint32_t >( ( l_matchLocation.x * _downscale ) + ( l_sourceTemplate.cols / 2 ) ),
+                static_cast< uint32_t >( ( l_matchLocation.y * _downscale ) + ( l_sourceTemplate.rows / 2 ) ),
+                l_matchValue,
+                l_frame,
+                true
+            }
+        );
+        /// @endcode
+        //! <b>[publish]</b>
+
+        //! <b>[outline]</b>
+        /// Collect rectangle only if result is shown.
+        /// @code{.cpp}
+        if ( _outlines ) {
+            std::lock_guard< std::mutex > l_lock( l_outlinesMutex );
+
+            _outlines->push_back( {
+                l_matchLocation,
+                cv::Point( ( l_matchLocation.x + l_templateImage.cols ), l_matchLocation.y ),
+                cv::Point( ( l_matchLocation.x + l_templateImage.cols ), ( l_matchLocation.y + l_templateImage.rows ) ),
+                cv::Point( l_matchLocation.x, ( l_matchLocation.y + l_templateImage.rows ) )
+            } );
+        }
+        /// @endcode
+        //! <b>[outline]</b>
+    };
+
+    //! <b>[match_templates]</b>
+    /// Matching templates on source image and publishing template's coordinates.
+    /// @code{.cpp}
+    forEachTemplate(
+        _threadPool,
+        _templateImages.size(),
+        _selection,
+        std::ref( matchTemplate ),
+        &l_batchCosts
+    );
+    /// @endcode
+    //! <b>[match_templates]</b>
+}
+
+///////////////
+/// @brief Time every strategy of template on frame and pick fastest one that finds template where direct matching does.
+/// @details Every strategy runs \c TUNE_ITERATIONS times and its fastest run counts,
+/// shared frame conversions are added to it. Direct matching is always accepted.
+/// Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+/// @param[in] _frames Frame converted for every strategy.
+/// @param[in] _conversionCosts Share of frame conversions per template, indexed by strategy.
+/// @param[in] _templateImage Template image path.
+/// @param[in] _matPool Pool to borrow buffers from.
+/// @return Tuning without hash.
+///////////////
+static templateTuning_t tuneTemplate(
+    uint32_t                                                           _matchMethod,
+    strategyFrames_t&                                                  _frames,
+    const std::array< std::chrono::nanoseconds, MATCH_STRATEGY_COUNT >& _conversionCosts,
+    const std::string&                                                 _templateImage,
+    matPool_t&                                                         _matPool
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    templateTuning_t l_tuning;
+    cv::Point        l_directLocation;
+
+    auto locate = [ & ]( matchStrategy_t _strategy, cv::Point& _location ) {
+        double l_value;
+
+        if ( _strategy != MATCH_STRATEGY_DIRECT ) {
+            locateWithStrategy( _strategy, _frames, _templateImage, _matchMethod, _matPool, _location, l_value );
+
+            return;
+        }
+
+        const cv::Mat&     l_templateImage = getTemplateImage( _templateImage );
+        matPool_t::lease_t l_response      = _matPool.acquire(
+            ( _frames.image.rows - l_templateImage.rows + 1 ),
+            ( _frames.image.cols - l_templateImage.cols + 1 ),
+            CV_32FC1
+        );
+
+        cv::matchTemplate( _frames.image, l_templateImage, *l_response, _matchMethod );
+
+        locateBest( *l_response, _matchMethod, _location, l_value );
+    };
+    /// @endcode
+    //! <b>[declare]</b>
+
+    for ( uint32_t _strategy = 0; _strategy < MATCH_STRATEGY_COUNT; _strategy++ ) {
+        //! <b>[skip]</b>
+        /// Template too small for pyramid would only repeat full resolution search.
+        /// @code{.cpp}
+        if (
+            isPyramidStrategy( static_cast< matchStrategy_t >( _strategy ) ) &&
+            getTemplateVariant( _templateImage, isGrayStrategy( static_cast< matchStrategy_t >( _strategy ) ) ).coarse.empty()
+        ) {
+            continue;
+        }
+        /// @endcode
+        //! <b>[skip]</b>
+
+        //! <b>[time]</b>
+        /// @code{.cpp}
+        std::chrono::nanoseconds l_cost = std::chrono::nanoseconds::max();
+        cv::Point                l_location;
+
+        for ( uint32_t _iteration = 0; _iteration < TUNE_ITERATIONS; _iteration++ ) {
+            const std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+
+            locate( static_cast< matchStrategy_t >( _strategy ), l_location );
+
+            l_cost = std::min< std::chrono::nanoseconds >( l_cost, ( std::chrono::steady_clock::now() - l_start ) );
+        }
+
+        l_cost += _conversionCosts[ _strategy ];
+        /// @endcode
+        //! <b>[time]</b>
+
+        //! <b>[verify]</b>
+        /// Strategy that finds template elsewhere is not taken however fast it is.
+        /// @code{.cpp}
+        if ( _strategy == MATCH_STRATEGY_DIRECT ) {
+            l_directLocation = l_location;
+            l_tuning.cost    = l_cost;
+
+            continue;
+        }
+
+        if (
+            ( std::abs( l_location.x - l_directLocation.x ) > TUNE_LOCATION_TOLERANCE ) ||
+            ( std::abs( l_location.y - l_directLocation.y ) > TUNE_LOCATION_TOLERANCE )
+        ) {
+            continue;
+        }
+
+        if ( l_cost < l_tuning.cost ) {
+            l_tuning.strategy = static_cast< matchStrategy_t >( _strategy );
+            l_tuning.cost     = l_cost;
+        }
+        /// @endcode
+        //! <b>[verify]</b>
+    }
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_tuning );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Shows latest frame with outlines of found images from own thread.
+/// @details Matching thread only hands over frame and returns, frames not yet shown are dropped.
+/// All HighGUI calls are made from display thread.
+///////////////
+class resultDisplay_t {
+public:
+    resultDisplay_t( void ) = default;
+    ~resultDisplay_t( void );
+
+    resultDisplay_t( const resultDisplay_t& ) = delete;
+    resultDisplay_t& operator=( const resultDisplay_t& ) = delete;
+
+    void show(
+        matPool_t::lease_t&& _image,
+        outlines_t&&         _outlines,
+        bool                 _isRgb
+    );
+
+private:
+    void run( void );
+
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    std::thread             m_thread;
+    matPool_t::lease_t      m_image;
+    outlines_t              m_outlines;
+    bool                    m_isRgb      = false;
+    bool                    m_isPending  = false;
+    bool                    m_isStopping = false;
+};
+
+///////////////
+/// @brief Stop display thread.
+///////////////
+resultDisplay_t::~resultDisplay_t( void ) {
+    //! <b>[stop]</b>
+    /// @code{.cpp}
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        m_isStopping = true;
+    }
+
+    m_condition.notify_one();
+
+    if ( m_thread.joinable() ) {
+        m_thread.join();
+    }
+    /// @endcode
+    //! <b>[stop]</b>
+}
+
+///////////////
+/// @brief Hand over frame to display thread.
+/// @details Never waits on GUI, replaces frame which was not shown yet.
+/// @param[in] _image Frame, owned by display until shown or replaced.
+/// @param[in] _outlines Outlines of found images.
+/// @param[in] _isRgb Frame is in RGB order and converted before show.
+///////////////
+void resultDisplay_t::show(
+    matPool_t::lease_t&& _image,
+    outlines_t&&         _outlines,
+    bool                 _isRgb
+) {
+    //! <b>[hand_over]</b>
+    /// @code{.cpp}
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        m_image     = std::move( _image );
+        m_outlines  = std::move( _outlines );
+        m_isRgb     = _isRgb;
+        m_isPending = true;
+
+        if ( !m_thread.joinable() ) {
+            m_thread = std::thread( &resultDisplay_t::run, this );
+        }
+    }
+
+    m_condition.notify_one();
+    /// @endcode
+    //! <b>[hand_over]</b>
+}
+
+///////////////
+/// @brief Display thread loop.
+///////////////
+void resultDisplay_t::run( void ) {
+    //! <b>[create_window]</b>
+    /// @code{.cpp}
+    cv::namedWindow( RESULT_WINDOW_NAME, cv::WINDOW_AUTOSIZE );
+    /// @endcode
+    //! <b>[create_window]</b>
+
+    for ( ;; ) {
+        //! <b>[take]</b>
+        /// Take latest frame, wake up periodically to keep window responsive.
+        /// @code{.cpp}
+        matPool_t::lease_t l_image;
+        outlines_t         l_outlines;
+        bool               l_isRgb = false;
+
+        {
+            std::unique_lock< std::mutex > l_lock( m_mutex );
+
+            m_condition.wait_for(
+                l_lock,
+                std::chrono::milliseconds( 30 ),
+                [ this ]{ return ( m_isPending || m_isStopping ); }
+            );
+
+            if ( m_isStopping ) {
+                break;
+            }
+
+            if ( m_isPending ) {
+                l_image     = std::move( m_image );
+                l_outlines  = std::move( m_outlines );
+                l_isRgb     = m_isRgb;
+                m_isPending = false;
+            }
+        }
+        /// @endcode
+        //! <b>[take]</b>
+
+        //! <b>[draw]</b>
+        /// Draw outlines on images.
+        /// @code{.cpp}
+        if ( !l_image->empty() ) {
+            if ( l_isRgb ) {
+                cv::cvtColor(
+                    *l_image,
+                    *l_image,
+                    cv::COLOR_RGB2BGR
+                );
+            }
+
+            for ( const std::vector< cv::Point >& _outline : l_outlines ) {
+                cv::polylines(
+                    *l_image,
+                    _outline,
+                    true,
+                    cv::Scalar::all( 0 ),
+                    2,
+                    8,
+                    0
+                );
+            }
+
+            traceScope_t l_trace( "imshow" );
+
+            cv::imshow( RESULT_WINDOW_NAME, *l_image );
+        }
+        /// @endcode
+        //! <b>[draw]</b>
+
+        //! <b>[events]</b>
+        /// @code{.cpp}
+        traceScope_t l_trace( "waitKey" );
+
+        cv::waitKey( 1 );
+        /// @endcode
+        //! <b>[events]</b>
+    }
+
+    //! <b>[destroy_window]</b>
+    /// @code{.cpp}
+    cv::destroyWindow( RESULT_WINDOW_NAME );
+    /// @endcode
+    //! <b>[destroy_window]</b>
+}
+
+///////////////
+/// @brief Get pool shared by stateless calls.
+/// @details Created on first call, images leased from it outlive callers.
+/// @return Process wide pool.
+///////////////
+matPool_t& getDefaultMatPool( void ) {
+    static matPool_t l_matPool;
+
+    return ( l_matPool );
+}
+
+///////////////
+/// @brief Get thread pool shared by stateless calls.
+/// @return Process wide thread pool.
+///////////////
+static threadPool_t& getDefaultThreadPool( void ) {
+    static threadPool_t l_threadPool;
+
+    return ( l_threadPool );
+}
+
+///////////////
+/// @brief Get display shared by stateless calls.
+/// @return Process wide display.
+///////////////
+static resultDisplay_t& getResultDisplay( void ) {
+    //! <b>[declare]</b>
+    /// Pool is constructed first, so it outlives frames held by display at exit.
+    /// @code{.cpp}
+    getDefaultMatPool();
+
+    static resultDisplay_t l_resultDisplay;
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_resultDisplay );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+cv::Mat imageCache_t::get( const std::string& _path ) {
+    //! <b>[stat]</b>
+    /// Modification time and size tell if cached image is still the file content.
+    /// @code{.cpp}
+    std::error_code l_errorCode;
+
+    const uintmax_t l_fileSize         = std::filesystem::file_size( _path, l_errorCode );
+    const int64_t   l_modificationTime = (
+        l_errorCode ?
+        0 :
+        std::filesystem::last_write_time( _path, l_errorCode ).time_since_epoch().count()
+    );
+
+    if ( l_errorCode ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't read source image {}",
+                _path
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[stat]</b>
+
+    //! <b>[check_cache]</b>
+    /// @code{.cpp}
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        auto l_entry = m_entries.find( _path );
+
+        if ( l_entry != m_entries.end() ) {
+            if (
+                ( l_entry->second.modificationTime == l_modificationTime ) &&
+                ( l_entry->second.fileSize == l_fileSize )
+            ) {
+                m_order.splice( m_order.begin(), m_order, l_entry->second.order );
+                m_statistics.hits++;
+
+                return ( l_entry->second.image );
+            }
+
+            m_statistics.bytes -= ( l_entry->second.image.total() * l_entry->second.image.elemSize() );
+            m_statistics.invalidations++;
+
+            m_order.erase( l_entry->second.order );
+            m_entries.erase( l_entry );
+        }
+
+        m_statistics.misses++;
+    }
+    /// @endcode
+    //! <b>[check_cache]</b>
+
+    //! <b>[load_image]</b>
+    /// Decoded without lock, so different images are decoded in parallel.
+    /// @code{.cpp}
+    traceScope_t l_trace( "imread" );
+
+    cv::Mat l_image = cv::imread( _path, cv::IMREAD_COLOR );
+
+    l_trace.end();
+
+    if ( l_image.empty() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't read source image {}",
+                _path
+            )
+        );
+    }
+
+    const size_t l_bytes = ( l_image.total() * l_image.elemSize() );
+    /// @endcode
+    //! <b>[load_image]</b>
+
+    //! <b>[insert]</b>
+    /// Image decoded meanwhile by other thread is kept.
+    /// @code{.cpp}
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    if ( ( l_bytes <= m_budget ) && ( m_entries.find( _path ) == m_entries.end() ) ) {
+        evict( m_budget - l_bytes );
+
+        m_order.push_front( _path );
+        m_entries[ _path ] = { l_image, l_modificationTime, l_fileSize, m_order.begin() };
+
+        m_statistics.bytes += l_bytes;
+    }
+    /// @endcode
+    //! <b>[insert]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_image );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+void imageCache_t::setBudget( size_t _budget ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_budget = _budget;
+
+    evict( m_budget );
+}
+
+void imageCache_t::clear( void ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_entries.clear();
+    m_order.clear();
+
+    m_statistics.bytes = 0;
+}
+
+imageCacheStatistics_t imageCache_t::statistics( void ) const {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    imageCacheStatistics_t l_statistics = m_statistics;
+
+    l_statistics.imagesCount = m_entries.size();
+    l_statistics.budget      = m_budget;
+
+    return ( l_statistics );
+}
+
+///////////////
+/// @brief Evict least recently used images.
+/// @details Called with cache locked.
+/// @param[in] _budget Bytes left cached.
+///////////////
+void imageCache_t::evict( size_t _budget ) {
+    while ( ( m_statistics.bytes > _budget ) && !m_order.empty() ) {
+        auto l_entry = m_entries.find( m_order.back() );
+
+        m_statistics.bytes -= ( l_entry->second.image.total() * l_entry->second.image.elemSize() );
+        m_statistics.evictions++;
+
+        m_entries.erase( l_entry );
+        m_order.pop_back();
+    }
+}
+
+imageCache_t& getImageCache( void ) {
+    static imageCache_t l_imageCache;
+
+    return ( l_imageCache );
+}
+
+///////////////
+/// @brief Compares a template against overlapped image regions.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes or \c FEATURE_MATCH_METHOD .
+/// @param[in] _sourceImage Image where the search is running. It must be 8-bit or 32-bit floating-point.
+/// @param[in] _templateImages Searched templates, index is template ID. It must be not greater than the source image and have the same data type.
+/// @param[in] _showResult Will print out squares of found images to window.
+/// @return Results indexed by template ID.
+///////////////
+std::vector< matchResult_t > matchingMethodFile(
+    uint32_t     _matchMethod,
+    std::string  _sourceImage,
+    const std::vector< std::string >& _templateImages,
+    const bool   _showResult
+) {
+    //! <b>[load_image]</b>
+    /// Load image, repeated samples are taken decoded from cache.
+    /// @code{.cpp}
+    const cv::Mat l_image = getImageCache().get( _sourceImage );
+    /// @endcode
+    //! <b>[load_image]</b>
+
+    //! <b>[match]</b>
+    /// Match template images on source image.
+    /// Outlines are collected only if result is shown.
+    /// @code{.cpp}
+    matPool_t&     l_matPool = getDefaultMatPool();
+    matchResults_t l_results( _templateImages.size() );
+    outlines_t     l_outlines;
+
+    matchTemplates(
+        _matchMethod,
+        l_image,
+        _templateImages,
+        l_results,
+        l_matPool,
+        getDefaultThreadPool(),
+        ( _showResult ? &l_outlines : NULL )
+    );
+    /// @endcode
+    //! <b>[match]</b>
+
+    //! <b>[imshow]</b>
+    /// Show me what you got.
+    /// @code{.cpp}
+    if ( _showResult ) {
+        matPool_t::lease_t l_imageDisplay = l_matPool.acquire( l_image.rows, l_image.cols, l_image.type() );
+
+        l_image.copyTo( *l_imageDisplay );
+
+        getResultDisplay().show(
+            std::move( l_imageDisplay ),
+            std::move( l_outlines ),
+            false
+        );
+    }
+    /// @endcode
+    //! <b>[imshow]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_results.snapshot() );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+std::vector< cv::Mat > correlateTemplates(
+    const cv::Mat&                _image,
+    const std::vector< cv::Mat >& _templateImages,
+    uint32_t                      _matchMethod
+) {
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    if ( _image.empty() || _templateImages.empty() || ( _matchMethod > cv::TM_CCOEFF_NORMED ) ) {
+        throw std::ios_base::failure( "Can't correlate templates, image, templates or method is missing" );
+    }
+
+    for ( const cv::Mat& _templateImage : _templateImages ) {
+        if (
+            ( _templateImage.size() != _templateImages.front().size() ) ||
+            ( _templateImage.type() != _image.type() ) ||
+            ( _templateImage.cols > _image.cols ) ||
+            ( _templateImage.rows > _image.rows )
+        ) {
+            throw std::ios_base::failure( "Can't correlate templates of different size or type, or larger than image" );
+        }
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[correlate]</b>
+    /// Responses are copied out, leases go back to pool.
+    /// @code{.cpp}
+    std::vector< const cv::Mat* >     l_templates;
+    std::vector< matPool_t::lease_t > l_responses( _templateImages.size() );
+    std::vector< cv::Mat >            l_result;
+
+    for ( const cv::Mat& _templateImage : _templateImages ) {
+        l_templates.push_back( &_templateImage );
+    }
+
+    matchTemplateBatch( _image, l_templates, _matchMethod, getDefaultMatPool(), getDefaultThreadPool(), l_responses );
+
+    for ( matPool_t::lease_t& _response : l_responses ) {
+        l_result.push_back( _response->clone() );
+    }
+    /// @endcode
+    //! <b>[correlate]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_result );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Compares a template against overlapped image regions.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes or \c FEATURE_MATCH_METHOD .
+/// @param[in] _sourceWindowName Window where the search is running.
+/// @param[in] _templateImages Searched templates, index is template ID. It must be not greater than the source image and have the same data type.
+/// @param[in] _showResult Will print out squares of found images to other window.
+/// @param[in] _results Table to publish results to, sized to templates count.
+///////////////
+void matchingMethodWindow(
+    uint32_t    _matchMethod,
+    const std::string& _sourceWindowName,
+    const std::vector< std::string >& _templateImages,
+    const bool  _showResult,
+    matchResults_t& _results
+) {
+    //! <b>[load_image]</b>
+    /// Get window capture.
+    /// @code{.cpp}
+    matPool_t&         l_matPool = getDefaultMatPool();
+    matPool_t::lease_t l_image   = getMatFromWindow( _sourceWindowName, l_matPool );
+
+    if ( l_image->empty() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't read source window {}",
+                _sourceWindowName
+            ));
+    }
+    /// @endcode
+    //! <b>[load_image]</b>
+
+    //! <b>[match]</b>
+    /// Match template images on source image.
+    /// Outlines are collected only if result is shown.
+    /// @code{.cpp}
+    outlines_t l_outlines;
+
+    matchTemplates(
+        _matchMethod,
+        *l_image,
+        _templateImages,
+        _results,
+        l_matPool,
+        getDefaultThreadPool(),
+        ( _showResult ? &l_outlines : NULL ) );
+    /// @endcode
+    //! <b>[match]</b>
+
+    //! <b>[imshow]</b>
+    /// Show me what you got.
+    /// Capture is not needed anymore, so it is handed over without copy.
+    /// @code{.cpp}
+    if ( _showResult ) {
+        getResultDisplay().show(
+            std::move( l_image ),
+            std::move( l_outlines ),
+            true
+        );
+    }
+    /// @endcode
+    //! <b>[imshow]</b>
+}
+
+///////////////
+/// @brief Compares a template against overlapped image regions.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes or \c FEATURE_MATCH_METHOD .
+/// @param[in] _sourceWindowName Window where the search is running.
+/// @param[in] _templateImages Searched templates, index is template ID. It must be not greater than the source image and have the same data type.
+/// @param[in] _showResult Will print out squares of found images to other window.
+/// @return Results indexed by template ID.
+///////////////
+std::vector< matchResult_t > matchingMethodWindow(
+    uint32_t    _matchMethod,
+    const std::string& _sourceWindowName,
+    const std::vector< std::string >& _templateImages,
+    const bool  _showResult
+) {
+    //! <b>[match]</b>
+    /// @code{.cpp}
+    matchResults_t l_results( _templateImages.size() );
+
+    matchingMethodWindow(
+        _matchMethod,
+        _sourceWindowName,
+        _templateImages,
+        _showResult,
+        l_results
+    );
+    /// @endcode
+    //! <b>[match]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_results.snapshot() );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+manifest_t readImageDirectory(
+    const std::string& _directory,
+    const std::string& _extension
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    std::map< std::string, std::string >                l_sourceImages;
+    std::map< std::string, std::vector< std::string > > l_templateImages;
+    std::string                                         l_extension = _extension;
+    manifest_t                                          l_manifest;
+
+    auto toLower = []( std::string _text ) {
+        std::transform(
+            _text.begin(),
+            _text.end(),
+            _text.begin(),
+            []( unsigned char _character ){ return ( std::tolower( _character ) ); }
+        );
+
+        return ( _text );
+    };
+
+    l_extension = toLower( l_extension );
+
+    if ( !std::filesystem::is_directory( _directory ) ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't read image directory {}",
+                _directory
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[list]</b>
+    /// Sort files by type and category.
+    /// @code{.cpp}
+    for ( const std::filesystem::directory_entry& _entry : std::filesystem::directory_iterator( _directory ) ) {
+        const std::string l_fileName = _entry.path().filename().string();
+
+        if (
+            !_entry.is_regular_file() ||
+            ( l_fileName.size() <= l_extension.size() ) ||
+            ( toLower( l_fileName.substr( l_fileName.size() - l_extension.size() ) ) != l_extension )
+        ) {
+            continue;
+        }
+
+        const std::string l_name          = l_fileName.substr( 0, ( l_fileName.size() - l_extension.size() ) );
+        const size_t      l_typeEnd       = l_name.find( '.' );
+        const size_t      l_categoryEnd   = l_name.find( '.', ( l_typeEnd + 1 ) );
+
+        if ( l_typeEnd == std::string::npos ) {
+            continue;
+        }
+
+        const std::string l_type     = l_name.substr( 0, l_typeEnd );
+        const std::string l_category = l_name.substr( ( l_typeEnd + 1 ), ( l_categoryEnd - l_typeEnd - 1 ) );
+
+        if ( l_type == "sample" ) {
+            l_sourceImages[ l_category ] = _entry.path().string();
+
+        } else if ( ( l_type == "template" ) && ( l_categoryEnd != std::string::npos ) ) {
+            l_templateImages[ l_category ].push_back( _entry.path().string() );
+        }
+    }
+    /// @endcode
+    //! <b>[list]</b>
+
+    //! <b>[manifest]</b>
+    /// @code{.cpp}
+    for ( std::pair< const std::string, std::vector< std::string > >& _category : l_templateImages ) {
+        auto l_sourceImage = l_sourceImages.find( _category.first );
+
+        if ( l_sourceImage == l_sourceImages.end() ) {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "No sample image for category {}",
+                    _category.first
+                )
+            );
+        }
+
+        std::sort( _category.second.begin(), _category.second.end() );
+
+        l_manifest.emplace_back( l_sourceImage->second, std::move( _category.second ) );
+    }
+    /// @endcode
+    //! <b>[manifest]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_manifest );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+std::vector< batchResult_t > matchingMethodBatch(
+    uint32_t          _matchMethod,
+    const manifest_t& _manifest
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    std::vector< batchResult_t > l_batchResults;
+    std::future< cv::Mat >       l_nextImage;
+
+    auto loadImage = []( const std::string& _sourceImage ) {
+        return ( getImageCache().get( _sourceImage ) );
+    };
+
+    if ( _manifest.empty() ) {
+        return ( l_batchResults );
+    }
+
+    l_nextImage = std::async( std::launch::async, loadImage, _manifest.front().first );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    for ( size_t _sampleIndex = 0; _sampleIndex < _manifest.size(); _sampleIndex++ ) {
+        //! <b>[load_image]</b>
+        /// Decode next sample while current one is matched.
+        /// @code{.cpp}
+        const std::string&                l_sourceImage    = _manifest[ _sampleIndex ].first;
+        const std::vector< std::string >& l_templateImages = _manifest[ _sampleIndex ].second;
+        cv::Mat                           l_image          = l_nextImage.get();
+
+        if ( ( _sampleIndex + 1 ) < _manifest.size() ) {
+            l_nextImage = std::async( std::launch::async, loadImage, _manifest[ _sampleIndex + 1 ].first );
+        }
+        /// @endcode
+        //! <b>[load_image]</b>
+
+        //! <b>[match]</b>
+        /// Match all templates of sample at once.
+        /// @code{.cpp}
+        matchResults_t l_results( l_templateImages.size() );
+
+        matchTemplates(
+            _matchMethod,
+            l_image,
+            l_templateImages,
+            l_results,
+            getDefaultMatPool(),
+            getDefaultThreadPool()
+        );
+
+        for ( size_t _templateId = 0; _templateId < l_templateImages.size(); _templateId++ ) {
+            l_batchResults.push_back( {
+                l_sourceImage,
+                l_templateImages[ _templateId ],
+                l_results.read( _templateId )
+            } );
+        }
+        /// @endcode
+        //! <b>[match]</b>
+    }
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_batchResults );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+frameSource_t::frameSource_t(
+    const std::string& _source,
+    const std::string& _extension,
+    size_t             _prefetchCount
+) : m_prefetchCount( std::max( _prefetchCount, static_cast< size_t >( 1 ) ) ) {
+    //! <b>[list]</b>
+    /// Directory frames are images in name order.
+    /// @code{.cpp}
+    if ( std::filesystem::is_directory( _source ) ) {
+        auto toLower = []( std::string _text ) {
+            std::transform(
+                _text.begin(),
+                _text.end(),
+                _text.begin(),
+                []( unsigned char _character ){ return ( std::tolower( _character ) ); }
+            );
+
+            return ( _text );
+        };
+
+        const std::string l_extension = toLower( _extension );
+
+        for ( const std::filesystem::directory_entry& _entry : std::filesystem::directory_iterator( _source ) ) {
+            const std::string l_fileName = _entry.path().filename().string();
+
+            if (
+                _entry.is_regular_file() &&
+                ( l_fileName.size() > l_extension.size() ) &&
+                ( toLower( l_fileName.substr( l_fileName.size() - l_extension.size() ) ) == l_extension )
+            ) {
+                m_imagePaths.push_back( _entry.path().string() );
+            }
+        }
+
+        std::sort( m_imagePaths.begin(), m_imagePaths.end() );
+    /// @endcode
+    //! <b>[list]</b>
+
+    //! <b>[open]</b>
+    /// Anything else is opened by video backend, including image sequence patterns.
+    /// @code{.cpp}
+    } else {
+        m_videoCapture.reset( new cv::VideoCapture( _source ) );
+
+        if ( !m_videoCapture->isOpened() ) {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "Can't open video {}",
+                    _source
+                )
+            );
+        }
+    }
+    /// @endcode
+    //! <b>[open]</b>
+
+    //! <b>[start]</b>
+    /// @code{.cpp}
+    m_thread = std::thread( &frameSource_t::run, this );
+    /// @endcode
+    //! <b>[start]</b>
+}
+
+frameSource_t::~frameSource_t( void ) {
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        m_isStopping = true;
+    }
+
+    m_condition.notify_one();
+
+    if ( m_thread.joinable() ) {
+        m_thread.join();
+    }
+}
+
+bool frameSource_t::read( cv::Mat& _frame, std::string& _name ) {
+    std::unique_lock< std::mutex > l_lock( m_mutex );
+
+    //! <b>[recycle]</b>
+    /// Buffer of previous frame goes back to decoder.
+    /// @code{.cpp}
+    if ( !_frame.empty() ) {
+        m_freeImages.push_back( std::move( _frame ) );
+
+        _frame = cv::Mat();
+    }
+    /// @endcode
+    //! <b>[recycle]</b>
+
+    //! <b>[wait]</b>
+    /// @code{.cpp}
+    const std::chrono::steady_clock::time_point l_waitStart = std::chrono::steady_clock::now();
+
+    m_frameCondition.wait( l_lock, [ this ]{ return ( !m_frames.empty() || m_isFinished ); } );
+
+    m_waitTime += ( std::chrono::steady_clock::now() - l_waitStart );
+
+    if ( m_frames.empty() ) {
+        if ( m_exception ) {
+            std::rethrow_exception( m_exception );
+        }
+
+        return ( false );
+    }
+    /// @endcode
+    //! <b>[wait]</b>
+
+    //! <b>[take]</b>
+    /// @code{.cpp}
+    _frame = std::move( m_frames.front().image );
+    _name  = std::move( m_frames.front().name );
+
+    m_frames.pop_front();
+
+    l_lock.unlock();
+
+    m_condition.notify_one();
+    /// @endcode
+    //! <b>[take]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( true );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+void frameSource_t::run( void ) {
+    size_t l_imageIndex = 0;
+
+    try {
+        for ( ;; ) {
+            //! <b>[wait]</b>
+            /// Decoder stops when prefetch count frames are waiting.
+            /// @code{.cpp}
+            frame_t l_frame;
+
+            {
+                std::unique_lock< std::mutex > l_lock( m_mutex );
+
+                m_condition.wait( l_lock, [ this ]{ return ( m_isStopping || ( m_frames.size() < m_prefetchCount ) ); } );
+
+                if ( m_isStopping ) {
+                    return;
+                }
+
+                if ( !m_freeImages.empty() ) {
+                    l_frame.image = std::move( m_freeImages.back() );
+
+                    m_freeImages.pop_back();
+                }
+            }
+            /// @endcode
+            //! <b>[wait]</b>
+
+            //! <b>[decode]</b>
+            /// Video decodes into recycled buffer of the same geometry without allocation.
+            /// @code{.cpp}
+            if ( m_videoCapture ) {
+                traceScope_t l_trace( "VideoCapture::read" );
+
+                if ( !m_videoCapture->read( l_frame.image ) ) {
+                    break;
+                }
+
+                l_trace.end();
+
+                l_frame.name = fmt::format( "{:.3f}", ( m_videoCapture->get( cv::CAP_PROP_POS_MSEC ) / 1000 ) );
+
+            } else {
+                if ( l_imageIndex >= m_imagePaths.size() ) {
+                    break;
+                }
+
+                traceScope_t l_trace( "imread" );
+
+                l_frame.name  = m_imagePaths[ l_imageIndex++ ];
+                l_frame.image = cv::imread( l_frame.name, cv::IMREAD_COLOR );
+
+                l_trace.end();
+
+                if ( l_frame.image.empty() ) {
+                    throw std::ios_base::failure(
+                        fmt::format(
+                            "Can't read source image {}",
+                            l_frame.name
+                        )
+                    );
+                }
+            }
+            /// @endcode
+            //! <b>[decode]</b>
+
+            //! <b>[push]</b>
+            /// @code{.cpp}
+            {
+                std::lock_guard< std::mutex > l_lock( m_mutex );
+
+                m_frames.push_back( std::move( l_frame ) );
+            }
+
+            m_frameCondition.notify_one();
+            /// @endcode
+            //! <b>[push]</b>
+        }
+
+    } catch ( ... ) {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        m_exception = std::current_exception();
+    }
+
+    //! <b>[finish]</b>
+    /// @code{.cpp}
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        m_isFinished = true;
+    }
+
+    m_frameCondition.notify_one();
+    /// @endcode
+    //! <b>[finish]</b>
+}
+
+///////////////
+/// @brief Completion fulfilling promise of \c std::future shim.
+/// @param[in] _promise Promise of request results.
+/// @return Completion of request.
+///////////////
+static asyncMatcher_t::completion_t fulfillPromise(
+    std::shared_ptr< std::promise< std::vector< matchResult_t > > > _promise
+) {
+    return ( [ _promise ]( std::exception_ptr _exception, std::vector< matchResult_t > _results ) {
+        if ( _exception ) {
+            _promise->set_exception( std::move( _exception ) );
+
+        } else {
+            _promise->set_value( std::move( _results ) );
+        }
+    } );
+}
+
+asyncMatcher_t::asyncMatcher_t(
+    uint32_t _matchMethod,
+    size_t   _threadsCount
+) : m_matchMethod( _matchMethod ),
+    m_threadPool( _threadsCount ) {
+    //! <b>[start]</b>
+    /// @code{.cpp}
+    m_thread = std::thread( &asyncMatcher_t::run, this );
+    /// @endcode
+    //! <b>[start]</b>
+}
+
+asyncMatcher_t::~asyncMatcher_t( void ) {
+    //! <b>[stop]</b>
+    /// Running request stops after its started templates, queued ones complete as cancelled.
+    /// @code{.cpp}
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        m_isStopping = true;
+
+        for ( auto& _latestRequest : m_latestRequests ) {
+            _latestRequest.second->store( true, std::memory_order_relaxed );
+        }
+    }
+
+    m_condition.notify_one();
+
+    if ( m_thread.joinable() ) {
+        m_thread.join();
+    }
+    /// @endcode
+    //! <b>[stop]</b>
+}
+
+size_t asyncMatcher_t::addTemplate( const std::string& _templateImage ) {
+    //! <b>[load_template]</b>
+    /// Load now, so first request doesn't pay for it.
+    /// @code{.cpp}
+    getTemplateImage( _templateImage );
+
+    if ( m_matchMethod == FEATURE_MATCH_METHOD ) {
+        getTemplateFeatures( _templateImage );
+    }
+    /// @endcode
+    //! <b>[load_template]</b>
+
+    //! <b>[add]</b>
+    /// @code{.cpp}
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_templateImages.push_back( _templateImage );
+
+    return ( m_templateImages.size() - 1 );
+    /// @endcode
+    //! <b>[add]</b>
+}
+
+void asyncMatcher_t::submitFile( const std::string& _sourceImage, completion_t _completion ) {
+    submit( source_t( false, _sourceImage ), std::move( _completion ) );
+}
+
+void asyncMatcher_t::submitWindow( const std::string& _windowName, completion_t _completion ) {
+    submit( source_t( true, _windowName ), std::move( _completion ) );
+}
+
+std::future< std::vector< matchResult_t > > asyncMatcher_t::matchFileAsync( const std::string& _sourceImage ) {
+    auto l_promise = std::make_shared< std::promise< std::vector< matchResult_t > > >();
+    auto l_future  = l_promise->get_future();
+
+    submitFile( _sourceImage, fulfillPromise( std::move( l_promise ) ) );
+
+    return ( l_future );
+}
+
+std::future< std::vector< matchResult_t > > asyncMatcher_t::matchWindowAsync( const std::string& _windowName ) {
+    auto l_promise = std::make_shared< std::promise< std::vector< matchResult_t > > >();
+    auto l_future  = l_promise->get_future();
+
+    submitWindow( _windowName, fulfillPromise( std::move( l_promise ) ) );
+
+    return ( l_future );
+}
+
+void asyncMatcher_t::cancel( void ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    for ( auto& _latestRequest : m_latestRequests ) {
+        _latestRequest.second->store( true, std::memory_order_relaxed );
+    }
+}
+
+void asyncMatcher_t::submit( source_t _source, completion_t _completion ) {
+    request_t l_superseded;
+
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        //! <b>[check]</b>
+        /// @code{.cpp}
+        if ( m_isStopping ) {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "Can't queue {} while matcher stops",
+                    _source.second
+                )
+            );
+        }
+        /// @endcode
+        //! <b>[check]</b>
+
+        //! <b>[supersede]</b>
+        /// Older frame of the same source is cancelled, if it is still queued it is taken out and completed here.
+        /// @code{.cpp}
+        std::shared_ptr< std::atomic< bool > >& l_latestRequest = m_latestRequests[ _source ];
+
+        if ( l_latestRequest ) {
+            l_latestRequest->store( true, std::memory_order_relaxed );
+
+            auto l_queued = std::find_if(
+                m_requests.begin(),
+                m_requests.end(),
+                [ & ]( const request_t& _request ){ return ( _request.isCancelled == l_latestRequest ); }
+            );
+
+            if ( l_queued != m_requests.end() ) {
+                l_superseded = std::move( *l_queued );
+
+                m_requests.erase( l_queued );
+            }
+        }
+        /// @endcode
+        //! <b>[supersede]</b>
+
+        //! <b>[queue]</b>
+        /// @code{.cpp}
+        l_latestRequest = std::make_shared< std::atomic< bool > >( false );
+
+        m_requests.push_back( { std::move( _source ), l_latestRequest, std::move( _completion ) } );
+        /// @endcode
+        //! <b>[queue]</b>
+    }
+
+    m_condition.notify_one();
+
+    //! <b>[complete_superseded]</b>
+    /// Completion runs without lock, it may submit again.
+    /// @code{.cpp}
+    if ( l_superseded.completion ) {
+        l_superseded.completion(
+            std::make_exception_ptr( matchCancelled_t( l_superseded.source.second ) ),
+            {}
+        );
+    }
+    /// @endcode
+    //! <b>[complete_superseded]</b>
+}
+
+std::vector< matchResult_t > asyncMatcher_t::process( const request_t& _request ) {
+    //! <b>[templates]</b>
+    /// Templates added after submit are matched too, paths are copied as they are now.
+    /// @code{.cpp}
+    std::vector< std::string > l_templateImages;
+
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        l_templateImages = m_templateImages;
+    }
+    /// @endcode
+    //! <b>[templates]</b>
+
+    //! <b>[load_image]</b>
+    /// Window is captured into pooled buffer, file is taken decoded from cache.
+    /// @code{.cpp}
+    matPool_t::lease_t l_capture;
+    cv::Mat            l_image;
+
+    if ( _request.source.first ) {
+        l_capture = getMatFromWindow( _request.source.second, m_matPool );
+
+        if ( l_capture->empty() ) {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "Can't read source window {}",
+                    _request.source.second
+                ));
+        }
+
+        l_image = *l_capture;
+
+    } else {
+        l_image = getImageCache().get( _request.source.second );
+    }
+    /// @endcode
+    //! <b>[load_image]</b>
+
+    //! <b>[match]</b>
+    /// Templates not started when newer frame of the same source arrives are skipped.
+    /// @code{.cpp}
+    matchResults_t l_results( l_templateImages.size() );
+
+    matchTemplates(
+        m_matchMethod,
+        l_image,
+        l_templateImages,
+        l_results,
+        m_matPool,
+        m_threadPool,
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        1,
+        _request.isCancelled.get()
+    );
+
+    if ( _request.isCancelled->load( std::memory_order_relaxed ) ) {
+        throw matchCancelled_t( _request.source.second );
+    }
+    /// @endcode
+    //! <b>[match]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_results.snapshot() );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+void asyncMatcher_t::run( void ) {
+    for ( ;; ) {
+        //! <b>[wait]</b>
+        /// Dispatcher drains queue before it stops, so every request completes.
+        /// @code{.cpp}
+        request_t l_request;
+
+        {
+            std::unique_lock< std::mutex > l_lock( m_mutex );
+
+            m_condition.wait( l_lock, [ this ]{ return ( m_isStopping || !m_requests.empty() ); } );
+
+            if ( m_requests.empty() ) {
+                return;
+            }
+
+            l_request = std::move( m_requests.front() );
+
+            m_requests.pop_front();
+        }
+        /// @endcode
+        //! <b>[wait]</b>
+
+        //! <b>[process]</b>
+        /// @code{.cpp}
+        std::exception_ptr           l_exception;
+        std::vector< matchResult_t > l_results;
+
+        try {
+            if ( l_request.isCancelled->load( std::memory_order_relaxed ) ) {
+                throw matchCancelled_t( l_request.source.second );
+            }
+
+            l_results = process( l_request );
+
+        } catch ( ... ) {
+            l_exception = std::current_exception();
+        }
+        /// @endcode
+        //! <b>[process]</b>
+
+        //! <b>[forget]</b>
+        /// Source forgets request unless newer one took its place.
+        /// @code{.cpp}
+        {
+            std::lock_guard< std::mutex > l_lock( m_mutex );
+
+            auto l_latestRequest = m_latestRequests.find( l_request.source );
+
+            if ( ( l_latestRequest != m_latestRequests.end() ) && ( l_latestRequest->second == l_request.isCancelled ) ) {
+                m_latestRequests.erase( l_latestRequest );
+            }
+        }
+        /// @endcode
+        //! <b>[forget]</b>
+
+        //! <b>[complete]</b>
+        /// Exception of completion must not stop dispatcher, whatever it throws.
+        /// @code{.cpp}
+        try {
+            l_request.completion( l_exception, std::move( l_results ) );
+
+        } catch ( const std::exception& _exception ) {
+            fmt::print( stderr, "Completion of {} failed: {}\n", l_request.source.second, _exception.what() );
+
+        } catch ( ... ) {
+            fmt::print( stderr, "Completion of {} failed\n", l_request.source.second );
+        }
+        /// @endcode
+        //! <b>[complete]</b>
+    }
+}
+
+#ifndef _WIN32
+
+//! <b>[struct]</b>
+/// Frame ring memory starts with header, followed by slots.
+/// Every slot is slot header and frame data, both cache line aligned.
+/// @code{.cpp}
+struct frameRingHeader_t {
+    std::atomic< uint64_t > magic; // Written last, other fields are ready once it matches
+    uint32_t version;
+    uint32_t slotsCount;
+    uint64_t frameSize;  // Bytes reserved for frame data in every slot
+    uint64_t slotStride; // Bytes between slots
+    uint64_t generation; // Times ring was recreated with larger slots
+    std::atomic< uint32_t > isReplaced; // Newer ring of the same name is created
+    alignas( CACHE_LINE_SIZE ) std::atomic< uint64_t > sequence; // Newest published frame, 0 if none
+};
+
+struct frameRingSlot_t {
+    std::atomic< uint64_t > sequence; // Frame in slot, 0 while it is written
+    int32_t                 rows;
+    int32_t                 cols;
+    int32_t                 type;
+    uint32_t                step;
+    int64_t                 timestamp; // Nanoseconds of steady clock at publish
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Map frame ring from POSIX shared memory or file.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _name Shared memory name like "/frames" or file path.
+/// @param[in] _isFileBacked Name is file path.
+/// @param[in] _size Size to create with, 0 to open existing read-only.
+/// @param[out] _descriptor Opened descriptor.
+/// @param[out] _memorySize Mapped size.
+/// @return Mapped memory.
+///////////////
+static uint8_t* mapFrameRing(
+    const std::string& _name,
+    bool               _isFileBacked,
+    size_t             _size,
+    int&               _descriptor,
+    size_t&            _memorySize
+) {
+    //! <b>[open]</b>
+    /// @code{.cpp}
+    const int l_flags = ( _size ? ( O_RDWR | O_CREAT ) : O_RDONLY );
+
+    _descriptor = (
+        _isFileBacked
+        ? open( _name.c_str(), l_flags, 0644 )
+        : shm_open( _name.c_str(), l_flags, 0644 )
+    );
+
+    if ( _descriptor < 0 ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't open frame ring {}: {}",
+                _name,
+                strerror( errno )
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[open]</b>
+
+    //! <b>[size]</b>
+    /// @code{.cpp}
+    struct stat l_stat;
+
+    if (
+        ( _size && ( ftruncate( _descriptor, _size ) != 0 ) ) ||
+        ( fstat( _descriptor, &l_stat ) != 0 ) ||
+        ( static_cast< size_t >( l_stat.st_size ) < sizeof( frameRingHeader_t ) )
+    ) {
+        close( _descriptor );
+
+        throw std::ios_base::failure(
+            fmt::format(
+                "Wrong frame ring size {}",
+                _name
+            )
+        );
+    }
+
+    _memorySize = l_stat.st_size;
+    /// @endcode
+    //! <b>[size]</b>
+
+    //! <b>[map]</b>
+    /// @code{.cpp}
+    void* l_memory = mmap(
+        NULL,
+        _memorySize,
+        ( _size ? ( PROT_READ | PROT_WRITE ) : PROT_READ ),
+        MAP_SHARED,
+        _descriptor,
+        0
+    );
+
+    if ( l_memory == MAP_FAILED ) {
+        close( _descriptor );
+
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't map frame ring {}",
+                _name
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[map]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( static_cast< uint8_t* >( l_memory ) );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+frameRingWriter_t::frameRingWriter_t(
+    const std::string& _name,
+    size_t             _frameSize,
+    uint32_t           _slotsCount,
+    bool               _isFileBacked
+) : m_name( _name ), m_isFileBacked( _isFileBacked ) {
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    if ( !_slotsCount ) {
+        throw std::ios_base::failure( "Frame ring needs at least one slot" );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[create]</b>
+    /// @code{.cpp}
+    create( _frameSize, _slotsCount, 0, 0 );
+    /// @endcode
+    //! <b>[create]</b>
+}
+
+///////////////
+/// @brief Create ring under writer's name and map it.
+/// @details Previous mapping is left to caller. Throws ios_base::failure at error.
+/// @param[in] _frameSize Largest frame in bytes.
+/// @param[in] _slotsCount Frames kept.
+/// @param[in] _generation Times ring was recreated.
+/// @param[in] _sequence Sequence number frames go on from.
+///////////////
+void frameRingWriter_t::create( size_t _frameSize, uint32_t _slotsCount, uint64_t _generation, uint64_t _sequence ) {
+    //! <b>[layout]</b>
+    /// @code{.cpp}
+    const size_t l_slotStride = (
+        ( ( CACHE_LINE_SIZE + _frameSize + CACHE_LINE_SIZE - 1 ) / CACHE_LINE_SIZE ) * CACHE_LINE_SIZE
+    );
+    int          l_descriptor;
+    size_t       l_memorySize;
+    /// @endcode
+    //! <b>[layout]</b>
+
+    //! <b>[map]</b>
+    /// Stale ring of the same name is replaced.
+    /// @code{.cpp}
+    if ( m_isFileBacked ) {
+        unlink( m_name.c_str() );
+
+    } else {
+        shm_unlink( m_name.c_str() );
+    }
+
+    uint8_t* l_memory = mapFrameRing(
+        m_name,
+        m_isFileBacked,
+        ( FRAME_RING_HEADER_SIZE + ( l_slotStride * _slotsCount ) ),
+        l_descriptor,
+        l_memorySize
+    );
+    /// @endcode
+    //! <b>[map]</b>
+
+    //! <b>[header]</b>
+    /// Magic is written last, readers don't accept ring before it.
+    /// @code{.cpp}
+    frameRingHeader_t* l_header = new ( l_memory ) frameRingHeader_t;
+
+    l_header->version    = FRAME_RING_VERSION;
+    l_header->slotsCount = _slotsCount;
+    l_header->frameSize  = _frameSize;
+    l_header->slotStride = l_slotStride;
+    l_header->generation = _generation;
+    l_header->isReplaced.store( 0, std::memory_order_relaxed );
+    l_header->sequence.store( _sequence, std::memory_order_relaxed );
+
+    for ( uint32_t _slotIndex = 0; _slotIndex < _slotsCount; _slotIndex++ ) {
+        new ( l_memory + FRAME_RING_HEADER_SIZE + ( l_slotStride * _slotIndex ) ) frameRingSlot_t{};
+    }
+
+    std::atomic_thread_fence( std::memory_order_release );
+
+    l_header->magic.store( FRAME_RING_MAGIC, std::memory_order_relaxed );
+
+    m_memory     = l_memory;
+    m_memorySize = l_memorySize;
+    m_descriptor = l_descriptor;
+    /// @endcode
+    //! <b>[header]</b>
+}
+
+frameRingWriter_t::~frameRingWriter_t( void ) {
+    //! <b>[unmap]</b>
+    /// Shared memory goes away with writer, readers keep their mappings until they close.
+    /// @code{.cpp}
+    munmap( m_memory, m_memorySize );
+    close( m_descriptor );
+
+    if ( !m_isFileBacked ) {
+        shm_unlink( m_name.c_str() );
+    }
+    /// @endcode
+    //! <b>[unmap]</b>
+}
+
+uint64_t frameRingWriter_t::publish( const cv::Mat& _frame ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    frameRingHeader_t* l_header   = reinterpret_cast< frameRingHeader_t* >( m_memory );
+    const size_t       l_rowSize  = ( _frame.cols * _frame.elemSize() );
+    const size_t       l_dataSize = ( l_rowSize * _frame.rows );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[replace]</b>
+    /// Frame larger than slots, ring is recreated under the same name with slots fitting it.
+    /// Sequence numbers go on, old ring is marked replaced, so readers reopen ring.
+    /// @code{.cpp}
+    if ( l_dataSize > l_header->frameSize ) {
+        uint8_t*     l_memory     = m_memory;
+        const size_t l_memorySize = m_memorySize;
+        const int    l_descriptor = m_descriptor;
+
+        create(
+            l_dataSize,
+            l_header->slotsCount,
+            ( l_header->generation + 1 ),
+            l_header->sequence.load( std::memory_order_relaxed )
+        );
+
+        l_header->isReplaced.store( 1, std::memory_order_release );
+
+        munmap( l_memory, l_memorySize );
+        close( l_descriptor );
+
+        l_header = reinterpret_cast< frameRingHeader_t* >( m_memory );
+    }
+    /// @endcode
+    //! <b>[replace]</b>
+
+    //! <b>[slot]</b>
+    /// @code{.cpp}
+    const uint64_t   l_sequence   = ( l_header->sequence.load( std::memory_order_relaxed ) + 1 );
+    uint8_t*         l_slotMemory = ( m_memory + FRAME_RING_HEADER_SIZE + ( l_header->slotStride * ( l_sequence % l_header->slotsCount ) ) );
+    frameRingSlot_t* l_slot       = reinterpret_cast< frameRingSlot_t* >( l_slotMemory );
+    uint8_t*         l_data       = ( l_slotMemory + CACHE_LINE_SIZE );
+    /// @endcode
+    //! <b>[slot]</b>
+
+    //! <b>[write]</b>
+    /// Slot is marked as being written before data is touched.
+    /// @code{.cpp}
+    l_slot->sequence.store( 0, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    for ( int _row = 0; _row < _frame.rows; _row++ ) {
+        std::memcpy( ( l_data + ( l_rowSize * _row ) ), _frame.ptr( _row ), l_rowSize );
+    }
+
+    l_slot->rows      = _frame.rows;
+    l_slot->cols      = _frame.cols;
+    l_slot->type      = _frame.type();
+    l_slot->step      = l_rowSize;
+    l_slot->timestamp = std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+    /// @endcode
+    //! <b>[write]</b>
+
+    //! <b>[publish]</b>
+    /// @code{.cpp}
+    l_slot->sequence.store( l_sequence, std::memory_order_release );
+    l_header->sequence.store( l_sequence, std::memory_order_release );
+    /// @endcode
+    //! <b>[publish]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_sequence );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+frameRingReader_t::frameRingReader_t( const std::string& _name, bool _isFileBacked ) : m_name( _name ), m_isFileBacked( _isFileBacked ) {
+    attach();
+}
+
+///////////////
+/// @brief Map ring of reader's name, mapping of replaced ring is released.
+/// @details Previous mapping is kept at error. Throws ios_base::failure at error.
+///////////////
+void frameRingReader_t::attach( void ) {
+    //! <b>[map]</b>
+    /// @code{.cpp}
+    int                  l_descriptor;
+    size_t               l_memorySize;
+    const uint8_t* const l_memory = mapFrameRing( m_name, m_isFileBacked, 0, l_descriptor, l_memorySize );
+    /// @endcode
+    //! <b>[map]</b>
+
+    //! <b>[check]</b>
+    /// Magic is loaded before fence, so header written before it is seen once it matches.
+    /// @code{.cpp}
+    const frameRingHeader_t* l_header = reinterpret_cast< const frameRingHeader_t* >( l_memory );
+    const uint64_t           l_magic  = l_header->magic.load( std::memory_order_relaxed );
+
+    std::atomic_thread_fence( std::memory_order_acquire );
+
+    if (
+        ( l_magic != FRAME_RING_MAGIC ) ||
+        ( l_header->version != FRAME_RING_VERSION ) ||
+        ( l_memorySize < ( FRAME_RING_HEADER_SIZE + ( l_header->slotStride * l_header->slotsCount ) ) )
+    ) {
+        munmap( const_cast< uint8_t* >( l_memory ), l_memorySize );
+        close( l_descriptor );
+
+        throw std::ios_base::failure(
+            fmt::format(
+                "Not a frame ring {}",
+                m_name
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[swap]</b>
+    /// @code{.cpp}
+    if ( m_memory ) {
+        munmap( const_cast< uint8_t* >( m_memory ), m_memorySize );
+        close( m_descriptor );
+    }
+
+    m_memory     = l_memory;
+    m_memorySize = l_memorySize;
+    m_descriptor = l_descriptor;
+    /// @endcode
+    //! <b>[swap]</b>
+}
+
+frameRingReader_t::~frameRingReader_t( void ) {
+    munmap( const_cast< uint8_t* >( m_memory ), m_memorySize );
+    close( m_descriptor );
+}
+
+uint64_t frameRingReader_t::read( uint64_t _lastSequence, cv::Mat& _frame, std::chrono::steady_clock::time_point* _publishTime ) {
+    //! <b>[reattach]</b>
+    /// Writer recreated ring with larger slots, newer frames are in new ring.
+    /// Until it is opened there is no newer frame.
+    /// @code{.cpp}
+    if ( reinterpret_cast< const frameRingHeader_t* >( m_memory )->isReplaced.load( std::memory_order_acquire ) ) {
+        try {
+            attach();
+
+        } catch ( const std::ios_base::failure& ) {
+            return ( 0 );
+        }
+    }
+    /// @endcode
+    //! <b>[reattach]</b>
+
+    //! <b>[newest]</b>
+    /// @code{.cpp}
+    const frameRingHeader_t* l_header   = reinterpret_cast< const frameRingHeader_t* >( m_memory );
+    const uint64_t           l_sequence = l_header->sequence.load( std::memory_order_acquire );
+
+    if ( !l_sequence || ( l_sequence == _lastSequence ) ) {
+        return ( 0 );
+    }
+    /// @endcode
+    //! <b>[newest]</b>
+
+    //! <b>[slot]</b>
+    /// Frame is used in place, its slot is reused only after \c slotsCount newer frames.
+    /// @code{.cpp}
+    const uint8_t*         l_slotMemory = ( m_memory + FRAME_RING_HEADER_SIZE + ( l_header->slotStride * ( l_sequence % l_header->slotsCount ) ) );
+    const frameRingSlot_t* l_slot       = reinterpret_cast< const frameRingSlot_t* >( l_slotMemory );
+
+    if ( l_slot->sequence.load( std::memory_order_acquire ) != l_sequence ) {
+        return ( 0 );
+    }
+
+    _frame = cv::Mat(
+        l_slot->rows,
+        l_slot->cols,
+        l_slot->type,
+        const_cast< uint8_t* >( l_slotMemory + CACHE_LINE_SIZE ),
+        l_slot->step
+    );
+
+    if ( _publishTime ) {
+        *_publishTime = std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast< std::chrono::steady_clock::duration >( std::chrono::nanoseconds( l_slot->timestamp ) )
+        );
+    }
+    /// @endcode
+    //! <b>[slot]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( isValid( l_sequence ) ? l_sequence : 0 );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+bool frameRingReader_t::isValid( uint64_t _sequence ) const {
+    //! <b>[check]</b>
+    /// Everything read from slot before is ordered before sequence check.
+    /// @code{.cpp}
+    const frameRingHeader_t* l_header     = reinterpret_cast< const frameRingHeader_t* >( m_memory );
+    const frameRingSlot_t*   l_slot       = reinterpret_cast< const frameRingSlot_t* >(
+        m_memory + FRAME_RING_HEADER_SIZE + ( l_header->slotStride * ( _sequence % l_header->slotsCount ) )
+    );
+
+    std::atomic_thread_fence( std::memory_order_acquire );
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_slot->sequence.load( std::memory_order_relaxed ) == _sequence );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+void captureWindowToFrameRing(
+    const std::string& _windowName,
+    const std::string& _ringName,
+    double             _framesPerSecond,
+    uint64_t           _framesCount,
+    uint32_t           _slotsCount,
+    bool               _isFileBacked
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    windowCapture_t                       l_windowCapture( _windowName );
+    matPool_t                             l_matPool;
+    matPool_t::lease_t                    l_image;
+    std::unique_ptr< frameRingWriter_t >  l_frameRingWriter;
+    const std::chrono::nanoseconds        l_framePeriod = std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::duration< double >( 1 / _framesPerSecond )
+    );
+    std::chrono::steady_clock::time_point l_deadline = std::chrono::steady_clock::now();
+    /// @endcode
+    //! <b>[declare]</b>
+
+    for ( uint64_t _frame = 0; ( !_framesCount || ( _frame < _framesCount ) ); _frame++ ) {
+        //! <b>[capture]</b>
+        /// Ring is created on first frame with slots fitting it, writer recreates it if window grows.
+        /// @code{.cpp}
+        l_windowCapture.capture( l_matPool, l_image );
+
+        if ( !l_frameRingWriter ) {
+            l_frameRingWriter.reset(
+                new frameRingWriter_t(
+                    _ringName,
+                    ( l_image->cols * l_image->elemSize() * l_image->rows ),
+                    _slotsCount,
+                    _isFileBacked
+                )
+            );
+        }
+
+        l_frameRingWriter->publish( *l_image );
+        /// @endcode
+        //! <b>[capture]</b>
+
+        //! <b>[pace]</b>
+        /// @code{.cpp}
+        l_deadline = std::max( ( l_deadline + l_framePeriod ), std::chrono::steady_clock::now() );
+
+        std::this_thread::sleep_until( l_deadline );
+        /// @endcode
+        //! <b>[pace]</b>
+    }
+}
+
+#else // _WIN32
+
+frameRingWriter_t::frameRingWriter_t(
+    const std::string& _name,
+    size_t             _frameSize,
+    uint32_t           _slotsCount,
+    bool               _isFileBacked
+) {
+    throw std::ios_base::failure( "Frame ring is not supported" );
+}
+
+frameRingWriter_t::~frameRingWriter_t( void ) {}
+
+uint64_t frameRingWriter_t::publish( const cv::Mat& _frame ) {
+    return ( 0 );
+}
+
+frameRingReader_t::frameRingReader_t( const std::string& _name, bool _isFileBacked ) {
+    throw std::ios_base::failure( "Frame ring is not supported" );
+}
+
+frameRingReader_t::~frameRingReader_t( void ) {}
+
+uint64_t frameRingReader_t::read( uint64_t _lastSequence, cv::Mat& _frame, std::chrono::steady_clock::time_point* _publishTime ) {
+    return ( 0 );
+}
+
+bool frameRingReader_t::isValid( uint64_t _sequence ) const {
+    return ( false );
+}
+
+void captureWindowToFrameRing(
+    const std::string& _windowName,
+    const std::string& _ringName,
+    double             _framesPerSecond,
+    uint64_t           _framesCount,
+    uint32_t           _slotsCount,
+    bool               _isFileBacked
+) {
+    throw std::ios_base::failure( "Frame ring is not supported" );
+}
+
+#endif // _WIN32
+
+#ifndef _WIN32
+
+//! <b>[enum]</b>
+/// @code{.cpp}
+enum frameStreamRecord_t {
+    FRAME_RECORD   = 1,
+    RESULTS_RECORD = 2
+};
+
+enum frameStreamCompression_t {
+    RAW_FRAME = 0,
+    PNG_FRAME = 1
+};
+/// @endcode
+//! <b>[enum]</b>
+
+//! <b>[struct]</b>
+/// Frame stream is file header and records, every record starts at \c FRAME_STREAM_ALIGNMENT ,
+/// so mapped raw frames are used in place. Frame record is followed by results of that frame.
+/// @code{.cpp}
+struct frameStreamHeader_t {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct frameStreamRecordHeader_t {
+    uint32_t type;
+    uint32_t compression;
+    uint64_t size;      // Whole record with padding
+    int64_t  timestamp; // Nanoseconds since recording start
+    uint64_t frame;
+    int32_t  rows;      // Frame size or results count
+    int32_t  cols;
+    int32_t  matType;
+    uint32_t dataSize;  // Bytes after record header
+};
+
+struct frameStreamResult_t {
+    uint32_t x;
+    uint32_t y;
+    double   score;
+    uint64_t frame;
+    uint32_t found;
+    uint32_t reserved;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Size rounded up to \c FRAME_STREAM_ALIGNMENT .
+/// @param[in] _size Size.
+/// @return Aligned size.
+///////////////
+static size_t alignFrameStream( size_t _size ) {
+    return ( ( ( _size + FRAME_STREAM_ALIGNMENT - 1 ) / FRAME_STREAM_ALIGNMENT ) * FRAME_STREAM_ALIGNMENT );
+}
+
+///////////////
+/// @brief Append record to frame stream.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _descriptor Stream descriptor.
+/// @param[in,out] _header Record header, its size is set.
+/// @param[in] _data Record data.
+///////////////
+static void appendFrameStreamRecord(
+    int                        _descriptor,
+    frameStreamRecordHeader_t& _header,
+    const void*                _data
+) {
+    //! <b>[declare]</b>
+    /// Header, data and padding go out with one call.
+    /// @code{.cpp}
+    static const uint8_t l_padding[ FRAME_STREAM_ALIGNMENT ] = {};
+    const size_t         l_recordHeaderSize = alignFrameStream( sizeof( frameStreamRecordHeader_t ) );
+
+    _header.size = ( l_recordHeaderSize + alignFrameStream( _header.dataSize ) );
+
+    struct iovec l_vectors[ 4 ] = {
+        { &_header, sizeof( _header ) },
+        { const_cast< uint8_t* >( l_padding ), ( l_recordHeaderSize - sizeof( _header ) ) },
+        { const_cast< void* >( _data ), _header.dataSize },
+        { const_cast< uint8_t* >( l_padding ), ( alignFrameStream( _header.dataSize ) - _header.dataSize ) }
+    };
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[write]</b>
+    /// @code{.cpp}
+    if ( writev( _descriptor, l_vectors, 4 ) != static_cast< ssize_t >( _header.size ) ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't write frame stream: {}",
+                strerror( errno )
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[write]</b>
+}
+
+frameRecorder_t::frameRecorder_t( const std::string& _path, bool _isCompressed ) : m_isCompressed( _isCompressed ) {
+    //! <b>[open]</b>
+    /// @code{.cpp}
+    m_descriptor = open( _path.c_str(), ( O_WRONLY | O_CREAT | O_TRUNC | O_APPEND ), 0644 );
+
+    if ( m_descriptor < 0 ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't open frame stream {}: {}",
+                _path,
+                strerror( errno )
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[open]</b>
+
+    //! <b>[header]</b>
+    /// @code{.cpp}
+    uint8_t             l_header[ FRAME_STREAM_ALIGNMENT ] = {};
+    frameStreamHeader_t l_streamHeader                     = { FRAME_STREAM_MAGIC, FRAME_STREAM_VERSION, 0 };
+
+    std::memcpy( l_header, &l_streamHeader, sizeof( l_streamHeader ) );
+
+    if ( write( m_descriptor, l_header, sizeof( l_header ) ) != sizeof( l_header ) ) {
+        close( m_descriptor );
+
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't write frame stream {}",
+                _path
+            )
+        );
+    }
+
+    m_start = std::chrono::steady_clock::now();
+    /// @endcode
+    //! <b>[header]</b>
+
+    //! <b>[start]</b>
+    /// Compressed frames are encoded on recorder thread.
+    /// @code{.cpp}
+    if ( m_isCompressed ) {
+        m_thread = std::thread( &frameRecorder_t::run, this );
+    }
+    /// @endcode
+    //! <b>[start]</b>
+}
+
+frameRecorder_t::~frameRecorder_t( void ) {
+    //! <b>[stop]</b>
+    /// Queued records are written before recorder thread ends.
+    /// @code{.cpp}
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        m_isStopping = true;
+    }
+
+    m_condition.notify_all();
+
+    if ( m_thread.joinable() ) {
+        m_thread.join();
+    }
+
+    close( m_descriptor );
+    /// @endcode
+    //! <b>[stop]</b>
+}
+
+void frameRecorder_t::recordFrame( const cv::Mat& _frame ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const int64_t l_timestamp = std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now() - m_start
+    ).count();
+
+    m_framesCount++;
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[raw]</b>
+    /// Raw frame is written on caller thread.
+    /// @code{.cpp}
+    if ( !m_isCompressed ) {
+        writeFrame( _frame, l_timestamp, m_framesCount );
+
+        return;
+    }
+    /// @endcode
+    //! <b>[raw]</b>
+
+    //! <b>[queue]</b>
+    /// Frame is copied to image of encoded frame, caller waits only if recorder thread falls behind.
+    /// @code{.cpp}
+    std::unique_lock< std::mutex > l_lock( m_mutex );
+
+    m_condition.wait( l_lock, [ this ] { return ( m_error || ( m_queuedFramesCount < FRAME_STREAM_QUEUE_SIZE ) ); } );
+
+    if ( m_error ) {
+        std::rethrow_exception( m_error );
+    }
+
+    record_t l_record = { l_timestamp, m_framesCount, cv::Mat(), std::vector< matchResult_t >() };
+
+    if ( !m_freeImages.empty() ) {
+        l_record.image = std::move( m_freeImages.back() );
+
+        m_freeImages.pop_back();
+    }
+
+    _frame.copyTo( l_record.image );
+
+    m_records.push_back( std::move( l_record ) );
+    m_queuedFramesCount++;
+
+    l_lock.unlock();
+    m_condition.notify_all();
+    /// @endcode
+    //! <b>[queue]</b>
+}
+
+void frameRecorder_t::recordResults( const std::vector< matchResult_t >& _results ) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const int64_t l_timestamp = std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now() - m_start
+    ).count();
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[raw]</b>
+    /// @code{.cpp}
+    if ( !m_isCompressed ) {
+        writeResults( _results, l_timestamp, m_framesCount );
+
+        return;
+    }
+    /// @endcode
+    //! <b>[raw]</b>
+
+    //! <b>[queue]</b>
+    /// Results follow their frame in queue, so records keep their order.
+    /// @code{.cpp}
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        if ( m_error ) {
+            std::rethrow_exception( m_error );
+        }
+
+        m_records.push_back( { l_timestamp, m_framesCount, cv::Mat(), _results } );
+    }
+
+    m_condition.notify_all();
+    /// @endcode
+    //! <b>[queue]</b>
+}
+
+void frameRecorder_t::run( void ) {
+    std::unique_lock< std::mutex > l_lock( m_mutex );
+
+    while ( true ) {
+        //! <b>[wait]</b>
+        /// Queue is drained before stopping.
+        /// @code{.cpp}
+        m_condition.wait( l_lock, [ this ] { return ( m_isStopping || !m_records.empty() ); } );
+
+        if ( m_records.empty() ) {
+            break;
+        }
+
+        record_t l_record = std::move( m_records.front() );
+
+        m_records.pop_front();
+        /// @endcode
+        //! <b>[wait]</b>
+
+        //! <b>[write]</b>
+        /// Stream is abandoned after first error, it is thrown to next caller.
+        /// @code{.cpp}
+        const bool l_isFailed = static_cast< bool >( m_error );
+
+        l_lock.unlock();
+
+        std::exception_ptr l_error;
+
+        if ( !l_isFailed ) {
+            try {
+                if ( !l_record.image.empty() ) {
+                    writeFrame( l_record.image, l_record.timestamp, l_record.frame );
+
+                } else {
+                    writeResults( l_record.results, l_record.timestamp, l_record.frame );
+                }
+
+            } catch ( ... ) {
+                l_error = std::current_exception();
+            }
+        }
+
+        l_lock.lock();
+
+        if ( l_error ) {
+            m_error = l_error;
+        }
+        /// @endcode
+        //! <b>[write]</b>
+
+        //! <b>[recycle]</b>
+        /// @code{.cpp}
+        if ( !l_record.image.empty() ) {
+            m_freeImages.push_back( std::move( l_record.image ) );
+            m_queuedFramesCount--;
+        }
+
+        m_condition.notify_all();
+        /// @endcode
+        //! <b>[recycle]</b>
+    }
+}
+
+void frameRecorder_t::writeFrame( const cv::Mat& _frame, int64_t _timestamp, uint64_t _frameNumber ) {
+    //! <b>[header]</b>
+    /// @code{.cpp}
+    frameStreamRecordHeader_t l_header = {};
+
+    l_header.type      = FRAME_RECORD;
+    l_header.timestamp = _timestamp;
+    l_header.frame     = _frameNumber;
+    l_header.rows      = _frame.rows;
+    l_header.cols      = _frame.cols;
+    l_header.matType   = _frame.type();
+    /// @endcode
+    //! <b>[header]</b>
+
+    //! <b>[compressed]</b>
+    /// Fastest PNG level, lossless.
+    /// @code{.cpp}
+    if ( m_isCompressed ) {
+        cv::imencode( ".png", _frame, m_buffer, { cv::IMWRITE_PNG_COMPRESSION, FRAME_STREAM_PNG_COMPRESSION } );
+
+        l_header.compression = PNG_FRAME;
+        l_header.dataSize    = m_buffer.size();
+
+        appendFrameStreamRecord( m_descriptor, l_header, m_buffer.data() );
+
+        return;
+    }
+    /// @endcode
+    //! <b>[compressed]</b>
+
+    //! <b>[raw]</b>
+    /// @code{.cpp}
+    const cv::Mat l_frame = ( _frame.isContinuous() ? _frame : _frame.clone() );
+
+    l_header.compression = RAW_FRAME;
+    l_header.dataSize    = ( l_frame.total() * l_frame.elemSize() );
+
+    appendFrameStreamRecord( m_descriptor, l_header, l_frame.data );
+    /// @endcode
+    //! <b>[raw]</b>
+}
+
+void frameRecorder_t::writeResults( const std::vector< matchResult_t >& _results, int64_t _timestamp, uint64_t _frameNumber ) {
+    //! <b>[convert]</b>
+    /// @code{.cpp}
+    std::vector< frameStreamResult_t > l_results( _results.size() );
+
+    for ( size_t _templateId = 0; _templateId < _results.size(); _templateId++ ) {
+        l_results[ _templateId ] = {
+            _results[ _templateId ].x,
+            _results[ _templateId ].y,
+            _results[ _templateId ].score,
+            _results[ _templateId ].frame,
+            _results[ _templateId ].found,
+            0
+        };
+    }
+    /// @endcode
+    //! <b>[convert]</b>
+
+    //! <b>[append]</b>
+    /// @code{.cpp}
+    frameStreamRecordHeader_t l_header = {};
+
+    l_header.type      = RESULTS_RECORD;
+    l_header.timestamp = _timestamp;
+    l_header.frame     = _frameNumber;
+    l_header.rows      = l_results.size();
+    l_header.dataSize  = ( l_results.size() * sizeof( frameStreamResult_t ) );
+
+    appendFrameStreamRecord( m_descriptor, l_header, l_results.data() );
+    /// @endcode
+    //! <b>[append]</b>
+}
+
+frameReplay_t::frameReplay_t( const std::string& _path ) {
+    //! <b>[map]</b>
+    /// @code{.cpp}
+    struct stat l_stat;
+
+    m_descriptor = open( _path.c_str(), O_RDONLY );
+
+    if ( ( m_descriptor < 0 ) || ( fstat( m_descriptor, &l_stat ) != 0 ) ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't open frame stream {}",
+                _path
+            )
+        );
+    }
+
+    m_memorySize = l_stat.st_size;
+    m_memory     = static_cast< const uint8_t* >(
+        ( m_memorySize >= FRAME_STREAM_ALIGNMENT )
+        ? mmap( NULL, m_memorySize, PROT_READ, MAP_SHARED, m_descriptor, 0 )
+        : MAP_FAILED
+    );
+
+    const frameStreamHeader_t* l_streamHeader = reinterpret_cast< const frameStreamHeader_t* >( m_memory );
+
+    if (
+        ( m_memory == MAP_FAILED ) ||
+        ( l_streamHeader->magic != FRAME_STREAM_MAGIC ) ||
+        ( l_streamHeader->version != FRAME_STREAM_VERSION )
+    ) {
+        if ( m_memory != MAP_FAILED ) {
+            munmap( const_cast< uint8_t* >( m_memory ), m_memorySize );
+        }
+
+        close( m_descriptor );
+
+        throw std::ios_base::failure(
+            fmt::format(
+                "Not a frame stream {}",
+                _path
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[map]</b>
+
+    //! <b>[index]</b>
+    /// Record cut by crash of recorder ends the stream.
+    /// @code{.cpp}
+    size_t l_offset = FRAME_STREAM_ALIGNMENT;
+
+    while ( ( l_offset + sizeof( frameStreamRecordHeader_t ) ) <= m_memorySize ) {
+        const frameStreamRecordHeader_t* l_header = reinterpret_cast< const frameStreamRecordHeader_t* >( m_memory + l_offset );
+
+        if ( ( l_header->size < sizeof( frameStreamRecordHeader_t ) ) || ( ( l_offset + l_header->size ) > m_memorySize ) ) {
+            break;
+        }
+
+        if ( l_header->type == FRAME_RECORD ) {
+            m_frames.push_back( { l_offset, 0 } );
+
+        } else if ( ( l_header->type == RESULTS_RECORD ) && !m_frames.empty() ) {
+            m_frames.back().second = l_offset;
+        }
+
+        l_offset += l_header->size;
+    }
+    /// @endcode
+    //! <b>[index]</b>
+}
+
+frameReplay_t::~frameReplay_t( void ) {
+    munmap( const_cast< uint8_t* >( m_memory ), m_memorySize );
+    close( m_descriptor );
+}
+
+std::chrono::nanoseconds frameReplay_t::read( size_t _index, cv::Mat& _frame ) const {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    const frameStreamRecordHeader_t* l_header = reinterpret_cast< const frameStreamRecordHeader_t* >(
+        m_memory + m_frames.at( _index ).first
+    );
+    const uint8_t* l_data = (
+        reinterpret_cast< const uint8_t* >( l_header ) + alignFrameStream( sizeof( frameStreamRecordHeader_t ) )
+    );
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[check]</b>
+    /// Data must fit record, raw frame must be exactly its planes.
+    /// @code{.cpp}
+    bool l_isValid = (
+        ( alignFrameStream( sizeof( frameStreamRecordHeader_t ) ) + l_header->dataSize ) <= l_header->size
+    );
+
+    if ( l_isValid && ( l_header->compression == RAW_FRAME ) ) {
+        l_isValid = (
+            ( l_header->rows > 0 ) &&
+            ( l_header->cols > 0 ) &&
+            ( l_header->matType == CV_MAT_TYPE( l_header->matType ) ) &&
+            (
+                ( static_cast< uint64_t >( l_header->rows ) * l_header->cols * CV_ELEM_SIZE( l_header->matType ) ) ==
+                l_header->dataSize
+            )
+        );
+
+    } else if ( l_isValid ) {
+        l_isValid = ( l_header->compression == PNG_FRAME );
+    }
+
+    if ( !l_isValid ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Frame record {} is corrupted",
+                _index
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[decode]</b>
+    /// Raw frame is used in place.
+    /// @code{.cpp}
+    if ( l_header->compression == PNG_FRAME ) {
+        _frame = cv::imdecode(
+            cv::Mat( 1, l_header->dataSize, CV_8UC1, const_cast< uint8_t* >( l_data ) ),
+            cv::IMREAD_UNCHANGED
+        );
+
+        if ( _frame.empty() ) {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "Frame record {} can't be decoded",
+                    _index
+                )
+            );
+        }
+
+    } else {
+        _frame = cv::Mat(
+            l_header->rows,
+            l_header->cols,
+            l_header->matType,
+            const_cast< uint8_t* >( l_data )
+        );
+    }
+    /// @endcode
+    //! <b>[decode]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( std::chrono::nanoseconds( l_header->timestamp ) );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+std::vector< matchResult_t > frameReplay_t::results( size_t _index ) const {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    std::vector< matchResult_t > l_results;
+    const size_t                 l_offset = m_frames.at( _index ).second;
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[convert]</b>
+    /// @code{.cpp}
+    if ( l_offset ) {
+        const frameStreamRecordHeader_t* l_header = reinterpret_cast< const frameStreamRecordHeader_t* >( m_memory + l_offset );
+        const frameStreamResult_t*       l_data   = reinterpret_cast< const frameStreamResult_t* >(
+            reinterpret_cast< const uint8_t* >( l_header ) + alignFrameStream( sizeof( frameStreamRecordHeader_t ) )
+        );
+
+        if (
+            ( l_header->rows < 0 ) ||
+            ( ( static_cast< uint64_t >( l_header->rows ) * sizeof( frameStreamResult_t ) ) != l_header->dataSize ) ||
+            ( ( alignFrameStream( sizeof( frameStreamRecordHeader_t ) ) + l_header->dataSize ) > l_header->size )
+        ) {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "Results record of frame {} is corrupted",
+                    _index
+                )
+            );
+        }
+
+        for ( int32_t _templateId = 0; _templateId < l_header->rows; _templateId++ ) {
+            l_results.push_back( {
+                l_data[ _templateId ].x,
+                l_data[ _templateId ].y,
+                l_data[ _templateId ].score,
+                l_data[ _templateId ].frame,
+                ( l_data[ _templateId ].found != 0 )
+            } );
+        }
+    }
+    /// @endcode
+    //! <b>[convert]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_results );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+#else // _WIN32
+
+frameRecorder_t::frameRecorder_t( const std::string& _path, bool _isCompressed ) {
+    throw std::ios_base::failure( "Frame stream is not supported" );
+}
+
+frameRecorder_t::~frameRecorder_t( void ) {}
+
+void frameRecorder_t::recordFrame( const cv::Mat& _frame ) {}
+
+void frameRecorder_t::recordResults( const std::vector< matchResult_t >& _results ) {}
+
+frameReplay_t::frameReplay_t( const std::string& _path ) {
+    throw std::ios_base::failure( "Frame stream is not supported" );
+}
+
+frameReplay_t::~frameReplay_t( void ) {}
+
+std::chrono::nanoseconds frameReplay_t::read( size_t _index, cv::Mat& _frame ) const {
+    return ( std::chrono::nanoseconds( 0 ) );
+}
+
+std::vector< matchResult_t > frameReplay_t::results( size_t _index ) const {
+    return ( std::vector< matchResult_t >() );
+}
+
+#endif // _WIN32
+
+matchingSession_t::matchingSession_t(
+    uint32_t _matchMethod,
+    size_t   _threadsCount
+) : m_matchMethod( _matchMethod ),
+    m_scoreThreshold( std::nan( "" ) ),
+    m_threadPool( _threadsCount ),
+    m_resultDisplay( new resultDisplay_t ),
+    m_incrementalMatcher( new incrementalMatcher_t ),
+    m_latencies( new latencyHistogram_t ) {}
+
+matchingSession_t::~matchingSession_t( void ) {
+    stop();
+}
+
+size_t matchingSession_t::addTemplate( const std::string& _templateImage ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    //! <b>[load_template]</b>
+    /// Load now, so first frame doesn't pay for it.
+    /// @code{.cpp}
+    getTemplateImage( _templateImage );
+
+    if ( m_matchMethod == FEATURE_MATCH_METHOD ) {
+        getTemplateFeatures( _templateImage );
+    }
+    /// @endcode
+    //! <b>[load_template]</b>
+
+    //! <b>[add]</b>
+    /// @code{.cpp}
+    m_templateImages.push_back( _templateImage );
+    m_templateStates.emplace_back();
+    m_results.resize( m_templateImages.size() );
+    /// @endcode
+    //! <b>[add]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( m_templateImages.size() - 1 );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+void matchingSession_t::setIncremental( bool _isIncremental ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_incrementalMatcher.reset( _isIncremental ? new incrementalMatcher_t : NULL );
+}
+
+void matchingSession_t::setTuningProfile( const std::string& _path ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    //! <b>[reset]</b>
+    /// @code{.cpp}
+    m_tuningProfile = _path;
+    m_tunedSize     = cv::Size();
+    m_profileSize   = cv::Size();
+
+    m_templateTunings.clear();
+    m_strategies.clear();
+    m_profileTunings.clear();
+
+    if ( _path.empty() || !std::filesystem::exists( _path ) ) {
+        return;
+    }
+    /// @endcode
+    //! <b>[reset]</b>
+
+    //! <b>[load]</b>
+    /// Profile of other version or comparison method is ignored and overwritten by next tuning.
+    /// @code{.cpp}
+    cv::FileStorage l_storage( _path, cv::FileStorage::READ );
+
+    if ( !l_storage.isOpened() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't read tuning profile {}",
+                _path
+            )
+        );
+    }
+
+    if (
+        ( static_cast< int >( l_storage[ "version" ] ) != TUNING_PROFILE_VERSION ) ||
+        ( static_cast< int >( l_storage[ "method" ] ) != static_cast< int >( m_matchMethod ) )
+    ) {
+        return;
+    }
+
+    m_profileSize = cv::Size( static_cast< int >( l_storage[ "width" ] ), static_cast< int >( l_storage[ "height" ] ) );
+
+    for ( const cv::FileNode _template : l_storage[ "templates" ] ) {
+        const std::string l_strategyName = static_cast< std::string >( _template[ "strategy" ] );
+        templateTuning_t  l_tuning;
+
+        l_tuning.cost = std::chrono::nanoseconds( static_cast< int64_t >( static_cast< double >( _template[ "cost" ] ) * 1000 ) );
+        l_tuning.hash = std::strtoull( static_cast< std::string >( _template[ "hash" ] ).c_str(), NULL, 16 );
+
+        while ( ( l_tuning.strategy < MATCH_STRATEGY_COUNT ) && ( l_strategyName != matchStrategyName( l_tuning.strategy ) ) ) {
+            l_tuning.strategy = static_cast< matchStrategy_t >( l_tuning.strategy + 1 );
+        }
+
+        if ( l_tuning.strategy < MATCH_STRATEGY_COUNT ) {
+            m_profileTunings[ static_cast< std::string >( _template[ "path" ] ) ] = l_tuning;
+        }
+    }
+    /// @endcode
+    //! <b>[load]</b>
+}
+
+std::vector< templateTuning_t > matchingSession_t::templateTunings( void ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    std::vector< templateTuning_t > l_templateTunings = m_templateTunings;
+
+    l_templateTunings.resize( m_templateImages.size() );
+
+    return ( l_templateTunings );
+}
+
+///////////////
+/// @brief Tune templates not tuned for frame size yet, taking them from profile if it has them.
+/// @details Called under session lock. Throws ios_base::failure at error.
+/// @param[in] _frame Frame to tune on.
+/// @return Strategies indexed by template ID, \c NULL without tuning.
+///////////////
+const std::vector< matchStrategy_t >* matchingSession_t::tune( const cv::Mat& _frame ) {
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    if ( m_tuningProfile.empty() || ( m_matchMethod == FEATURE_MATCH_METHOD ) ) {
+        return ( NULL );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[reset]</b>
+    /// New frame size drops every tuning.
+    /// @code{.cpp}
+    if ( _frame.size() != m_tunedSize ) {
+        m_tunedSize = _frame.size();
+
+        m_templateTunings.assign( m_templateImages.size(), templateTuning_t() );
+    }
+
+    m_templateTunings.resize( m_templateImages.size() );
+    /// @endcode
+    //! <b>[reset]</b>
+
+    //! <b>[profile]</b>
+    /// Template of the same pixels and frame size is taken from profile.
+    /// @code{.cpp}
+    std::vector< size_t >   l_templateIds;
+    std::vector< uint64_t > l_hashes;
+
+    for ( size_t _templateId = 0; _templateId < m_templateImages.size(); _templateId++ ) {
+        if ( m_templateTunings[ _templateId ].hash ) {
+            continue;
+        }
+
+        const cv::Mat& l_templateImage = getTemplateImage( m_templateImages[ _templateId ] );
+        const uint64_t l_hash          = hashTile( l_templateImage, cv::Rect( 0, 0, l_templateImage.cols, l_templateImage.rows ) );
+        auto           l_profileTuning = m_profileTunings.find( m_templateImages[ _templateId ] );
+
+        if (
+            ( m_profileSize == m_tunedSize ) &&
+            ( l_profileTuning != m_profileTunings.end() ) &&
+            ( l_profileTuning->second.hash == l_hash )
+        ) {
+            m_templateTunings[ _templateId ] = l_profileTuning->second;
+
+        } else {
+            l_templateIds.push_back( _templateId );
+            l_hashes.push_back( l_hash );
+        }
+    }
+    /// @endcode
+    //! <b>[profile]</b>
+
+    if ( !l_templateIds.empty() ) {
+        //! <b>[conversions]</b>
+        /// Frame conversions are shared by all templates, every template pays its share.
+        /// @code{.cpp}
+        std::array< std::chrono::nanoseconds, MATCH_STRATEGY_COUNT > l_conversionCosts;
+
+        for ( uint32_t _strategy = 0; _strategy < MATCH_STRATEGY_COUNT; _strategy++ ) {
+            l_conversionCosts[ _strategy ] = std::chrono::nanoseconds::max();
+
+            for ( uint32_t _iteration = 0; _iteration < TUNE_ITERATIONS; _iteration++ ) {
+                const std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+                strategyFrames_t                            l_strategyFrames;
+
+                prepareStrategyFrames(
+                    _frame,
+                    ( _strategy == MATCH_STRATEGY_GRAY ),
+                    ( _strategy == MATCH_STRATEGY_PYRAMID ),
+                    ( _strategy == MATCH_STRATEGY_GRAY_PYRAMID ),
+                    m_matPool,
+                    l_strategyFrames
+                );
+
+                l_conversionCosts[ _strategy ] = std::min< std::chrono::nanoseconds >(
+                    l_conversionCosts[ _strategy ],
+                    ( std::chrono::steady_clock::now() - l_start )
+                );
+            }
+
+            l_conversionCosts[ _strategy ] /= m_templateImages.size();
+        }
+        /// @endcode
+        //! <b>[conversions]</b>
+
+        //! <b>[tune]</b>
+        /// Templates are timed one after another on this thread, so they don't compete for cores.
+        /// @code{.cpp}
+        strategyFrames_t l_strategyFrames;
+
+        prepareStrategyFrames( _frame, true, true, true, m_matPool, l_strategyFrames );
+
+        for ( size_t _index = 0; _index < l_templateIds.size(); _index++ ) {
+            templateTuning_t& l_tuning = m_templateTunings[ l_templateIds[ _index ] ];
+
+            l_tuning = tuneTemplate(
+                m_matchMethod,
+                l_strategyFrames,
+                l_conversionCosts,
+                m_templateImages[ l_templateIds[ _index ] ],
+                m_matPool
+            );
+            l_tuning.hash = l_hashes[ _index ];
+        }
+
+        saveTuningProfile();
+        /// @endcode
+        //! <b>[tune]</b>
+    }
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    m_strategies.resize( m_templateTunings.size() );
+
+    for ( size_t _templateId = 0; _templateId < m_templateTunings.size(); _templateId++ ) {
+        m_strategies[ _templateId ] = m_templateTunings[ _templateId ].strategy;
+    }
+
+    return ( &m_strategies );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Merge tunings into profile and write it.
+/// @details Profile keeps templates of other sessions tuned on the same frame size.
+/// Throws ios_base::failure at error.
+///////////////
+void matchingSession_t::saveTuningProfile( void ) {
+    //! <b>[merge]</b>
+    /// @code{.cpp}
+    if ( m_profileSize != m_tunedSize ) {
+        m_profileSize = m_tunedSize;
+
+        m_profileTunings.clear();
+    }
+
+    for ( size_t _templateId = 0; _templateId < m_templateTunings.size(); _templateId++ ) {
+        m_profileTunings[ m_templateImages[ _templateId ] ] = m_templateTunings[ _templateId ];
+    }
+    /// @endcode
+    //! <b>[merge]</b>
+
+    //! <b>[write]</b>
+    /// Costs are in microseconds.
+    /// @code{.cpp}
+    cv::FileStorage l_storage( m_tuningProfile, ( cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON ) );
+
+    if ( !l_storage.isOpened() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't write tuning profile {}",
+                m_tuningProfile
+            )
+        );
+    }
+
+    l_storage << "version" << TUNING_PROFILE_VERSION
+        << "method" << static_cast< int >( m_matchMethod )
+        << "width" << m_profileSize.width
+        << "height" << m_profileSize.height
+        << "templates" << "[";
+
+    for ( const std::pair< const std::string, templateTuning_t >& _profileTuning : m_profileTunings ) {
+        l_storage << "{"
+            << "path" << _profileTuning.first
+            << "hash" << fmt::format( "{:016x}", _profileTuning.second.hash )
+            << "strategy" << matchStrategyName( _profileTuning.second.strategy )
+            << "cost" << ( _profileTuning.second.cost.count() / 1000.0 )
+            << "}";
+    }
+
+    l_storage << "]";
+    /// @endcode
+    //! <b>[write]</b>
+}
+
+void matchingSession_t::setWindow( const std::string& _windowName ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_windowCapture.reset( new windowCapture_t(
+        _windowName,
+        ( m_targetWindows.empty() ? NULL : m_targetWindows.front().capture.get() )
+    ) );
+    m_frameRingReader.reset();
+    m_windowName = _windowName;
+}
+
+void matchingSession_t::setCaptureScale( uint32_t _downscale ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    if ( !_downscale ) {
+        throw std::ios_base::failure( "Capture scale must be at least 1" );
+    }
+
+    m_captureScale = _downscale;
+}
+
+size_t matchingSession_t::addWindow( const std::string& _windowName, const std::vector< size_t >& _templateIds ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    for ( const size_t _templateId : _templateIds ) {
+        if ( _templateId >= m_templateImages.size() ) {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "Wrong template ID {}",
+                    _templateId
+                )
+            );
+        }
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[capture]</b>
+    /// Display connection of session is opened by first window.
+    /// @code{.cpp}
+    const windowCapture_t* l_sharedCapture = (
+        m_windowCapture
+        ? m_windowCapture.get()
+        : ( m_targetWindows.empty() ? NULL : m_targetWindows.front().capture.get() )
+    );
+
+    std::unique_ptr< windowCapture_t > l_capture( new windowCapture_t( _windowName, l_sharedCapture ) );
+    /// @endcode
+    //! <b>[capture]</b>
+
+    //! <b>[add]</b>
+    /// Templates are paths into process template cache, subset doesn't load them again.
+    /// @code{.cpp}
+    targetWindow_t& l_targetWindow = m_targetWindows.emplace_back();
+
+    l_targetWindow.capture = std::move( l_capture );
+
+    for ( size_t _templateId = 0; _templateId < m_templateImages.size(); _templateId++ ) {
+        if ( _templateIds.empty() || ( std::find( _templateIds.begin(), _templateIds.end(), _templateId ) != _templateIds.end() ) ) {
+            l_targetWindow.templateIds.push_back( _templateId );
+            l_targetWindow.templateImages.push_back( m_templateImages[ _templateId ] );
+        }
+    }
+
+    l_targetWindow.results.resize( l_targetWindow.templateIds.size() );
+    /// @endcode
+    //! <b>[add]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( m_targetWindows.size() - 1 );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+void matchingSession_t::setRecorder( const std::string& _path, bool _isCompressed ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_frameRecorder.reset( _path.empty() ? NULL : new frameRecorder_t( _path, _isCompressed ) );
+}
+
+void matchingSession_t::setReplay( const std::string& _path, bool _isRealTime ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_frameReplay.reset( new frameReplay_t( _path ) );
+    m_replayIndex      = 0;
+    m_isReplayRealTime = _isRealTime;
+    m_recordedResults.clear();
+}
+
+bool matchingSession_t::isReplayFinished( void ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    return ( m_frameReplay && ( m_replayIndex >= m_frameReplay->size() ) );
+}
+
+std::vector< matchResult_t > matchingSession_t::recordedResults( void ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    return ( m_recordedResults );
+}
+
+bool matchingSession_t::replayFrame( cv::Mat& _frame ) {
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    if ( m_replayIndex >= m_frameReplay->size() ) {
+        return ( false );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[read]</b>
+    /// @code{.cpp}
+    const std::chrono::nanoseconds l_timestamp = m_frameReplay->read( m_replayIndex, _frame );
+
+    m_recordedResults = m_frameReplay->results( m_replayIndex );
+    /// @endcode
+    //! <b>[read]</b>
+
+    //! <b>[pace]</b>
+    /// Recorded timing is kept relative to first replayed frame.
+    /// @code{.cpp}
+    if ( m_isReplayRealTime ) {
+        if ( !m_replayIndex ) {
+            m_replayStart = ( std::chrono::steady_clock::now() - l_timestamp );
+
+        } else {
+            std::this_thread::sleep_until( m_replayStart + l_timestamp );
+        }
+    }
+
+    m_replayIndex++;
+    /// @endcode
+    //! <b>[pace]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( true );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+void matchingSession_t::setFrameRing( const std::string& _ringName, bool _isFileBacked ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_frameRingReader.reset( new frameRingReader_t( _ringName, _isFileBacked ) );
+    m_frameSequence = 0;
+}
+
+std::vector< matchResult_t > matchingSession_t::matchImage( const cv::Mat& _image, bool _isRgb ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    //! <b>[match]</b>
+    /// Outlines are collected only if result is shown.
+    /// Only scheduled templates are matched if scheduling is enabled.
+    /// Templates are tuned on first image of each size if tuning profile is set.
+    /// @code{.cpp}
+    outlines_t          l_outlines;
+    templateSelection_t l_selection;
+    const bool          l_isScheduled = schedule( l_selection );
+
+    if ( !l_isScheduled || !l_selection.templateIds.empty() ) {
+        matchTemplates(
+            m_matchMethod,
+            _image,
+            m_templateImages,
+            m_results,
+            m_matPool,
+            m_threadPool,
+            ( m_showResult ? &l_outlines : NULL ),
+            ( l_isScheduled ? &l_selection : NULL ),
+            NULL,
+            tune( _image )
+        );
+    }
+
+    if ( l_isScheduled ) {
+        reschedule( l_selection );
+    }
+    /// @endcode
+    //! <b>[match]</b>
+
+    //! <b>[imshow]</b>
+    /// Show me what you got.
+    /// @code{.cpp}
+    if ( m_showResult ) {
+        matPool_t::lease_t l_imageDisplay = m_matPool.acquire( _image.rows, _image.cols, _image.type() );
+
+        _image.copyTo( *l_imageDisplay );
+
+        m_resultDisplay->show(
+            std::move( l_imageDisplay ),
+            std::move( l_outlines ),
+            _isRgb
+        );
+    }
+    /// @endcode
+    //! <b>[imshow]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( m_results.snapshot() );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+std::vector< matchResult_t > matchingSession_t::matchFile( const std::string& _sourceImage ) {
+    //! <b>[load_image]</b>
+    /// Load image, repeated samples are taken decoded from cache.
+    /// @code{.cpp}
+    const cv::Mat l_image = getImageCache().get( _sourceImage );
+    /// @endcode
+    //! <b>[load_image]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( matchImage( l_image ) );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+std::vector< matchResult_t > matchingSession_t::matchWindow( void ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    if ( !m_windowCapture && !m_frameRingReader && !m_frameReplay ) {
+        throw std::ios_base::failure( "No window to capture" );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[load_image]</b>
+    /// Get recorded frame, newest frame of ring or window capture. Ring and raw recorded frames are used in place.
+    /// Frame age counts from ring publish or capture start, recorded frames are never late.
+    /// @code{.cpp}
+    matPool_t::lease_t                    l_image;
+    cv::Mat                               l_frame;
+    uint64_t                              l_frameSequence = 0;
+    std::chrono::steady_clock::time_point l_frameTime     = std::chrono::steady_clock::now();
+
+    if ( m_frameReplay ) {
+        if ( !replayFrame( l_frame ) ) {
+            return ( m_results.snapshot() );
+        }
+
+    } else if ( m_frameRingReader ) {
+        l_frameSequence = m_frameRingReader->read( m_frameSequence, l_frame, &l_frameTime );
+
+        if ( !l_frameSequence ) {
+            return ( m_results.snapshot() );
+        }
+
+        m_frameSequence = l_frameSequence;
+
+    } else {
+        m_windowCapture->capture( m_matPool, l_image, 0, 0, m_captureScale );
+
+        l_frame = *l_image;
+    }
+
+    getMetrics().framesCaptured.fetch_add( 1, std::memory_order_relaxed );
+    /// @endcode
+    //! <b>[load_image]</b>
+
+    //! <b>[drop]</b>
+    /// Ring frame already so old that expected matching time takes it past latency target is dropped,
+    /// newer one is published behind it. Captured frame is as fresh as it gets, so it is always matched.
+    /// Frames matched slower than target are matched anyway, dropping them all would leave no results.
+    /// After \c LOW_LATENCY_MAXIMUM_DROPS drops in a row a frame is matched, so expected matching time keeps following.
+    /// @code{.cpp}
+    const std::chrono::nanoseconds              l_latencyTarget = std::chrono::duration_cast< std::chrono::nanoseconds >( m_lowLatency.latencyTarget );
+    const std::chrono::steady_clock::time_point l_matchStart    = std::chrono::steady_clock::now();
+
+    if (
+        m_frameRingReader &&
+        !m_frameReplay &&
+        ( l_latencyTarget.count() > 0 ) &&
+        ( m_matchTime <= l_latencyTarget ) &&
+        ( m_droppedInRowCount < LOW_LATENCY_MAXIMUM_DROPS ) &&
+        ( ( ( l_matchStart - l_frameTime ) + m_matchTime ) > l_latencyTarget )
+    ) {
+        m_droppedInRowCount++;
+        m_droppedFramesCount.fetch_add( 1, std::memory_order_relaxed );
+        getMetrics().framesSkipped.fetch_add( 1, std::memory_order_relaxed );
+
+        return ( m_results.snapshot() );
+    }
+
+    m_droppedInRowCount = 0;
+    /// @endcode
+    //! <b>[drop]</b>
+
+    //! <b>[match]</b>
+    /// Outlines are collected only if result is shown.
+    /// @code{.cpp}
+    outlines_t l_outlines;
+    const bool l_isChanged = matchFrame(
+        l_frame,
+        ( m_showResult ? &l_outlines : NULL ),
+        ( m_frameRingReader ? 1 : m_captureScale )
+    );
+    /// @endcode
+    //! <b>[match]</b>
+
+    //! <b>[latency]</b>
+    /// Expected matching time follows recent frames.
+    /// @code{.cpp}
+    const std::chrono::steady_clock::time_point l_resultTime = std::chrono::steady_clock::now();
+
+    m_latencies->record( l_resultTime - l_frameTime );
+
+    m_matchTime += std::chrono::duration_cast< std::chrono::nanoseconds >(
+        ( ( l_resultTime - l_matchStart ) - m_matchTime ) / FRAME_TIME_SMOOTHING
+    );
+    /// @endcode
+    //! <b>[latency]</b>
+
+    //! <b>[check_frame]</b>
+    /// Ring frame overwritten while it was matched gave results of torn frame.
+    /// @code{.cpp}
+    if ( l_frameSequence && !m_frameRingReader->isValid( l_frameSequence ) ) {
+        fmt::print( stderr, "Frame {} was overwritten while matched, frame ring is too small\n", l_frameSequence );
+    }
+    /// @endcode
+    //! <b>[check_frame]</b>
+
+    //! <b>[record]</b>
+    /// @code{.cpp}
+    if ( m_frameRecorder ) {
+        m_frameRecorder->recordFrame( l_frame );
+        m_frameRecorder->recordResults( m_results.snapshot() );
+    }
+    /// @endcode
+    //! <b>[record]</b>
+
+    //! <b>[imshow]</b>
+    /// Capture is not needed anymore, so it is handed over without copy. Ring and recorded frames are copied.
     /// @code{.cpp}
-    if (
-        XQueryTree(
-            _display,
-            _window,
-            &l_root,
-            &l_parent,
-            &l_children,
-            &l_childrenCount
-        )
-    ) {
-        for (
-            uint32_t _childrenIndex = 0;
-            _childrenIndex < l_childrenCount;
-            ++_childrenIndex
+    if ( m_showResult && l_isChanged ) {
+        if ( l_image->empty() ) {
+            l_image = m_matPool.acquire( l_frame.rows, l_frame.cols, l_frame.type() );
+
+            l_frame.copyTo( *l_image );
+        }
+
+        m_resultDisplay->show(
+            std::move( l_image ),
+            std::move( l_outlines ),
+            true
+        );
+    }
+    /// @endcode
+    //! <b>[imshow]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( m_results.snapshot() );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+std::vector< windowResult_t > matchingSession_t::matchWindows( void ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    if ( m_targetWindows.empty() ) {
+        throw std::ios_base::failure( "No windows to capture, add them with addWindow" );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[capture]</b>
+    /// Captures go back to back over shared connection, before any matching takes cores.
+    /// @code{.cpp}
+    std::vector< matPool_t::lease_t > l_images( m_targetWindows.size() );
+
+    for ( size_t _windowId = 0; _windowId < m_targetWindows.size(); _windowId++ ) {
+        m_targetWindows[ _windowId ].capture->capture( m_matPool, l_images[ _windowId ], 0, 0, m_captureScale );
+    }
+
+    getMetrics().framesCaptured.fetch_add( m_targetWindows.size(), std::memory_order_relaxed );
+    /// @endcode
+    //! <b>[capture]</b>
+
+    //! <b>[match]</b>
+    /// Unchanged window keeps results of its previous frame.
+    /// @code{.cpp}
+    auto matchTargetWindow = [ & ]( size_t _windowId ) {
+        targetWindow_t& l_targetWindow = m_targetWindows[ _windowId ];
+
+        if ( !m_incrementalMatcher ) {
+            l_targetWindow.incrementalMatcher.reset();
+
+        } else if ( !l_targetWindow.incrementalMatcher ) {
+            l_targetWindow.incrementalMatcher.reset( new incrementalMatcher_t );
+        }
+
+        if (
+            l_targetWindow.incrementalMatcher &&
+            !l_targetWindow.incrementalMatcher->detect( *l_images[ _windowId ], l_targetWindow.templateImages.size() )
         ) {
-            l_window = windowSearch( _display, l_children[ _childrenIndex ], _windowNameRegExp );
+            return;
+        }
 
-            if ( l_window ) {
-                break;
+        matchTemplates(
+            m_matchMethod,
+            *l_images[ _windowId ],
+            l_targetWindow.templateImages,
+            l_targetWindow.results,
+            m_matPool,
+            m_threadPool,
+            NULL,
+            NULL,
+            l_targetWindow.incrementalMatcher.get(),
+            NULL,
+            m_captureScale
+        );
+    };
+    /// @endcode
+    //! <b>[match]</b>
+
+    //! <b>[interleave]</b>
+    /// Many windows take one thread each, templates of window nested in pool run inline.
+    /// Few windows spread their templates over all threads one after another.
+    /// @code{.cpp}
+    if ( m_targetWindows.size() >= m_threadPool.size() ) {
+        m_threadPool.parallelFor( m_targetWindows.size(), matchTargetWindow );
+
+    } else {
+        for ( size_t _windowId = 0; _windowId < m_targetWindows.size(); _windowId++ ) {
+            matchTargetWindow( _windowId );
+        }
+    }
+    /// @endcode
+    //! <b>[interleave]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    std::vector< windowResult_t > l_windowResults;
+
+    for ( size_t _windowId = 0; _windowId < m_targetWindows.size(); _windowId++ ) {
+        const std::vector< matchResult_t > l_results = m_targetWindows[ _windowId ].results.snapshot();
+
+        for ( size_t _index = 0; _index < l_results.size(); _index++ ) {
+            l_windowResults.push_back( { _windowId, m_targetWindows[ _windowId ].templateIds[ _index ], l_results[ _index ] } );
+        }
+    }
+
+    return ( l_windowResults );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+bool matchingSession_t::matchFrame( const cv::Mat& _frame, outlines_t* _outlines, uint32_t _downscale ) {
+    //! <b>[detect_changes]</b>
+    /// Unchanged frame costs only hashing, results of previous frame stay.
+    /// @code{.cpp}
+    const bool l_isChanged = (
+        !m_incrementalMatcher ||
+        m_incrementalMatcher->detect( _frame, m_templateImages.size() )
+    );
+    /// @endcode
+    //! <b>[detect_changes]</b>
+
+    //! <b>[match]</b>
+    /// Only scheduled templates are matched if scheduling is enabled.
+    /// @code{.cpp}
+    templateSelection_t l_selection;
+    const bool          l_isScheduled = schedule( l_selection );
+
+    if ( !l_isChanged ) {
+        l_selection.templateIds.clear();
+
+    } else if ( !l_isScheduled || !l_selection.templateIds.empty() ) {
+        matchTemplates(
+            m_matchMethod,
+            _frame,
+            m_templateImages,
+            m_results,
+            m_matPool,
+            m_threadPool,
+            _outlines,
+            ( l_isScheduled ? &l_selection : NULL ),
+            m_incrementalMatcher.get(),
+            ( ( _downscale == 1 ) ? tune( _frame ) : NULL ),
+            _downscale
+        );
+    }
+
+    if ( l_isScheduled ) {
+        reschedule( l_selection );
+    }
+    /// @endcode
+    //! <b>[match]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_isChanged );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+streamStatistics_t matchingSession_t::matchStream(
+    const std::string& _source,
+    const std::string& _outputPath,
+    const std::string& _extension
+) {
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    streamStatistics_t         l_statistics;
+    std::vector< std::string > l_templateImages;
+    cv::Mat                    l_frame;
+    std::string                l_frameName;
+    const bool                 l_isJson = (
+        ( _outputPath.size() >= 5 ) &&
+        ( _outputPath.compare( _outputPath.size() - 5, 5, ".json" ) == 0 )
+    );
+
+    auto escapeJson = []( const std::string& _text ) {
+        std::string l_text;
+
+        for ( const char _character : _text ) {
+            if ( ( _character == '"' ) || ( _character == '\\' ) ) {
+                l_text += '\\';
+                l_text += _character;
+
+            } else if ( static_cast< unsigned char >( _character ) < 0x20 ) {
+                l_text += fmt::format( "\\u{:04x}", static_cast< int >( _character ) );
+
+            } else {
+                l_text += _character;
             }
         }
 
-        XFree( l_children );
+        return ( l_text );
+    };
+
+    auto quoteCsv = []( const std::string& _text ) {
+        std::string l_text = "\"";
+
+        for ( const char _character : _text ) {
+            if ( _character == '"' ) {
+                l_text += '"';
+            }
+
+            l_text += _character;
+        }
+
+        return ( l_text + "\"" );
+    };
+
+    double l_scoreThreshold;
+
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        l_templateImages = m_templateImages;
+        l_scoreThreshold = m_scoreThreshold;
+    }
+    /// @endcode
+    //! <b>[declare]</b>
+
+    //! <b>[threshold]</b>
+    /// Best location is found for every template, only scores past threshold are detections.
+    /// Feature matching finds template only with enough inliers, inliers count is its score.
+    /// @code{.cpp}
+    const bool l_isSquaredDifference = ( ( m_matchMethod == cv::TM_SQDIFF ) || ( m_matchMethod == cv::TM_SQDIFF_NORMED ) );
+
+    if ( std::isnan( l_scoreThreshold ) ) {
+        if ( m_matchMethod == cv::TM_SQDIFF_NORMED ) {
+            l_scoreThreshold = SQDIFF_NORMED_THRESHOLD;
+
+        } else if ( m_matchMethod == cv::TM_CCORR_NORMED ) {
+            l_scoreThreshold = CCORR_NORMED_THRESHOLD;
+
+        } else if ( m_matchMethod == cv::TM_CCOEFF_NORMED ) {
+            l_scoreThreshold = CCOEFF_NORMED_THRESHOLD;
+
+        } else if ( m_matchMethod == FEATURE_MATCH_METHOD ) {
+            l_scoreThreshold = FEATURE_MINIMUM_INLIERS;
+
+        } else {
+            throw std::ios_base::failure(
+                fmt::format(
+                    "Score threshold of match method {} is not set",
+                    m_matchMethod
+                )
+            );
+        }
+    }
+
+    auto isDetection = [ & ]( const matchResult_t& _result ) {
+        return (
+            _result.found &&
+            ( l_isSquaredDifference ? ( _result.score <= l_scoreThreshold ) : ( _result.score >= l_scoreThreshold ) )
+        );
+    };
+    /// @endcode
+    //! <b>[threshold]</b>
+
+    //! <b>[open]</b>
+    /// Source is opened first, so bad source leaves no empty output.
+    /// @code{.cpp}
+    frameSource_t                              l_frameSource( _source, _extension );
+    std::unique_ptr< FILE, int( * )( FILE* ) > l_output( std::fopen( _outputPath.c_str(), "w" ), std::fclose );
+
+    if ( !l_output ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't open output {}",
+                _outputPath
+            )
+        );
+    }
+
+    std::fputs( ( l_isJson ? "[\n" : "frame,source,template,x,y,score\n" ), l_output.get() );
+
+    const std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+    /// @endcode
+    //! <b>[open]</b>
+
+    while ( l_frameSource.read( l_frame, l_frameName ) ) {
+        //! <b>[match]</b>
+        /// Every frame goes through incremental matcher, so frames without changes aren't matched again.
+        /// @code{.cpp}
+        std::vector< matchResult_t > l_results;
+
+        {
+            std::lock_guard< std::mutex > l_lock( m_mutex );
+
+            matchFrame( l_frame, NULL );
+
+            l_results = m_results.snapshot();
+        }
+
+        getMetrics().framesCaptured.fetch_add( 1, std::memory_order_relaxed );
+        /// @endcode
+        //! <b>[match]</b>
+
+        //! <b>[write]</b>
+        /// JSON output is array of frames, CSV output is row per detection.
+        /// @code{.cpp}
+        if ( l_isJson ) {
+            fmt::print(
+                l_output.get(),
+                "{}{{\"frame\":{},\"source\":\"{}\",\"detections\":[",
+                ( l_statistics.framesCount ? ",\n" : "" ),
+                l_statistics.framesCount,
+                escapeJson( l_frameName )
+            );
+        }
+
+        bool l_isFirst = true;
+
+        for ( size_t _templateId = 0; _templateId < l_results.size(); _templateId++ ) {
+            const matchResult_t& l_result = l_results[ _templateId ];
+
+            if ( !isDetection( l_result ) ) {
+                continue;
+            }
+
+            if ( l_isJson ) {
+                fmt::print(
+                    l_output.get(),
+                    "{}{{\"template\":\"{}\",\"x\":{},\"y\":{},\"score\":{}}}",
+                    ( l_isFirst ? "" : "," ),
+                    escapeJson( l_templateImages[ _templateId ] ),
+                    l_result.x,
+                    l_result.y,
+                    l_result.score
+                );
+
+            } else {
+                fmt::print(
+                    l_output.get(),
+                    "{},{},{},{},{},{}\n",
+                    l_statistics.framesCount,
+                    quoteCsv( l_frameName ),
+                    quoteCsv( l_templateImages[ _templateId ] ),
+                    l_result.x,
+                    l_result.y,
+                    l_result.score
+                );
+            }
+
+            l_isFirst = false;
+            l_statistics.detectionsCount++;
+        }
+
+        if ( l_isJson ) {
+            std::fputs( "]}", l_output.get() );
+        }
+
+        l_statistics.framesCount++;
+        /// @endcode
+        //! <b>[write]</b>
+    }
+
+    //! <b>[close]</b>
+    /// @code{.cpp}
+    if ( l_isJson ) {
+        std::fputs( "\n]\n", l_output.get() );
+    }
+    /// @endcode
+    //! <b>[close]</b>
+
+    //! <b>[statistics]</b>
+    /// @code{.cpp}
+    l_statistics.seconds     = std::chrono::duration< double >( std::chrono::steady_clock::now() - l_start ).count();
+    l_statistics.waitSeconds = std::chrono::duration< double >( l_frameSource.waitTime() ).count();
+
+    if ( l_statistics.seconds > 0 ) {
+        l_statistics.framesPerSecond = ( l_statistics.framesCount / l_statistics.seconds );
+    }
+
+    if ( std::fflush( l_output.get() ) != 0 ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Can't write output {}",
+                _outputPath
+            )
+        );
     }
     /// @endcode
-    //! <b>[check_next]</b>
+    //! <b>[statistics]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_statistics );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+void matchingSession_t::addClickRule( const clickRule_t& _rule ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    if ( _rule.templateId >= m_templateImages.size() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "No template with ID {}",
+                _rule.templateId
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[add]</b>
+    /// @code{.cpp}
+    m_clickRules.push_back( _rule );
+    m_lastClicks.emplace_back();
+    /// @endcode
+    //! <b>[add]</b>
+}
+
+void matchingSession_t::setTemplateSchedule( size_t _templateId, const templateSchedule_t& _schedule ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    if ( _templateId >= m_templateImages.size() ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "No template with ID {}",
+                _templateId
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[set]</b>
+    /// @code{.cpp}
+    m_templateStates[ _templateId ].schedule = _schedule;
+    m_isScheduled                            = true;
+    /// @endcode
+    //! <b>[set]</b>
+}
+
+void matchingSession_t::setScoreThreshold( double _threshold ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_scoreThreshold = _threshold;
+}
+
+void matchingSession_t::setFrameBudget( std::chrono::microseconds _frameBudget ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_frameBudget = _frameBudget;
+    m_isScheduled = true;
+}
+
+void matchingSession_t::setLowLatency( const lowLatency_t& _lowLatency ) {
+    //! <b>[check]</b>
+    /// Run loop reads configuration without lock.
+    /// @code{.cpp}
+    if ( isRunning() ) {
+        throw std::ios_base::failure( "Low-latency mode can't change while run loop is started" );
+    }
+
+    if ( _lowLatency.latencyTarget.count() < 0 ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Wrong latency target {} us",
+                _lowLatency.latencyTarget.count()
+            )
+        );
+    }
+    /// @endcode
+    //! <b>[check]</b>
+
+    //! <b>[set]</b>
+    /// Latency target is read by matchWindow under session lock.
+    /// @code{.cpp}
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    m_lowLatency = _lowLatency;
+    /// @endcode
+    //! <b>[set]</b>
+}
+
+latencyReport_t matchingSession_t::latencyReport( void ) const {
+    //! <b>[snapshot]</b>
+    /// @code{.cpp}
+    std::vector< uint64_t > l_counts;
+    const uint64_t          l_count = m_latencies->snapshot( l_counts );
+    latencyReport_t         l_report;
+    /// @endcode
+    //! <b>[snapshot]</b>
+
+    //! <b>[report]</b>
+    /// Quantiles are bucket limits, off by less than 1/16 of value.
+    /// @code{.cpp}
+    l_report.target             = std::chrono::duration< double >( m_lowLatency.latencyTarget ).count();
+    l_report.median             = latencyHistogram_t::quantile( l_counts, l_count, 0.5 );
+    l_report.p99                = latencyHistogram_t::quantile( l_counts, l_count, 0.99 );
+    l_report.maximum            = latencyHistogram_t::quantile( l_counts, l_count, 1 );
+    l_report.framesCount        = l_count;
+    l_report.droppedFramesCount = m_droppedFramesCount.load( std::memory_order_relaxed );
+    l_report.isMet              = ( ( l_report.target > 0 ) && l_count && ( l_report.p99 <= l_report.target ) );
+    /// @endcode
+    //! <b>[report]</b>
 
     //! <b>[return]</b>
     /// End of function.
     /// @code{.cpp}
-    return ( l_window );
+    return ( l_report );
     /// @endcode
     //! <b>[return]</b>
 }
 
-///////////////
-/// @brief Get \c Window to needed window by name.
-/// @param[in] _windowName Window name.
-/// @return \c Window information.
-///////////////
-static Window getWindowByName( std::string _windowName ) {
-    //! <b>[declare]</b>
+bool matchingSession_t::schedule( templateSelection_t& _selection ) {
+    //! <b>[check]</b>
     /// @code{.cpp}
-    Display* l_display = XOpenDisplay( NULL );
-    regex_t l_windowNameRegExp;
-
-    regcomp(
-        &l_windowNameRegExp,
-        _windowName.c_str(),
-        REG_EXTENDED | REG_ICASE
-    );
+    if ( !m_isScheduled ) {
+        return ( false );
+    }
     /// @endcode
-    //! <b>[declare]</b>
+    //! <b>[check]</b>
 
-    //! <b>[search]</b>
-    /// Get \c Window by window name.
+    //! <b>[declare]</b>
     /// @code{.cpp}
-    Window l_window = windowSearch(
-        l_display,
-        XDefaultRootWindow( l_display ),
-        &l_windowNameRegExp
-    );
+    const std::chrono::steady_clock::time_point l_now = std::chrono::steady_clock::now();
+    std::vector< std::tuple< bool, double, size_t > > l_candidates; // Is overdue, urgency, template ID
+    std::chrono::nanoseconds l_spentTime( 0 );
     /// @endcode
-    //! <b>[search]</b>
+    //! <b>[declare]</b>
 
-    //! <b>[close]</b>
+    //! <b>[candidates]</b>
+    /// Template is due after its interval, that grows while template stays the same.
+    /// Urgency is priority times intervals waited, templates never matched or past deadline are overdue.
     /// @code{.cpp}
-    regfree( &l_windowNameRegExp );
-    XCloseDisplay( l_display );
+    for ( size_t _templateId = 0; _templateId < m_templateStates.size(); _templateId++ ) {
+        const templateState_t&    l_state    = m_templateStates[ _templateId ];
+        const templateSchedule_t& l_schedule = l_state.schedule;
+
+        if ( !l_state.isMatched ) {
+            l_candidates.emplace_back( true, l_schedule.priority, _templateId );
+
+            continue;
+        }
+
+        std::chrono::nanoseconds       l_interval = l_schedule.minimumInterval;
+        const std::chrono::nanoseconds l_elapsed  = ( l_now - l_state.lastMatch );
+
+        if ( l_state.backoff ) {
+            l_interval = std::max< std::chrono::nanoseconds >(
+                l_interval,
+                ( SCHEDULE_BACKOFF_INTERVAL * ( 1 << ( l_state.backoff - 1 ) ) )
+            );
+        }
+
+        if ( l_schedule.deadline.count() ) {
+            l_interval = std::min< std::chrono::nanoseconds >( l_interval, l_schedule.deadline );
+        }
+
+        if ( l_elapsed < l_interval ) {
+            continue;
+        }
+
+        l_candidates.emplace_back(
+            ( l_schedule.deadline.count() && ( l_elapsed >= l_schedule.deadline ) ),
+            (
+                l_schedule.priority *
+                (
+                    std::chrono::duration< double >( l_elapsed ) /
+                    std::max< std::chrono::nanoseconds >( l_interval, SCHEDULE_BACKOFF_INTERVAL )
+                )
+            ),
+            _templateId
+        );
+    }
+
+    std::sort( l_candidates.begin(), l_candidates.end(), std::greater<>() );
     /// @endcode
-    //! <b>[close]</b>
+    //! <b>[candidates]</b>
 
-    //! <b>[error]</b>
+    //! <b>[select]</b>
+    /// Most urgent templates are taken while their average matching time fits into budget,
+    /// overdue ones are taken anyway.
     /// @code{.cpp}
-    if ( !l_window ) {
-        fmt::print(
-            stderr,
-            "Window search failed: {}\n",
-            _windowName
-        );
+    for ( const std::tuple< bool, double, size_t >& _candidate : l_candidates ) {
+        const size_t                   l_templateId = std::get< 2 >( _candidate );
+        const std::chrono::nanoseconds l_cost       = m_templateStates[ l_templateId ].cost;
+
+        if (
+            !std::get< 0 >( _candidate ) &&
+            m_frameBudget.count() &&
+            !_selection.templateIds.empty() &&
+            ( ( l_spentTime + l_cost ) > m_frameBudget )
+        ) {
+            continue;
+        }
+
+        _selection.templateIds.push_back( l_templateId );
+        l_spentTime += l_cost;
     }
     /// @endcode
-    //! <b>[error]</b>
+    //! <b>[select]</b>
 
     //! <b>[return]</b>
     /// End of function.
     /// @code{.cpp}
-    return ( l_window );
+    return ( true );
     /// @endcode
     //! <b>[return]</b>
 }
 
-///////////////
-/// @brief Get \c cv::Mat object from window capture.
-/// @details Capture width and height should be less or equal to window's.
-/// @param[in] _sourceWindowName Window handle.
-/// @param[in] _captureWidth Capture width. Optional.
-/// @param[in] _captureHeight Capture height. Optional.
-/// @return Window capture.
-///////////////
-static cv::Mat getMatFromWindow(
-    const std::string& _sourceWindowName,
-    uint32_t           _captureWidth  = 0,
-    uint32_t           _captureHeight = 0
-) {
+void matchingSession_t::reschedule( const templateSelection_t& _selection ) {
     //! <b>[declare]</b>
     /// @code{.cpp}
-    Display*          l_display = XOpenDisplay( NULL );
-    Window            l_window  = getWindowByName( _sourceWindowName );
-    XWindowAttributes l_windowAttributes;
+    const std::chrono::steady_clock::time_point l_now = std::chrono::steady_clock::now();
+    /// @endcode
+    //! <b>[declare]</b>
 
-    XGetWindowAttributes(
-        l_display,
-        l_window,
-        &l_windowAttributes
-    );
+    //! <b>[update]</b>
+    /// Average cost over last matches, back off templates not found or not moved.
+    /// @code{.cpp}
+    for ( size_t _selectionIndex = 0; _selectionIndex < _selection.templateIds.size(); _selectionIndex++ ) {
+        const size_t                   l_templateId = _selection.templateIds[ _selectionIndex ];
+        const std::chrono::nanoseconds l_duration   = _selection.durations[ _selectionIndex ];
+        const matchResult_t            l_result     = m_results.read( l_templateId );
+        templateState_t&               l_state      = m_templateStates[ l_templateId ];
+
+        l_state.cost = (
+            l_state.isMatched
+            ? ( ( ( l_state.cost * 7 ) + l_duration ) / 8 )
+            : l_duration
+        );
 
-    if ( !_captureWidth ) {
-        _captureWidth = l_windowAttributes.width;
+        if (
+            !l_result.found ||
+            (
+                l_state.result.found &&
+                ( l_result.x == l_state.result.x ) &&
+                ( l_result.y == l_state.result.y )
+            )
+        ) {
+            l_state.backoff = std::min< uint32_t >( ( l_state.backoff + 1 ), SCHEDULE_MAXIMUM_BACKOFF );
+
+        } else {
+            l_state.backoff = 0;
+        }
+
+        l_state.result    = l_result;
+        l_state.lastMatch = l_now;
+        l_state.isMatched = true;
     }
+    /// @endcode
+    //! <b>[update]</b>
+}
 
-    if ( !_captureHeight ) {
-        _captureHeight = l_windowAttributes.height;
+void matchingSession_t::setEventCallback( std::function< void( const sessionEvent_t& ) > _callback ) {
+    std::lock_guard< std::mutex > l_lock( m_eventsMutex );
+
+    m_eventCallback = std::move( _callback );
+}
+
+void matchingSession_t::start( double _framesPerSecond ) {
+    //! <b>[check]</b>
+    /// @code{.cpp}
+    if ( !( _framesPerSecond > 0 ) ) {
+        throw std::ios_base::failure(
+            fmt::format(
+                "Wrong frame rate {}",
+                _framesPerSecond
+            )
+        );
     }
 
-    Screen*         l_screen = l_windowAttributes.screen;
-    XShmSegmentInfo l_shminfo;
+    if ( isRunning() ) {
+        throw std::ios_base::failure( "Run loop is already started" );
+    }
+
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
+
+        if ( !m_windowCapture && !m_frameRingReader && !m_frameReplay ) {
+            throw std::ios_base::failure( "No window to capture" );
+        }
+    }
     /// @endcode
-    //! <b>[declare]</b>
+    //! <b>[check]</b>
 
-    //! <b>[canvas]</b>
+    //! <b>[pin_workers]</b>
+    /// Workers are unpinned when loop stops.
     /// @code{.cpp}
-    XImage* l_xImage = XShmCreateImage(
-        l_display,
-        DefaultVisualOfScreen( l_screen ),
-        DefaultDepthOfScreen( l_screen ),
-        ZPixmap,
-        NULL,
-        &l_shminfo,
-        _captureWidth,
-        _captureHeight
-    );
+    if ( !m_lowLatency.matcherCores.empty() ) {
+        try {
+            m_threadPool.pin( m_lowLatency.matcherCores );
+
+        } catch ( ... ) {
+            m_threadPool.unpin();
+
+            throw;
+        }
+    }
     /// @endcode
-    //! <b>[canvas]</b>
+    //! <b>[pin_workers]</b>
 
-    //! <b>[prepare]</b>
-    /// Prepare window information to capture.
+    //! <b>[start]</b>
     /// @code{.cpp}
-    l_shminfo.shmid = shmget(
-        IPC_PRIVATE,
-        ( l_xImage->bytes_per_line * l_xImage->height ),
-        ( IPC_CREAT | 0777 )
+    m_isStopping = false;
+
+    m_loopThread = std::thread(
+        &matchingSession_t::run,
+        this,
+        std::chrono::duration_cast< std::chrono::nanoseconds >(
+            std::chrono::duration< double >( 1 / _framesPerSecond )
+        )
     );
-    l_shminfo.shmaddr  = l_xImage->data = static_cast< char* >( shmat( l_shminfo.shmid, 0, 0 ) );
-    l_shminfo.readOnly = false;
     /// @endcode
-    //! <b>[prepare]</b>
+    //! <b>[start]</b>
 
-    //! <b>[error]</b>
+    //! <b>[pin_loop]</b>
+    /// Run loop thread captures and takes part in matching of every frame.
     /// @code{.cpp}
-    if ( !l_shminfo.shmid ) {
-        fmt::print(
-            stderr,
-            "Fatal shminfo error!"
-        );
+    if ( m_lowLatency.captureCore >= 0 ) {
+        try {
+            pinThread( m_loopThread, m_lowLatency.captureCore );
+
+        } catch ( ... ) {
+            stop();
+
+            throw;
+        }
     }
     /// @endcode
-    //! <b>[error]</b>
+    //! <b>[pin_loop]</b>
+}
 
-    //! <b>[attach]</b>
-    /// Attach to display with \c l_shminfo.
+void matchingSession_t::stop( void ) {
+    //! <b>[check]</b>
     /// @code{.cpp}
-    XShmAttach( l_display, &l_shminfo );
+    if ( !isRunning() ) {
+        return;
+    }
     /// @endcode
-    //! <b>[attach]</b>
+    //! <b>[check]</b>
 
-    //! <b>[capture]</b>
+    //! <b>[stop]</b>
     /// @code{.cpp}
-    XShmGetImage(
-        l_display,
-        l_window,
-        l_xImage,
-        0,
-        0,
-        0x00ffffff
-    );
-    /// @endcode
-    //! <b>[capture]</b>
+    {
+        std::lock_guard< std::mutex > l_lock( m_loopMutex );
 
-    //! <b>[color]</b>
-    /// Convert source image to template's color format.
-    /// @code{.cpp}
-    cv::Mat l_image = cv::Mat(
-        _captureHeight,
-        _captureWidth,
-        CV_8UC4,
-        l_xImage->data
-    );
+        m_isStopping = true;
+    }
 
-    cv::Mat t_l_image;
+    m_loopCondition.notify_all();
+    m_loopThread.join();
+    /// @endcode
+    //! <b>[stop]</b>
 
-    cv::cvtColor(
-        l_image,
-        t_l_image,
-        cv::COLOR_RGB2BGR
-    );
+    //! <b>[unpin]</b>
+    /// @code{.cpp}
+    m_threadPool.unpin();
     /// @endcode
-    //! <b>[color]</b>
+    //! <b>[unpin]</b>
+}
 
-    //! <b>[close]</b>
+std::vector< sessionEvent_t > matchingSession_t::popEvents( void ) {
+    //! <b>[take]</b>
     /// @code{.cpp}
-    XShmDetach( l_display, &l_shminfo );
-    XDestroyImage( l_xImage );
-    shmdt( l_shminfo.shmaddr );
-    XCloseDisplay( l_display );
+    std::lock_guard< std::mutex > l_lock( m_eventsMutex );
+
+    std::vector< sessionEvent_t > l_events( m_events.begin(), m_events.end() );
+
+    m_events.clear();
     /// @endcode
-    //! <b>[close]</b>
+    //! <b>[take]</b>
 
     //! <b>[return]</b>
     /// End of function.
     /// @code{.cpp}
-    return ( t_l_image );
+    return ( l_events );
     /// @endcode
     //! <b>[return]</b>
 }
 
-#endif // _WIN32
-
-///////////////
-/// @brief Compares a template against overlapped image regions.
-/// @details Throws ios_base::failure at error.
-/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes.
-/// @param[in] _image 2D image array where the search is running. It must be 8-bit or 32-bit floating-point.
-/// @param[in] _templateImages Searched template. It must be not greater than the source image and have the same data type.
-/// @param[in] _showResult Will print out squares of found images to other window.
-/// @param[in] _imageDisplay 2D image array with printed rectangles of found images.
-/// @param[in] _templateMap Map of comparison results.
-///////////////
-static void matchTemplates(
-    uint32_t   _matchMethod,
-    cv::Mat    _image,
-    std::vector< std::string > _templateImages,
-    const bool _showResult,
-    cv::Mat&   _imageDisplay,
-    std::map< std::string, std::array< uint32_t, 2 > >& _templateMap
-) {
-    //! <b>[check_image]</b>
+void matchingSession_t::run( std::chrono::nanoseconds _framePeriod ) {
+    //! <b>[prefault]</b>
+    /// Warm-up frames allocate pooled buffers and fill caches, locking memory then keeps their pages resident.
+    /// They are regular frames whose results go through rules, so no replayed frame is lost.
     /// @code{.cpp}
-    if ( _image.empty() ) {
-        throw std::ios_base::failure( "Can't read image cv::Mat" );
-    }
-    /// @endcode
-    //! <b>[check_image]</b>
+    if ( m_lowLatency.isPrefaulting ) {
+        try {
+            for (
+                size_t _frameIndex = 0;
+                ( ( _frameIndex < LOW_LATENCY_WARMUP_FRAMES ) && !m_isStopping.load( std::memory_order_relaxed ) );
+                _frameIndex++
+            ) {
+                const std::chrono::steady_clock::time_point l_captureTime = std::chrono::steady_clock::now();
 
-    //! <b>[copy_source]</b>
-    /// Source image to display.
-    /// @code{.cpp}
-    _image.copyTo( _imageDisplay );
-    /// @endcode
-    //! <b>[copy_source]</b>
+                applyRules( matchWindow(), l_captureTime );
 
-    //! <b>[create_window]</b>
-    /// Create window if needed.
-    /// @code{.cpp}
-    if ( _showResult ) {
-        cv::namedWindow( RESULT_WINDOW_NAME, cv::WINDOW_AUTOSIZE );
+                m_framesCount.fetch_add( 1, std::memory_order_relaxed );
+            }
+
+        } catch ( const std::exception& _exception ) {
+            fmt::print( stderr, "Run loop warm-up: {}\n", _exception.what() );
+        }
+
+        lockMemory();
     }
     /// @endcode
-    //! <b>[create_window]</b>
+    //! <b>[prefault]</b>
 
-    auto matchTemplate = [ & ]( std::string _templateImage ) {
-        //! <b>[declare]</b>
-        /// 2D image array for result.
-        /// @code{.cpp}
-        cv::Mat l_resultImage;
-        /// @endcode
-        //! <b>[declare]</b>
+    //! <b>[declare]</b>
+    /// @code{.cpp}
+    std::chrono::steady_clock::time_point l_deadline  = std::chrono::steady_clock::now();
+    bool                                  l_isFailing = false;
+    /// @endcode
+    //! <b>[declare]</b>
 
-        //! <b>[load_template]</b>
-        /// Load template image.
+    while ( true ) {
+        //! <b>[frame]</b>
+        /// Frames too old for latency target are dropped by matchWindow.
+        /// Errors are reported once and frames keep going, window may come back.
         /// @code{.cpp}
-        cv::Mat l_templateImage = cv::imread( _templateImage, cv::IMREAD_COLOR );
+        try {
+            const std::chrono::steady_clock::time_point l_captureTime = std::chrono::steady_clock::now();
+            const std::vector< matchResult_t >          l_results     = matchWindow();
 
-        if ( l_templateImage.empty() ) {
-            throw std::ios_base::failure(
-                fmt::format(
-                    "Can't read template image {}",
-                    _templateImage
-                )
-            );
-        }
-        /// @endcode
-        //! <b>[load_template]</b>
+            applyRules( l_results, l_captureTime );
 
-        //! <b>[create_result_array]</b>
-        /// Create the result 2D image array.
-        /// @code{.cpp}
-        l_resultImage.create(
-            ( _image.rows - l_templateImage.rows + 1 ),
-            ( _image.cols - l_templateImage.cols + 1 ),
-            CV_32FC1
-        );
-        /// @endcode
-        //! <b>[create_result_array]</b>
+            l_isFailing = false;
 
-        //! <b>[match_template]</b>
-        /// Do Matching.
-        /// @code{.cpp}
-        cv::matchTemplate(
-            _image,          // Source
-            l_templateImage, // Trying to find this
-            l_resultImage,
-            _matchMethod
-        );
-        /// @endcode
-        //! <b>[match_template]</b>
+        } catch ( const std::exception& _exception ) {
+            if ( !l_isFailing ) {
+                fmt::print( stderr, "Run loop: {}\n", _exception.what() );
+            }
 
-        //! <b>[normalize]</b>
-        /// Do Normalize.
-        /// @code{.cpp}
-        cv::normalize(
-            l_resultImage, // Source
-            l_resultImage, // Destination
-            0,
-            1,
-            cv::NORM_MINMAX,
-            -1,
-            cv::Mat()
-        );
-        /// @endcode
-        //! <b>[normalize]</b>
+            l_isFailing = true;
+        }
 
-        //! <b>[best_match]</b>
-        /// Localizing the best match with minMaxLoc.
-        /// @code{.cpp}
-        double l_minimumValue;
-        double l_maximumValue;
-        cv::Point l_minimumLocation;
-        cv::Point l_maximumLocation;
-        cv::Point l_matchLocation;
-
-        cv::minMaxLoc(
-            l_resultImage,
-            &l_minimumValue,
-            &l_maximumValue,
-            &l_minimumLocation,
-            &l_maximumLocation,
-            cv::Mat()
-        );
+        m_framesCount.fetch_add( 1, std::memory_order_relaxed );
         /// @endcode
-        //! <b>[best_match]</b>
+        //! <b>[frame]</b>
 
-        //! <b>[match_loc]</b>
-        /// For SQDIFF and SQDIFF_NORMED, the best matches are lower values. For all the other methods, the higher the better.
+        //! <b>[pace]</b>
+        /// Next frame starts on next deadline, deadlines already passed are skipped instead of run late back to back.
         /// @code{.cpp}
-        if ( ( _matchMethod  == cv::TM_SQDIFF ) || ( _matchMethod == cv::TM_SQDIFF_NORMED ) ) {
-            l_matchLocation = l_minimumLocation;
+        const std::chrono::steady_clock::time_point l_now = std::chrono::steady_clock::now();
 
-        } else {
-            l_matchLocation = l_maximumLocation;
-        }
-        /// @endcode
-        //! <b>[match_loc]</b>
+        l_deadline += _framePeriod;
 
-        //! <b>[draw_rectangles]</b>
-        /// Draw rectangles on images.
-        /// @code{.cpp}
-        cv::rectangle(
-            _imageDisplay,
-            l_matchLocation,
-            cv::Point(
-                ( l_matchLocation.x + l_templateImage.cols ),
-                ( l_matchLocation.y + l_templateImage.rows )
-            ),
-            cv::Scalar::all( 0 ),
-            2,
-            8,
-            0
-        );
-        /// @endcode
-        //! <b>[draw_rectangles]</b>
+        if ( l_deadline < l_now ) {
+            const uint64_t l_missedFramesCount = ( ( ( l_now - l_deadline ) / _framePeriod ) + 1 );
 
-        //! <b>[return]</b>
-        /// End of lambda.
-        /// @code{.cpp}
-        return (
-            cv::Point(
-                l_matchLocation.x + ( l_templateImage.cols / 2 ),
-                l_matchLocation.y + ( l_templateImage.rows / 2 )
-            )
-        );
+            m_missedFramesCount.fetch_add( l_missedFramesCount, std::memory_order_relaxed );
+            getMetrics().framesSkipped.fetch_add( l_missedFramesCount, std::memory_order_relaxed );
+            l_deadline += ( _framePeriod * l_missedFramesCount );
+        }
         /// @endcode
-        //! <b>[return]</b>
-    };
+        //! <b>[pace]</b>
+
+        if ( m_lowLatency.isBusyPolling ) {
+            //! <b>[busy_poll]</b>
+            /// Spin until deadline, waking up from sleep would add scheduler latency.
+            /// @code{.cpp}
+            while ( !m_isStopping.load( std::memory_order_relaxed ) && ( std::chrono::steady_clock::now() < l_deadline ) ) {
+                continue;
+            }
 
-    //! <b>[match_templates]</b>
-    /// Matching all templates on source image and generating map of template's coordinates.
-    /// @code{.cpp}
-    std::vector< std::thread > l_matchTemplateThreads;
-    cv::Point l_matchedLocation;
+            if ( m_isStopping.load( std::memory_order_relaxed ) ) {
+                break;
+            }
+            /// @endcode
+            //! <b>[busy_poll]</b>
 
-    for ( std::string _templateImage : _templateImages ) {
-        l_matchTemplateThreads.push_back(
-            std::thread( [ &, _templateImage ]{
-                l_matchedLocation = matchTemplate( _templateImage );
+        } else {
+            //! <b>[sleep]</b>
+            /// @code{.cpp}
+            std::unique_lock< std::mutex > l_lock( m_loopMutex );
 
-                _templateMap[ _templateImage ] = {
-                    static_cast< uint32_t >( l_matchedLocation.x ),
-                    static_cast< uint32_t >( l_matchedLocation.y )
-                };
-            } )
-        );
+            if ( m_loopCondition.wait_until( l_lock, l_deadline, [ this ] { return ( m_isStopping.load() ); } ) ) {
+                break;
+            }
+            /// @endcode
+            //! <b>[sleep]</b>
+        }
     }
 
-    for (
-        uint32_t _matchTemplateThreadIndex = 0;
-        _matchTemplateThreadIndex < l_matchTemplateThreads.size();
-        _matchTemplateThreadIndex++
-    ) {
-        l_matchTemplateThreads[ _matchTemplateThreadIndex ].join();
+    //! <b>[unlock]</b>
+    /// @code{.cpp}
+    if ( m_lowLatency.isPrefaulting ) {
+        unlockMemory();
     }
     /// @endcode
-    //! <b>[match_templates]</b>
+    //! <b>[unlock]</b>
 }
 
-///////////////
-/// @brief Compares a template against overlapped image regions.
-/// @details Throws ios_base::failure at error.
-/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes.
-/// @param[in] _sourceImage Image where the search is running. It must be 8-bit or 32-bit floating-point.
-/// @param[in] _templateImages Searched template. It must be not greater than the source image and have the same data type.
-/// @param[in] _showResult Will print out squares of found images to window.
-/// @return Map of comparison results.
-///////////////
-std::map< std::string, std::array< uint32_t, 2 > > matchingMethodFile(
-    uint32_t     _matchMethod,
-    std::string  _sourceImage,
-    const std::vector< std::string >& _templateImages,
-    const bool   _showResult
+void matchingSession_t::applyRules(
+    const std::vector< matchResult_t >&   _results,
+    std::chrono::steady_clock::time_point _captureTime
 ) {
-    //! <b>[load_image]</b>
-    /// Load image.
+    //! <b>[declare]</b>
     /// @code{.cpp}
-    cv::Mat l_image = cv::imread( _sourceImage, cv::IMREAD_COLOR );
+    const std::chrono::steady_clock::time_point l_now = std::chrono::steady_clock::now();
+    std::vector< sessionEvent_t > l_events;
+    std::vector< clickRule_t >    l_clicks;
     /// @endcode
-    //! <b>[load_image]</b>
+    //! <b>[declare]</b>
 
-    //! <b>[match]</b>
-    /// Match template images on source image.
+    //! <b>[rules]</b>
+    /// Only decide under lock, clicks are queued after it is released.
+    /// Rule clicks window of its template, frame ring and replayed frames have no window to fall back to.
     /// @code{.cpp}
-    cv::Mat l_imageDisplay;
-    std::map< std::string, std::array< uint32_t, 2 > > l_templateMap;
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
 
-    matchTemplates(
-        _matchMethod,
-        l_image,
-        _templateImages,
-        _showResult,
-        l_imageDisplay,
-        l_templateMap
-    );
+        const std::string l_frameWindowName = ( ( m_frameRingReader || m_frameReplay ) ? std::string() : m_windowName );
 
-    if ( l_imageDisplay.empty() ) {
-        throw std::ios_base::failure(
-            fmt::format(
-                "Can't read source image {}",
-                _sourceImage
-            )
-        );
+        m_previousResults.resize( _results.size() );
+
+        for ( size_t _templateId = 0; _templateId < _results.size(); _templateId++ ) {
+            const matchResult_t& l_result   = _results[ _templateId ];
+            matchResult_t&       l_previous = m_previousResults[ _templateId ];
+
+            if (
+                ( l_result.found != l_previous.found ) ||
+                ( l_result.x != l_previous.x ) ||
+                ( l_result.y != l_previous.y )
+            ) {
+                l_events.push_back( { _templateId, l_result, false } );
+            }
+
+            l_previous = l_result;
+        }
+
+        for ( size_t _ruleIndex = 0; _ruleIndex < m_clickRules.size(); _ruleIndex++ ) {
+            const clickRule_t& l_rule = m_clickRules[ _ruleIndex ];
+
+            if ( l_rule.templateId >= _results.size() ) {
+                continue;
+            }
+
+            const matchResult_t& l_result     = _results[ l_rule.templateId ];
+            const std::string&   l_windowName = ( l_rule.windowName.empty() ? l_frameWindowName : l_rule.windowName );
+
+            if ( l_windowName.empty() ) {
+                continue;
+            }
+
+            const bool l_isMatched = (
+                l_result.found &&
+                ( std::max( l_result.x, l_rule.x ) - std::min( l_result.x, l_rule.x ) <= l_rule.tolerance ) &&
+                ( std::max( l_result.y, l_rule.y ) - std::min( l_result.y, l_rule.y ) <= l_rule.tolerance )
+            );
+
+            if ( !l_isMatched || ( ( l_now - m_lastClicks[ _ruleIndex ] ) < l_rule.cooldown ) ) {
+                continue;
+            }
+
+            m_lastClicks[ _ruleIndex ] = l_now;
+
+            l_clicks.push_back( l_rule );
+            l_clicks.back().windowName = l_windowName;
+            l_events.push_back( { l_rule.templateId, l_result, true } );
+        }
     }
     /// @endcode
-    //! <b>[match]</b>
+    //! <b>[rules]</b>
 
-    //! <b>[imshow]</b>
-    /// Show me what you got.
+    //! <b>[click]</b>
+    /// Click found template center, clicks are queued and run loop doesn't wait for them.
     /// @code{.cpp}
-    if ( _showResult ) {
-        cv::imshow( RESULT_WINDOW_NAME, l_imageDisplay );
-        cv::waitKey( 30 );
+    for ( const clickRule_t& _click : l_clicks ) {
+        queueLeftClick(
+            _click.windowName,
+            _results[ _click.templateId ].x,
+            _results[ _click.templateId ].y,
+            CLICK_HOLD_TIME,
+            _captureTime
+        );
     }
     /// @endcode
-    //! <b>[imshow]</b>
+    //! <b>[click]</b>
 
-    //! <b>[return]</b>
-    /// End of function.
+    //! <b>[events]</b>
     /// @code{.cpp}
-    return ( l_templateMap );
+    for ( const sessionEvent_t& _event : l_events ) {
+        pushEvent( _event );
+    }
     /// @endcode
-    //! <b>[return]</b>
+    //! <b>[events]</b>
 }
 
-///////////////
-/// @brief Compares a template against overlapped image regions.
-/// @details Throws ios_base::failure at error.
-/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes.
-/// @param[in] _sourceWindowName Window where the search is running.
-/// @param[in] _templateImages Searched template. It must be not greater than the source image and have the same data type.
-/// @param[in] _showResult Will print out squares of found images to other window.
-/// @return Map of comparison results.
-///////////////
-std::map < std::string, std::array< uint32_t, 2 > > matchingMethodWindow(
-    uint32_t    _matchMethod,
-    const std::string& _sourceWindowName,
-    const std::vector< std::string >& _templateImages,
-    const bool  _showResult
-) {
-    //! <b>[load_image]</b>
-    /// Get window capture.
+void matchingSession_t::pushEvent( const sessionEvent_t& _event ) {
+    //! <b>[queue]</b>
+    /// Oldest event is dropped if nobody takes them.
     /// @code{.cpp}
-    cv::Mat l_image = getMatFromWindow( _sourceWindowName );
-    /// @endcode
-    //! <b>[load_image]</b>
+    std::function< void( const sessionEvent_t& ) > l_callback;
 
-    //! <b>[match]</b>
-    /// Match template images on source image.
-    /// @code{.cpp}
-    cv::Mat l_imageDisplay;
-    std::map< std::string, std::array< uint32_t, 2 > > l_templateMap;
+    {
+        std::lock_guard< std::mutex > l_lock( m_eventsMutex );
 
-    matchTemplates(
-        _matchMethod,
-        l_image,
-        _templateImages,
-        _showResult,
-        l_imageDisplay,
-        l_templateMap );
+        if ( m_events.size() >= SESSION_EVENTS_COUNT ) {
+            m_events.pop_front();
+        }
 
-    if ( l_imageDisplay.empty() ) {
-        throw std::ios_base::failure(
-            fmt::format(
-                "Can't read source window {}",
-                _sourceWindowName
-            ));
+        m_events.push_back( _event );
+        l_callback = m_eventCallback;
     }
     /// @endcode
-    //! <b>[match]</b>
+    //! <b>[queue]</b>
 
-    //! <b>[imshow]</b>
-    /// Show me what you got.
+    //! <b>[callback]</b>
     /// @code{.cpp}
-    cv::Mat t_l_image;
-
-    cv::cvtColor(
-        l_imageDisplay,
-        t_l_image,
-        cv::COLOR_BGR2RGB
-    );
-
-    if ( _showResult ) {
-        cv::imshow( RESULT_WINDOW_NAME, t_l_image );
-        cv::waitKey( 30 );
+    if ( l_callback ) {
+        l_callback( _event );
     }
     /// @endcode
-    //! <b>[imshow]</b>
-
-    //! <b>[return]</b>
-    /// End of function.
-    /// @code{.cpp}
-    return ( l_templateMap );
-    /// @endcode
-    //! <b>[return]</b>
-}
-
-///////////////
-/// @brief Compares a template against overlapped image regions.
-/// @details Throws ios_base::failure at error.
-/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes.
-/// @param[in] _sourceImage Image where the search is running. It must be 8-bit or 32-bit floating-point.
-/// @param[in] _templateImage Searched template. It must be not greater than the source image and have the same data type.
-/// @param[in] _searchResults Array to store result.
-/// @param[in] _showResult Will print out squares of found images to window.
-///////////////
-extern "C" void matchingMethodFile(
-    uint32_t*   _matchMethod,
-    char**      _sourceImage,
-    char**      _templateImage,
-    double*     _searchResults,
-    const bool* _showResult
-) {
-    std::map<
-        std::string,
-        std::array< uint32_t, 2 >
-    > l_coordinates = matchingMethodFile(
-        *_matchMethod,
-        std::string( *_sourceImage ),
-        { std::string( *_templateImage ) },
-        *_showResult
-    );
-
-    _searchResults[ 0 ] = l_coordinates[ std::string( *_templateImage ) ][ 0 ];
-    _searchResults[ 1 ] = l_coordinates[ std::string( *_templateImage ) ][ 1 ];
-}
-
-///////////////
-/// @brief Compares a template against overlapped image regions.
-/// @details Throws ios_base::failure at error.
-/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes.
-/// @param[in] _sourceWindowName Window where the search is running.
-/// @param[in] _templateImage Searched template. It must be not greater than the source image and have the same data type.
-/// @param[in] _searchResults Array to store result.
-/// @param[in] _showResult Will print out squares of found images to other window.
-///////////////
-extern "C" void matchingMethodWindow(
-    uint32_t*   _matchMethod,
-    char**      _sourceWindowName,
-    char**      _templateImage,
-    double*     _searchResults,
-    const bool* _showResult
-) {
-    std::map<
-        std::string,
-        std::array< uint32_t, 2 >
-    > l_coordinates = matchingMethodWindow(
-        *_matchMethod,
-        std::string( *_sourceWindowName ),
-        { std::string( *_templateImage ) },
-        *_showResult
-    );
-
-    _searchResults[ 0 ] = l_coordinates[ std::string( *_templateImage ) ][ 0 ];
-    _searchResults[ 1 ] = l_coordinates[ std::string( *_templateImage ) ][ 1 ];
+    //! <b>[callback]</b>
 }
 
 #ifdef _WIN32
@@ -1050,262 +8797,338 @@ extern "C" bool mouseClick(
 }
 
 ///////////////
-/// @brief Left clicks on window by coordinates.
-/// @param[in] _windowName Window name.
-/// @param[in] _coordinateX X relative to window.
-/// @param[in] _coordinateY Y relative to window.
+/// @brief Injects clicks for input queue.
 ///////////////
-extern "C" void leftMouseClick(
-    char**    _windowName,
-    uint32_t* _coordinateX,
-    uint32_t* _coordinateY
-) {
-    mouseClick(
-        _windowName,
-        _coordinateX,
-        _coordinateY,
-        click_t::MOUSE_LEFT_CLICK,
-        ( 0.5 * 1000 )
-    );
-}
+class inputDevice_t {
+public:
+    ///////////////
+    /// @brief Click on window and wait for release.
+    /// @param[in] _click Click to inject.
+    /// @param[out] _pressTime When press was injected, hold time before release as \c mouseClick returns after it.
+    /// @return Clicked or not.
+    ///////////////
+    bool click( const clickRequest_t& _click, std::chrono::steady_clock::time_point& _pressTime ) {
+        const bool l_isClicked = mouseClick(
+            _click.windowName,
+            _click.x,
+            _click.y,
+            _click.button,
+            static_cast< uint32_t >( _click.holdTime.count() )
+        );
+
+        _pressTime = ( std::chrono::steady_clock::now() - _click.holdTime );
+
+        return ( l_isClicked );
+    }
+};
 
 #else // _WIN32
 
 ///////////////
-/// @brief Clicks on window by coordinates.
-/// @param[in] _display \c Display to click.
-/// @param[in] _coordinateX X relative to display.
-/// @param[in] _coordinateY Y relative to display.
-/// @param[in] _button Button of \c click_t .
-/// @param[in] _sleepTime Pause between hold and release.
-/// @return Clicked or not.
+/// @brief Injects clicks for input queue with XTest.
+/// @details Display connection is opened once and used only by input thread.
+/// Throws ios_base::failure at error.
 ///////////////
-static bool mouseClick(
-    Display*        _display,
-    uint32_t        _coordinateX,
-    uint32_t        _coordinateY,
-    click_t         _button,
-    struct timeval* _sleepTime
-) {
-    //! <b>[declare]</b>
+class inputDevice_t {
+public:
+    inputDevice_t( void );
+    ~inputDevice_t( void );
+
+    inputDevice_t( const inputDevice_t& ) = delete;
+    inputDevice_t& operator=( const inputDevice_t& ) = delete;
+
+    ///////////////
+    /// @brief Click on window and wait for release.
+    /// @param[in] _click Click to inject.
+    /// @param[out] _pressTime When press was flushed to X server.
+    /// @return Clicked or not.
+    ///////////////
+    bool click( const clickRequest_t& _click, std::chrono::steady_clock::time_point& _pressTime );
+
+private:
+    Display*                        m_display;
+    std::map< std::string, Window > m_windows; // Found windows by name
+};
+
+inputDevice_t::inputDevice_t( void ) {
+    //! <b>[open_display]</b>
     /// @code{.cpp}
-    Window l_window    = DefaultRootWindow( _display );
-    bool   l_isSuccess = true;
+    m_display = XOpenDisplay( NULL );
+
+    if ( !m_display ) {
+        throw std::ios_base::failure( "Can't open display" );
+    }
     /// @endcode
-    //! <b>[declare]</b>
+    //! <b>[open_display]</b>
 
-    //! <b>[mouse_move]</b>
+    //! <b>[check_extension]</b>
     /// @code{.cpp}
-    XWarpPointer(
-        _display,     // Specifies the connection to the X server.
-        None,         // Specifies the source window
-        l_window,     // Specifies the destination window
-        0,            // Source X
-        0,            // Source Y
-        0,            // Specify a rectangle width in the source window.
-        0,            // Specify a rectangle height in the source window.
-        _coordinateX, // Specify the X coordinates within the destination window.
-        _coordinateY  // Specify the Y coordinates within the destination window.
-    );
+    int l_eventBase;
+    int l_errorBase;
+    int l_majorVersion;
+    int l_minorVersion;
+
+    if ( !XTestQueryExtension( m_display, &l_eventBase, &l_errorBase, &l_majorVersion, &l_minorVersion ) ) {
+        XCloseDisplay( m_display );
+
+        throw std::ios_base::failure( "XTest extension is not available" );
+    }
     /// @endcode
-    //! <b>[mouse_move]</b>
+    //! <b>[check_extension]</b>
+}
+
+inputDevice_t::~inputDevice_t( void ) {
+    XCloseDisplay( m_display );
+}
 
-    //! <b>[get_pointer]</b>
-    /// Get pointer coordinates.
+bool inputDevice_t::click( const clickRequest_t& _click, std::chrono::steady_clock::time_point& _pressTime ) {
+    //! <b>[translate]</b>
+    /// Window is searched only on first click on it, cached window that is gone is searched once again.
+    /// Window coordinates to root window ones, reparenting window managers included.
     /// @code{.cpp}
-    XEvent l_xEvent;
+    int    l_rootX;
+    int    l_rootY;
+    Window l_unusedChildren;
+    bool   l_isTranslated = false;
 
-    memset( &l_xEvent, 0, sizeof( l_xEvent ) );
+    for ( size_t _attempt = 0; ( _attempt < 2 ) && !l_isTranslated; _attempt++ ) {
+        xErrorTrap_t l_errorTrap( m_display );
 
-    l_xEvent.xbutton.type        = ButtonPress;
-    l_xEvent.xbutton.button      = _button;
-    l_xEvent.xbutton.same_screen = True;
+        std::map< std::string, Window >::iterator l_window = m_windows.find( _click.windowName );
 
-    XQueryPointer(
-        _display,
-        l_window,
-        &l_xEvent.xbutton.root,
-        &l_xEvent.xbutton.window,
-        &l_xEvent.xbutton.x_root,
-        &l_xEvent.xbutton.y_root,
-        &l_xEvent.xbutton.x,
-        &l_xEvent.xbutton.y,
-        &l_xEvent.xbutton.state
-    );
+        if ( l_window == m_windows.end() ) {
+            const Window l_foundWindow = getWindowByName( m_display, _click.windowName );
 
-    l_xEvent.xbutton.subwindow = l_xEvent.xbutton.window;
+            if ( !l_foundWindow ) {
+                return ( false );
+            }
 
-    while ( l_xEvent.xbutton.subwindow ) {
-        l_xEvent.xbutton.window = l_xEvent.xbutton.subwindow;
+            l_window = m_windows.emplace( _click.windowName, l_foundWindow ).first;
+        }
 
-        XQueryPointer(
-            _display,
-            l_xEvent.xbutton.window,
-            &l_xEvent.xbutton.root,
-            &l_xEvent.xbutton.subwindow,
-            &l_xEvent.xbutton.x_root,
-            &l_xEvent.xbutton.y_root,
-            &l_xEvent.xbutton.x,
-            &l_xEvent.xbutton.y,
-            &l_xEvent.xbutton.state
+        l_isTranslated = (
+            XTranslateCoordinates(
+                m_display,
+                l_window->second,
+                DefaultRootWindow( m_display ),
+                _click.x,
+                _click.y,
+                &l_rootX,
+                &l_rootY,
+                &l_unusedChildren
+            ) &&
+            !l_errorTrap.isFailed()
         );
+
+        if ( !l_isTranslated ) {
+            m_windows.erase( l_window );
+        }
+    }
+
+    if ( !l_isTranslated ) {
+        return ( false );
     }
     /// @endcode
-    //! <b>[get_pointer]</b>
+    //! <b>[translate]</b>
 
     //! <b>[press]</b>
     /// @code{.cpp}
-    if ( XSendEvent( _display, PointerWindow, True, 0xfff, &l_xEvent ) == 0 ) {
-        fmt::print( stderr, "Error on first XSendEvent()" );
+    const uint32_t l_button = (
+        ( _click.button == click_t::MOUSE_LEFT_CLICK )
+        ? Button1
+        : Button3
+    );
 
-        l_isSuccess = false;
-    }
+    XTestFakeMotionEvent( m_display, -1, l_rootX, l_rootY, CurrentTime );
+    XTestFakeButtonEvent( m_display, l_button, True, CurrentTime );
+    XFlush( m_display );
+
+    _pressTime = std::chrono::steady_clock::now();
     /// @endcode
     //! <b>[press]</b>
 
     //! <b>[hold]</b>
     /// @code{.cpp}
-    XFlush( _display );
-    std::this_thread::sleep_for( std::chrono::seconds( _sleepTime->tv_sec ) );
-    std::this_thread::sleep_for( std::chrono::microseconds( _sleepTime->tv_usec ) );
+    std::this_thread::sleep_for( _click.holdTime );
     /// @endcode
     //! <b>[hold]</b>
 
     //! <b>[release]</b>
     /// @code{.cpp}
-    l_xEvent.type          = ButtonRelease;
-    l_xEvent.xbutton.state = 0x100;
-
-    if ( XSendEvent( _display, PointerWindow, True, 0xfff, &l_xEvent ) == 0 ) {
-        fmt::print( stderr, "Error on second XSendEvent()" );
-
-        l_isSuccess = false;
-    }
+    XTestFakeButtonEvent( m_display, l_button, False, CurrentTime );
+    XFlush( m_display );
     /// @endcode
     //! <b>[release]</b>
 
-    //! <b>[apply]</b>
-    /// @code{.cpp}
-    XFlush( _display );
-    /// @endcode
-    //! <b>[apply]</b>
-
     //! <b>[return]</b>
     /// End of function.
     /// @code{.cpp}
-    return ( l_isSuccess );
+    return ( true );
     /// @endcode
     //! <b>[return]</b>
 }
 
+#endif // _WIN32
+
 ///////////////
-/// @brief Left clicks on window by coordinates.
-/** @details The coordinates in attr are relative to the parent window.
-  * If the parent window is the root window, then the coordinates are correct.
-  * If the parent window isn't the root window then we translate them.
-**/
-/// @param[in] _windowName Window name.
-/// @param[in] _coordinateX X relative to window.
-/// @param[in] _coordinateY Y relative to window.
+/// @brief Clicks queued by matching threads, injected one after another on own thread.
+/// @details Callers never wait for click, hold time is spent on input thread only.
 ///////////////
-extern "C" void leftMouseClick(
-    char**    _windowName,
-    uint32_t* _coordinateX,
-    uint32_t* _coordinateY
-) {
-    //! <b>[declare]</b>
-    /// @code{.cpp}
-    Display* l_display = XOpenDisplay( NULL );
-    Window   l_parentWindow;
-    Window   l_rootWindow;
-    Window*  l_childrenWindow;
-    uint32_t l_childrenCount;
-    int      l_windowX;
-    int      l_windowY;
+class inputQueue_t {
+public:
+    inputQueue_t( void ) = default;
+    ~inputQueue_t( void );
+
+    ///////////////
+    /// @brief Add click to queue, starts input thread lazily.
+    /// @param[in] _click Click to inject.
+    ///////////////
+    void push( clickRequest_t&& _click );
+
+    ///////////////
+    /// @brief Clicks queued or in flight.
+    /// @return Clicks count.
+    ///////////////
+    size_t pending( void );
+
+private:
+    void run( void );
+
+    std::mutex                   m_mutex;
+    std::condition_variable      m_condition;
+    std::deque< clickRequest_t > m_clicks;
+    size_t                       m_inFlightCount = 0;
+    bool                         m_isStopping    = false;
+    std::thread                  m_thread;
+};
 
-    if ( !l_display ) {
-        fmt::print( stderr, "Can't open display!\n" );
+inputQueue_t::~inputQueue_t( void ) {
+    //! <b>[stop]</b>
+    /// Click in flight is finished, queued ones are dropped.
+    /// @code{.cpp}
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
 
-        return;
+        m_isStopping = true;
     }
 
-    struct timeval l_sleepTime;
-    l_sleepTime.tv_sec  = 0;
-    l_sleepTime.tv_usec = ( 0.5 * 1000 * 1000 ); // 0.5 seconds
-
-    Window l_window = getWindowByName( std::string( *_windowName ) );
+    m_condition.notify_all();
 
-    XWindowAttributes l_windowAttributes;
+    if ( m_thread.joinable() ) {
+        m_thread.join();
+    }
     /// @endcode
-    //! <b>[declare]</b>
+    //! <b>[stop]</b>
+}
 
-    //! <b>[get_attributes]</b>
+void inputQueue_t::push( clickRequest_t&& _click ) {
+    //! <b>[push]</b>
     /// @code{.cpp}
-    XGetWindowAttributes(
-        l_display,
-        l_window,
-        &l_windowAttributes
-    );
-    /// @endcode
-    //! <b>[get_attributes]</b>
+    {
+        std::lock_guard< std::mutex > l_lock( m_mutex );
 
-    //! <b>[get_window_IDs]</b>
-    /// @code{.cpp}
-    XQueryTree(
-        l_display,
-        l_window,
-        &l_rootWindow,
-        &l_parentWindow,
-        &l_childrenWindow,
-        &l_childrenCount
-    );
+        m_clicks.push_back( std::move( _click ) );
 
-    if ( l_childrenWindow != NULL ) {
-        XFree( l_childrenWindow );
+        if ( !m_thread.joinable() ) {
+            m_thread = std::thread( &inputQueue_t::run, this );
+        }
     }
+
+    m_condition.notify_one();
     /// @endcode
-    //! <b>[get_window_IDs]</b>
+    //! <b>[push]</b>
+}
 
-    //! <b>[check]</b>
+size_t inputQueue_t::pending( void ) {
+    std::lock_guard< std::mutex > l_lock( m_mutex );
+
+    return ( m_clicks.size() + m_inFlightCount );
+}
+
+void inputQueue_t::run( void ) {
+    //! <b>[open_device]</b>
+    /// Device is created on input thread, so its display connection is never shared.
     /// @code{.cpp}
-    if ( l_parentWindow == l_windowAttributes.root ) {
-        l_windowX = l_windowAttributes.x;
-        l_windowY = l_windowAttributes.y;
+    std::unique_ptr< inputDevice_t > l_inputDevice;
 
-    } else {
-        Window l_unusedChildren;
+    try {
+        l_inputDevice.reset( new inputDevice_t );
 
-        XTranslateCoordinates(
-            l_display,
-            l_window,
-            l_windowAttributes.root,
-            0,
-            0,
-            &l_windowX,
-            &l_windowY,
-            &l_unusedChildren
-        );
+    } catch ( const std::exception& _exception ) {
+        fmt::print( stderr, "Input device: {}\n", _exception.what() );
     }
     /// @endcode
-    //! <b>[check]</b>
+    //! <b>[open_device]</b>
 
-    //! <b>[click]</b>
-    /// @code{.cpp}
-    mouseClick(
-        l_display,
-        ( l_windowX + *_coordinateX ),
-        ( l_windowY + *_coordinateY ),
-        click_t::MOUSE_LEFT_CLICK,
-        &l_sleepTime
-    );
-    /// @endcode
-    //! <b>[click]</b>
+    std::unique_lock< std::mutex > l_lock( m_mutex );
 
-    //! <b>[close_handle]</b>
-    /// @code{.cpp}
-    XCloseDisplay( l_display );
-    /// @endcode
-    //! <b>[close_handle]</b>
+    while ( true ) {
+        //! <b>[wait]</b>
+        /// @code{.cpp}
+        m_condition.wait( l_lock, [ this ] { return ( m_isStopping || !m_clicks.empty() ); } );
+
+        if ( m_isStopping ) {
+            break;
+        }
+
+        clickRequest_t l_click = std::move( m_clicks.front() );
+
+        m_clicks.pop_front();
+        m_inFlightCount++;
+        /// @endcode
+        //! <b>[wait]</b>
+
+        //! <b>[click]</b>
+        /// Clicks are dropped without device. Capture to click latency ends when press is injected,
+        /// failed and dropped clicks are not recorded.
+        /// @code{.cpp}
+        l_lock.unlock();
+
+        std::chrono::steady_clock::time_point l_pressTime;
+
+        if ( l_inputDevice ) {
+            if ( !l_inputDevice->click( l_click, l_pressTime ) ) {
+                fmt::print( stderr, "Click on {} failed\n", l_click.windowName );
+
+            } else if ( l_click.captureTime.time_since_epoch().count() ) {
+                getMetrics().captureToClick.record( l_pressTime - l_click.captureTime );
+            }
+        }
+
+        l_lock.lock();
+        m_inFlightCount--;
+        /// @endcode
+        //! <b>[click]</b>
+    }
 }
 
-#endif // _WIN32
+///////////////
+/// @brief Get input queue shared by all callers.
+/// @return Process wide input queue.
+///////////////
+static inputQueue_t& getInputQueue( void ) {
+    static inputQueue_t l_inputQueue;
+
+    return ( l_inputQueue );
+}
+
+void queueLeftClick(
+    const std::string&                    _windowName,
+    uint32_t                              _coordinateX,
+    uint32_t                              _coordinateY,
+    std::chrono::milliseconds             _holdTime,
+    std::chrono::steady_clock::time_point _captureTime
+) {
+    getInputQueue().push( {
+        _windowName,
+        _coordinateX,
+        _coordinateY,
+        click_t::MOUSE_LEFT_CLICK,
+        _holdTime,
+        _captureTime
+    } );
+}
+
+size_t pendingClicksCount( void ) {
+    return ( getInputQueue().pending() );
+}
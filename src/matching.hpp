@@ -0,0 +1,1572 @@
+///////////////
+/// @file matching.hpp
+/// @brief Matching library API: stateless calls, sessions, templates, frame sources and results.
+///////////////
+#pragma once
+
+#include <opencv4/opencv2/core.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <ios>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Awaitable requests of asyncMatcher_t for C++20 callers, library itself builds as C++17
+#if defined( __cpp_impl_coroutine ) && __has_include( <coroutine> )
+#include <coroutine>
+#define MATCHING_COROUTINES 1
+#endif
+
+namespace cv {
+class VideoCapture;
+}
+
+//! <b>[define]</b>
+/// @code{.cpp}
+#define CACHE_LINE_SIZE 64
+#define SESSION_EVENTS_COUNT 4096
+#define CLICK_HOLD_TIME std::chrono::milliseconds( 500 )
+#define FRAME_RING_SLOTS_COUNT 8
+#define SCHEDULE_BACKOFF_INTERVAL std::chrono::milliseconds( 50 )
+#define SCHEDULE_MAXIMUM_BACKOFF 6
+#define FRAME_PREFETCH_COUNT 4
+#define TRACE_EVENTS_COUNT 16384
+#define IMAGE_CACHE_BUDGET ( static_cast< size_t >( 512 ) * 1024 * 1024 )
+/// @endcode
+//! <b>[define]</b>
+
+//! <b>[struct]</b>
+/// Result of one template on one frame.
+/// @code{.cpp}
+struct matchResult_t {
+    uint32_t x     = 0;     // Template center X
+    uint32_t y     = 0;     // Template center Y
+    double   score = 0;     // Raw comparison value or inliers count
+    uint64_t frame = 0;     // Frame sequence number, 0 if never published
+    bool     found = false;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Flat table of latest match results indexed by template ID.
+/// @details Every slot is written by one thread at a time and published with a seqlock,
+/// so readers poll latest results from any thread without taking locks.
+///////////////
+class matchResults_t {
+public:
+    explicit matchResults_t( size_t _templatesCount = 0 ) {
+        resize( _templatesCount );
+    }
+
+    ///////////////
+    /// @brief Reallocate table, all slots are reset.
+    /// @details Not safe against concurrent readers.
+    /// @param[in] _templatesCount Templates count.
+    ///////////////
+    void resize( size_t _templatesCount ) {
+        m_slots.reset( new slot_t[ _templatesCount ] );
+        m_size = _templatesCount;
+    }
+
+    size_t size( void ) const {
+        return ( m_size );
+    }
+
+    ///////////////
+    /// @brief Start new frame.
+    /// @return Frame sequence number to publish results with.
+    ///////////////
+    uint64_t nextFrame( void ) {
+        return ( m_frame.fetch_add( 1, std::memory_order_relaxed ) + 1 );
+    }
+
+    ///////////////
+    /// @brief Publish result of template.
+    /// @param[in] _templateId Template index.
+    /// @param[in] _result Result to publish.
+    ///////////////
+    void publish( size_t _templateId, const matchResult_t& _result ) {
+        //! <b>[begin]</b>
+        /// Odd sequence marks slot as being written.
+        /// @code{.cpp}
+        slot_t&  l_slot     = m_slots[ _templateId ];
+        uint32_t l_sequence = l_slot.sequence.load( std::memory_order_relaxed );
+
+        l_slot.sequence.store( ( l_sequence + 1 ), std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_release );
+        /// @endcode
+        //! <b>[begin]</b>
+
+        //! <b>[write]</b>
+        /// @code{.cpp}
+        uint64_t l_score;
+
+        std::memcpy( &l_score, &_result.score, sizeof( l_score ) );
+
+        l_slot.coordinates.store(
+            ( ( static_cast< uint64_t >( _result.x ) << 32 ) | _result.y ),
+            std::memory_order_relaxed
+        );
+        l_slot.score.store( l_score, std::memory_order_relaxed );
+        l_slot.frame.store( _result.frame, std::memory_order_relaxed );
+        l_slot.found.store( _result.found, std::memory_order_relaxed );
+        /// @endcode
+        //! <b>[write]</b>
+
+        //! <b>[end]</b>
+        /// @code{.cpp}
+        l_slot.sequence.store( ( l_sequence + 2 ), std::memory_order_release );
+        /// @endcode
+        //! <b>[end]</b>
+    }
+
+    ///////////////
+    /// @brief Read latest result of template.
+    /// @details Retries while writer is inside of slot.
+    /// @param[in] _templateId Template index.
+    /// @return Consistent copy of slot.
+    ///////////////
+    matchResult_t read( size_t _templateId ) const {
+        //! <b>[declare]</b>
+        /// @code{.cpp}
+        const slot_t& l_slot = m_slots[ _templateId ];
+        matchResult_t l_result;
+        uint32_t      l_sequenceBegin;
+        uint32_t      l_sequenceEnd;
+        uint64_t      l_coordinates;
+        uint64_t      l_score;
+        /// @endcode
+        //! <b>[declare]</b>
+
+        //! <b>[read]</b>
+        /// @code{.cpp}
+        do {
+            l_sequenceBegin = l_slot.sequence.load( std::memory_order_acquire );
+
+            l_coordinates  = l_slot.coordinates.load( std::memory_order_relaxed );
+            l_score        = l_slot.score.load( std::memory_order_relaxed );
+            l_result.frame = l_slot.frame.load( std::memory_order_relaxed );
+            l_result.found = l_slot.found.load( std::memory_order_relaxed );
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+
+            l_sequenceEnd = l_slot.sequence.load( std::memory_order_relaxed );
+        } while ( ( l_sequenceBegin & 1 ) || ( l_sequenceBegin != l_sequenceEnd ) );
+        /// @endcode
+        //! <b>[read]</b>
+
+        //! <b>[return]</b>
+        /// End of function.
+        /// @code{.cpp}
+        l_result.x = static_cast< uint32_t >( l_coordinates >> 32 );
+        l_result.y = static_cast< uint32_t >( l_coordinates );
+
+        std::memcpy( &l_result.score, &l_score, sizeof( l_score ) );
+
+        return ( l_result );
+        /// @endcode
+        //! <b>[return]</b>
+    }
+
+    ///////////////
+    /// @brief Read latest results of all templates.
+    /// @return Results indexed by template ID.
+    ///////////////
+    std::vector< matchResult_t > snapshot( void ) const {
+        std::vector< matchResult_t > l_results( m_size );
+
+        for ( size_t _templateId = 0; _templateId < m_size; _templateId++ ) {
+            l_results[ _templateId ] = read( _templateId );
+        }
+
+        return ( l_results );
+    }
+
+private:
+    //! <b>[struct]</b>
+    /// One cache line per template, so writers of neighbour slots don't share lines.
+    /// @code{.cpp}
+    struct alignas( CACHE_LINE_SIZE ) slot_t {
+        std::atomic< uint32_t > sequence    = { 0 };
+        std::atomic< bool >     found       = { false };
+        std::atomic< uint64_t > coordinates = { 0 };
+        std::atomic< uint64_t > score       = { 0 };
+        std::atomic< uint64_t > frame       = { 0 };
+    };
+    /// @endcode
+    //! <b>[struct]</b>
+
+    std::unique_ptr< slot_t[] > m_slots;
+    size_t                      m_size = 0;
+    std::atomic< uint64_t >     m_frame = { 0 };
+};
+
+///////////////
+/// @brief Buffers reused across frames.
+/// @details Free buffers are keyed by size and type, so after warm-up every \c acquire
+/// returns already allocated memory and a frame performs no buffer allocations.
+///////////////
+class matPool_t {
+public:
+    ///////////////
+    /// @brief Buffer borrowed from pool, returned to it on destruction.
+    ///////////////
+    class lease_t {
+    public:
+        lease_t( void ) = default;
+        lease_t( matPool_t* _pool, cv::Mat&& _mat );
+        lease_t( lease_t&& _lease ) noexcept;
+        lease_t& operator=( lease_t&& _lease ) noexcept;
+        ~lease_t( void );
+
+        lease_t( const lease_t& ) = delete;
+        lease_t& operator=( const lease_t& ) = delete;
+
+        cv::Mat& operator*( void ) {
+            return ( m_mat );
+        }
+
+        cv::Mat* operator->( void ) {
+            return ( &m_mat );
+        }
+
+    private:
+        matPool_t* m_pool = nullptr;
+        cv::Mat    m_mat;
+    };
+
+    ///////////////
+    /// @brief Borrow buffer of given geometry.
+    /// @param[in] _rows Rows count.
+    /// @param[in] _cols Columns count.
+    /// @param[in] _type Array type, see cv::Mat::type().
+    /// @return Buffer, allocated only if no free one of this geometry is pooled.
+    ///////////////
+    lease_t acquire( int _rows, int _cols, int _type );
+
+    ///////////////
+    /// @brief Count of buffers allocated by pool since creation.
+    /// @return Allocations count.
+    ///////////////
+    uint64_t allocations( void ) const {
+        return ( m_allocations.load( std::memory_order_relaxed ) );
+    }
+
+private:
+    void release( cv::Mat&& _mat );
+
+    std::mutex                                                  m_mutex;
+    std::map< std::tuple< int, int, int >, std::vector< cv::Mat > > m_buffers;
+    std::atomic< uint64_t >                                     m_allocations = { 0 };
+};
+
+///////////////
+/// @brief Fixed set of worker threads running index ranges.
+/// @details Workers are started once, \c parallelFor hands out indices through an atomic counter,
+/// so running a range creates no threads and copies no tasks.
+///////////////
+class threadPool_t {
+public:
+    explicit threadPool_t( size_t _threadsCount = std::thread::hardware_concurrency() );
+    ~threadPool_t( void );
+
+    threadPool_t( const threadPool_t& ) = delete;
+    threadPool_t& operator=( const threadPool_t& ) = delete;
+
+    ///////////////
+    /// @brief Run task for every index and wait for all of them.
+    /// @details Caller thread takes part in work. Called from worker thread runs inline.
+    /// Rethrows first exception of task.
+    /// @param[in] _count Indices count.
+    /// @param[in] _task Task to run with index.
+    ///////////////
+    void parallelFor( size_t _count, const std::function< void( size_t ) >& _task );
+
+    ///////////////
+    /// @brief Pin workers to cores taken round robin, caller of \c parallelFor is not pinned.
+    /// @details Throws ios_base::failure at error.
+    /// @param[in] _cores Core indices.
+    ///////////////
+    void pin( const std::vector< int >& _cores );
+
+    ///////////////
+    /// @brief Restore cores workers could run on before \c pin .
+    ///////////////
+    void unpin( void );
+
+    size_t size( void ) const {
+        return ( m_threads.size() + 1 );
+    }
+
+private:
+    void run( void );
+    void work( const std::function< void( size_t ) >& _task, size_t _count );
+
+    std::vector< std::thread >                m_threads;
+    std::mutex                                m_mutex;
+    std::mutex                                m_parallelForMutex;
+    std::condition_variable                   m_condition;
+    std::condition_variable                   m_doneCondition;
+    const std::function< void( size_t ) >*    m_task = nullptr;
+    size_t                                    m_count = 0;
+    std::atomic< size_t >                     m_nextIndex = { 0 };
+    size_t                                    m_finishedWorkers = 0;
+    uint64_t                                  m_generation = 0;
+    bool                                      m_isStopping = false;
+    std::exception_ptr                        m_exception;
+    std::vector< std::vector< int > >         m_unpinnedCores; // Cores of workers before pin, empty if not pinned
+};
+
+///////////////
+/// @brief Get pool shared by stateless calls.
+/// @return Process wide pool.
+///////////////
+matPool_t& getDefaultMatPool( void );
+
+///////////////
+/// @brief Count every \c cv::Mat heap allocation made in process.
+/// @details Installs counting default \c cv::MatAllocator , includes OpenCV internal temporaries.
+/// Other heap allocations are not counted, a frame still makes a few for returned results and bookkeeping.
+/// Idempotent.
+///////////////
+void enableAllocationCounter( void );
+
+///////////////
+/// @brief Count of \c cv::Mat heap allocations since \c enableAllocationCounter .
+/// @details Steady state frame of batched templates allocates none, cv::matchTemplate allocates scratch on every call.
+/// @return Allocations count.
+///////////////
+uint64_t getMatAllocationsCount( void );
+
+///////////////
+/// @brief Bytes of \c cv::Mat heap allocations since \c enableAllocationCounter .
+/// @return Allocated bytes, freed ones are not subtracted.
+///////////////
+uint64_t getMatAllocatedBytes( void );
+
+///////////////
+/// @brief Start or stop recording of trace events.
+/// @details Every thread records into own ring of \c TRACE_EVENTS_COUNT events, oldest are overwritten.
+/// Disabled trace point costs one relaxed atomic load.
+/// @param[in] _isEnabled Enable or disable.
+///////////////
+void enableTracing( bool _isEnabled );
+
+bool isTracingEnabled( void );
+
+///////////////
+/// @brief Write recorded events in Chrome trace format, opened by chrome://tracing and Perfetto.
+/// @details Events keep being recorded, events overwritten while writing are skipped.
+/// Throws ios_base::failure at error.
+/// @param[in] _path Output path.
+/// @return Events count written.
+///////////////
+size_t writeTrace( const std::string& _path );
+
+///////////////
+/// @brief Drop recorded events of all threads.
+///////////////
+void clearTrace( void );
+
+///////////////
+/// @brief Format current metrics.
+/// @details Counters of captured and skipped frames, thread pool and click queue depth,
+/// \c cv::Mat allocations and latency percentiles of every template and of capture to click.
+/// Template IDs of all sessions share the same histograms.
+/// @param[in] _isJson JSON object instead of Prometheus text format.
+/// @return Formatted metrics.
+///////////////
+std::string formatMetrics( bool _isJson = false );
+
+///////////////
+/// @brief Serve metrics on Unix domain socket from own thread, replacing previous server.
+/// @details Every connection gets metrics and is closed. HTTP request gets HTTP response, so
+/// \c curl \c --unix-socket works, JSON is sent if request asks for "json", Prometheus text otherwise.
+/// Enables \c cv::Mat allocation counter. Not supported on Windows.
+/// Throws ios_base::failure at error.
+/// @param[in] _socketPath Socket path, existing socket file is replaced.
+///////////////
+void startMetricsServer( const std::string& _socketPath );
+
+///////////////
+/// @brief Stop metrics server and remove its socket, does nothing without server.
+///////////////
+void stopMetricsServer( void );
+
+//! <b>[struct]</b>
+/// Counters of decoded images cache.
+/// @code{.cpp}
+struct imageCacheStatistics_t {
+    uint64_t hits          = 0;
+    uint64_t misses        = 0;
+    uint64_t evictions     = 0; // Dropped to stay within budget
+    uint64_t invalidations = 0; // Dropped because file was changed
+    size_t   imagesCount   = 0;
+    size_t   bytes         = 0;
+    size_t   budget        = 0;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Least recently used cache of decoded images.
+/// @details Keyed by path, entry is valid while file modification time and size are the same.
+/// Returned images share memory with cache and must not be written, evicted image lives
+/// as long as it is referenced. Images larger than budget are not cached.
+/// Throws ios_base::failure at error.
+///////////////
+class imageCache_t {
+public:
+    explicit imageCache_t( size_t _budget = IMAGE_CACHE_BUDGET ) : m_budget( _budget ) {}
+
+    imageCache_t( const imageCache_t& ) = delete;
+    imageCache_t& operator=( const imageCache_t& ) = delete;
+
+    ///////////////
+    /// @brief Get decoded image, decode it only if not cached or changed.
+    /// @param[in] _path Image path.
+    /// @return Image in BGR order.
+    ///////////////
+    cv::Mat get( const std::string& _path );
+
+    ///////////////
+    /// @brief Change budget, least recently used images are evicted to fit it.
+    /// @param[in] _budget Bytes of decoded images, 0 disables cache.
+    ///////////////
+    void setBudget( size_t _budget );
+
+    void clear( void );
+
+    imageCacheStatistics_t statistics( void ) const;
+
+private:
+    //! <b>[struct]</b>
+    /// @code{.cpp}
+    struct entry_t {
+        cv::Mat                            image;
+        int64_t                            modificationTime;
+        uintmax_t                          fileSize;
+        std::list< std::string >::iterator order;
+    };
+    /// @endcode
+    //! <b>[struct]</b>
+
+    void evict( size_t _budget );
+
+    mutable std::mutex                 m_mutex;
+    std::map< std::string, entry_t >   m_entries;
+    std::list< std::string >           m_order; // Most recently used first
+    size_t                             m_budget;
+    imageCacheStatistics_t             m_statistics;
+};
+
+///////////////
+/// @brief Decoded images cache shared by all calls in process.
+/// @return Images cache.
+///////////////
+imageCache_t& getImageCache( void );
+
+///////////////
+/// @brief Compares templates against image from file.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+/// @param[in] _sourceImage Image where the search is running.
+/// @param[in] _templateImages Searched templates, index is template ID.
+/// @param[in] _showResult Will print out squares of found images to window.
+/// @return Results indexed by template ID.
+///////////////
+std::vector< matchResult_t > matchingMethodFile(
+    uint32_t                          _matchMethod,
+    std::string                       _sourceImage,
+    const std::vector< std::string >& _templateImages,
+    const bool                        _showResult
+);
+
+///////////////
+/// @brief Correlate templates of the same size and type with image in one pass, as small templates are batched.
+/// @details Response maps equal cv::matchTemplate ones up to float rounding.
+/// Throws ios_base::failure at error.
+/// @param[in] _image Image, 8-bit or 32-bit floating-point.
+/// @param[in] _templateImages Templates of the same size and type as each other and image, not greater than image.
+/// @param[in] _matchMethod Parameter specifying the comparison method, see cv::TemplateMatchModes .
+/// @return Response map of every template.
+///////////////
+std::vector< cv::Mat > correlateTemplates(
+    const cv::Mat&                _image,
+    const std::vector< cv::Mat >& _templateImages,
+    uint32_t                      _matchMethod
+);
+
+//! <b>[typedef]</b>
+/// Sample image path with paths of templates to search on it.
+/// @code{.cpp}
+typedef std::vector< std::pair< std::string, std::vector< std::string > > > manifest_t;
+/// @endcode
+//! <b>[typedef]</b>
+
+//! <b>[struct]</b>
+/// Result of one template on one sample.
+/// @code{.cpp}
+struct batchResult_t {
+    std::string   sourceImage;
+    std::string   templateImage;
+    matchResult_t result;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Build manifest from images directory.
+/// @details Uses names "sample.category.png" and "template.category.unique_name.png",
+/// templates are searched on sample of the same category.
+/// Throws ios_base::failure at error.
+/// @param[in] _directory Images directory.
+/// @param[in] _extension Images extension.
+/// @return Manifest of samples with their templates.
+///////////////
+manifest_t readImageDirectory(
+    const std::string& _directory,
+    const std::string& _extension = ".png"
+);
+
+///////////////
+/// @brief Compares templates against their samples.
+/// @details Every sample is decoded once, all of its templates are matched in parallel.
+/// Next sample is decoded while current one is matched.
+/// Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+/// @param[in] _manifest Samples with their templates.
+/// @return Results in manifest order.
+///////////////
+std::vector< batchResult_t > matchingMethodBatch(
+    uint32_t          _matchMethod,
+    const manifest_t& _manifest
+);
+
+///////////////
+/// @brief Compares templates against window capture.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+/// @param[in] _sourceWindowName Window where the search is running.
+/// @param[in] _templateImages Searched templates, index is template ID.
+/// @param[in] _showResult Will print out squares of found images to other window.
+/// @param[in] _results Table to publish results to, sized to templates count.
+///////////////
+void matchingMethodWindow(
+    uint32_t                          _matchMethod,
+    const std::string&                _sourceWindowName,
+    const std::vector< std::string >& _templateImages,
+    const bool                        _showResult,
+    matchResults_t&                   _results
+);
+
+///////////////
+/// @brief Compares templates against window capture.
+/// @details Throws ios_base::failure at error.
+/// @param[in] _matchMethod Parameter specifying the comparison method.
+/// @param[in] _sourceWindowName Window where the search is running.
+/// @param[in] _templateImages Searched templates, index is template ID.
+/// @param[in] _showResult Will print out squares of found images to other window.
+/// @return Results indexed by template ID.
+///////////////
+std::vector< matchResult_t > matchingMethodWindow(
+    uint32_t                          _matchMethod,
+    const std::string&                _sourceWindowName,
+    const std::vector< std::string >& _templateImages,
+    const bool                        _showResult
+);
+
+//! <b>[struct]</b>
+/// Click on template center when it is found near expected coordinates.
+/// Frames without window, taken from frame ring or replay, are clicked only by rules naming their window.
+/// @code{.cpp}
+struct clickRule_t {
+    size_t      templateId = 0;
+    uint32_t    x          = 0; // Expected template center X
+    uint32_t    y          = 0; // Expected template center Y
+    uint32_t    tolerance  = 0; // Allowed distance from expected coordinates per axis
+    std::string windowName;     // Window template is clicked on, window frame was captured from if empty
+    std::chrono::milliseconds cooldown{ 1000 }; // Pause before rule fires again
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[struct]</b>
+/// Change of template result seen by run loop.
+/// @code{.cpp}
+struct sessionEvent_t {
+    size_t        templateId = 0;
+    matchResult_t result;
+    bool          clicked = false;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[struct]</b>
+/// Result of template on one of session windows.
+/// @code{.cpp}
+struct windowResult_t {
+    size_t        windowId   = 0;
+    size_t        templateId = 0;
+    matchResult_t result;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[struct]</b>
+/// How often template is worth matching.
+/// @code{.cpp}
+struct templateSchedule_t {
+    uint32_t                  priority = 1;       // Higher is matched first when frame budget is short
+    std::chrono::milliseconds minimumInterval{ 0 }; // Shortest pause between matches
+    std::chrono::milliseconds deadline{ 0 };        // Longest pause between matches, 0 for none
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[struct]</b>
+/// Templates matched on one frame and time spent on each of them.
+/// @code{.cpp}
+struct templateSelection_t {
+    std::vector< size_t >                   templateIds;
+    std::vector< std::chrono::nanoseconds > durations;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[enum]</b>
+/// Way template is located on frame, converted frames are shared by templates.
+/// @code{.cpp}
+enum matchStrategy_t : uint32_t {
+    MATCH_STRATEGY_DIRECT,       // cv::matchTemplate on frame, OpenCV switches to DFT for large templates
+    MATCH_STRATEGY_GRAY,         // Single channel frame and template
+    MATCH_STRATEGY_PYRAMID,      // Half resolution search refined around best location
+    MATCH_STRATEGY_GRAY_PYRAMID, // Both of them
+    MATCH_STRATEGY_COUNT
+};
+/// @endcode
+//! <b>[enum]</b>
+
+//! <b>[struct]</b>
+/// Fastest strategy of template on frame geometry it was tuned on.
+/// @code{.cpp}
+struct templateTuning_t {
+    matchStrategy_t          strategy = MATCH_STRATEGY_DIRECT;
+    std::chrono::nanoseconds cost{ 0 }; // Matching time of strategy, shared frame conversions included
+    uint64_t                 hash = 0;  // Template pixels hash, 0 if not tuned
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[struct]</b>
+/// Low-latency configuration of run loop.
+/// @code{.cpp}
+struct lowLatency_t {
+    int                       captureCore   = -1;    // Core of run loop thread, which captures and matches too, -1 unpinned
+    std::vector< int >        matcherCores;          // Cores of pool workers taken round robin, empty unpinned
+    bool                      isPrefaulting = false; // Warm-up frames touch every buffer, then memory of whole process is locked while any such loop runs
+    bool                      isBusyPolling = false; // Spin until frame deadline instead of sleeping
+    std::chrono::microseconds latencyTarget{ 0 };    // Capture to result latency, ring frames too old to meet it are dropped, 0 for none
+};
+/// @endcode
+//! <b>[struct]</b>
+
+//! <b>[struct]</b>
+/// Capture to result latency of matched window frames, counted from capture start or ring publish time.
+/// @code{.cpp}
+struct latencyReport_t {
+    double   target             = 0;     // Seconds, 0 if not set
+    double   median             = 0;     // Seconds
+    double   p99                = 0;     // Seconds
+    double   maximum            = 0;     // Seconds
+    uint64_t framesCount        = 0;     // Frames with results
+    uint64_t droppedFramesCount = 0;     // Frames dropped to keep target
+    bool     isMet              = false; // p99 is within target
+};
+/// @endcode
+//! <b>[struct]</b>
+
+///////////////
+/// @brief Name of strategy as stored in tuning profile.
+/// @param[in] _strategy Strategy.
+/// @return Name like "gray_pyramid".
+///////////////
+const char* matchStrategyName( matchStrategy_t _strategy );
+
+///////////////
+/// @brief Queue left click on window.
+/// @details Returns at once, clicks are injected one after another by input thread.
+/// @param[in] _windowName Window name.
+/// @param[in] _coordinateX X relative to window.
+/// @param[in] _coordinateY Y relative to window.
+/// @param[in] _holdTime Pause between press and release.
+/// @param[in] _captureTime Capture of frame click was decided on, measures capture to click latency if set.
+///////////////
+void queueLeftClick(
+    const std::string&                    _windowName,
+    uint32_t                              _coordinateX,
+    uint32_t                              _coordinateY,
+    std::chrono::milliseconds             _holdTime = CLICK_HOLD_TIME,
+    std::chrono::steady_clock::time_point _captureTime = {}
+);
+
+///////////////
+/// @brief Clicks queued or in flight.
+/// @return Clicks count.
+///////////////
+size_t pendingClicksCount( void );
+
+///////////////
+/// @brief Publishes frames into ring in POSIX shared memory or file, for matchers in other processes.
+/// @details Every frame is copied once into next slot and published with sequence number,
+/// slot being written is marked so readers never take it. Frame larger than slots recreates ring
+/// under the same name, readers reopen it on next read.
+/// Not supported on Windows.
+/// Throws ios_base::failure at error.
+///////////////
+class frameRingWriter_t {
+public:
+    ///////////////
+    /// @brief Create ring, ring of the same name is replaced.
+    /// @param[in] _name Shared memory name like "/frames" or file path.
+    /// @param[in] _frameSize Largest frame in bytes.
+    /// @param[in] _slotsCount Frames kept, readers have that many frame periods to use a frame in place.
+    /// @param[in] _isFileBacked Name is file path.
+    ///////////////
+    frameRingWriter_t(
+        const std::string& _name,
+        size_t             _frameSize,
+        uint32_t           _slotsCount   = FRAME_RING_SLOTS_COUNT,
+        bool               _isFileBacked = false
+    );
+    ~frameRingWriter_t( void );
+
+    frameRingWriter_t( const frameRingWriter_t& ) = delete;
+    frameRingWriter_t& operator=( const frameRingWriter_t& ) = delete;
+
+    ///////////////
+    /// @brief Copy frame into next slot and publish it.
+    /// @param[in] _frame Frame.
+    /// @return Frame sequence number.
+    ///////////////
+    uint64_t publish( const cv::Mat& _frame );
+
+private:
+    void create( size_t _frameSize, uint32_t _slotsCount, uint64_t _generation, uint64_t _sequence );
+
+    std::string m_name;
+    bool        m_isFileBacked;
+    int         m_descriptor;
+    uint8_t*    m_memory;
+    size_t      m_memorySize;
+};
+
+///////////////
+/// @brief Maps frame ring read-only and hands out frames without copying them.
+/// @details Throws ios_base::failure at error.
+///////////////
+class frameRingReader_t {
+public:
+    ///////////////
+    /// @brief Open existing ring.
+    /// @param[in] _name Shared memory name like "/frames" or file path.
+    /// @param[in] _isFileBacked Name is file path.
+    ///////////////
+    explicit frameRingReader_t( const std::string& _name, bool _isFileBacked = false );
+    ~frameRingReader_t( void );
+
+    frameRingReader_t( const frameRingReader_t& ) = delete;
+    frameRingReader_t& operator=( const frameRingReader_t& ) = delete;
+
+    ///////////////
+    /// @brief Take newest frame.
+    /// @details Frame points into read-only ring memory, check \c isValid after using it.
+    /// Replaced ring is reopened, frames taken from it before are no longer valid.
+    /// @param[in] _lastSequence Sequence number of frame already taken.
+    /// @param[out] _frame Frame.
+    /// @param[out] _publishTime Time frame was published. Optional.
+    /// @return Frame sequence number, 0 if no newer frame.
+    ///////////////
+    uint64_t read( uint64_t _lastSequence, cv::Mat& _frame, std::chrono::steady_clock::time_point* _publishTime = NULL );
+
+    ///////////////
+    /// @brief Frame wasn't overwritten by writer.
+    /// @param[in] _sequence Frame sequence number.
+    /// @return Frame is still in its slot.
+    ///////////////
+    bool isValid( uint64_t _sequence ) const;
+
+private:
+    void attach( void );
+
+    std::string    m_name;
+    bool           m_isFileBacked;
+    int            m_descriptor;
+    const uint8_t* m_memory = NULL;
+    size_t         m_memorySize;
+};
+
+///////////////
+/// @brief Capture window into frame ring, the capture daemon of matchers reading ring.
+/// @details Ring is created on first frame with slots fitting it, and recreated if window grows.
+/// Throws ios_base::failure at error.
+/// @param[in] _windowName Window name.
+/// @param[in] _ringName Shared memory name like "/frames" or file path.
+/// @param[in] _framesPerSecond Frame rate.
+/// @param[in] _framesCount Frames to capture, 0 for endless.
+/// @param[in] _slotsCount Frames kept.
+/// @param[in] _isFileBacked Ring name is file path.
+///////////////
+void captureWindowToFrameRing(
+    const std::string& _windowName,
+    const std::string& _ringName,
+    double             _framesPerSecond,
+    uint64_t           _framesCount  = 0,
+    uint32_t           _slotsCount   = FRAME_RING_SLOTS_COUNT,
+    bool               _isFileBacked = false
+);
+
+///////////////
+/// @brief Appends captured frames and their results to frame stream file.
+/// @details Records are aligned, so replay maps file and uses raw frames in place.
+/// Not supported on Windows.
+/// Throws ios_base::failure at error.
+///////////////
+class frameRecorder_t {
+public:
+    ///////////////
+    /// @brief Create frame stream, file is replaced.
+    /// @param[in] _path File path.
+    /// @param[in] _isCompressed Store frames as fast PNG instead of raw planes.
+    ///////////////
+    explicit frameRecorder_t( const std::string& _path, bool _isCompressed = false );
+    ~frameRecorder_t( void );
+
+    frameRecorder_t( const frameRecorder_t& ) = delete;
+    frameRecorder_t& operator=( const frameRecorder_t& ) = delete;
+
+    ///////////////
+    /// @brief Append frame.
+    /// @details Compressed frame is copied and encoded on recorder thread, caller waits only
+    /// if that thread falls a few frames behind. Error of recorder thread is thrown by next call.
+    /// @param[in] _frame Captured frame.
+    ///////////////
+    void recordFrame( const cv::Mat& _frame );
+
+    ///////////////
+    /// @brief Append results of last frame.
+    /// @param[in] _results Results indexed by template ID.
+    ///////////////
+    void recordResults( const std::vector< matchResult_t >& _results );
+
+private:
+    struct record_t {
+        int64_t                      timestamp;
+        uint64_t                     frame;
+        cv::Mat                      image; // Empty for results
+        std::vector< matchResult_t > results;
+    };
+
+    void run( void );
+    void writeFrame( const cv::Mat& _frame, int64_t _timestamp, uint64_t _frameNumber );
+    void writeResults( const std::vector< matchResult_t >& _results, int64_t _timestamp, uint64_t _frameNumber );
+
+    int                                   m_descriptor;
+    uint64_t                              m_framesCount = 0;
+    bool                                  m_isCompressed;
+    std::vector< uint8_t >                m_buffer;
+    std::chrono::steady_clock::time_point m_start;
+    std::mutex                            m_mutex;
+    std::condition_variable               m_condition;
+    std::deque< record_t >                m_records;
+    std::vector< cv::Mat >                m_freeImages;
+    size_t                                m_queuedFramesCount = 0;
+    std::exception_ptr                    m_error;
+    bool                                  m_isStopping = false;
+    std::thread                           m_thread;
+};
+
+///////////////
+/// @brief Maps frame stream read-only and hands out recorded frames and results.
+/// @details Not supported on Windows.
+/// Throws ios_base::failure at error.
+///////////////
+class frameReplay_t {
+public:
+    explicit frameReplay_t( const std::string& _path );
+    ~frameReplay_t( void );
+
+    frameReplay_t( const frameReplay_t& ) = delete;
+    frameReplay_t& operator=( const frameReplay_t& ) = delete;
+
+    size_t size( void ) const {
+        return ( m_frames.size() );
+    }
+
+    ///////////////
+    /// @brief Get recorded frame.
+    /// @details Raw frame points into read-only mapping and lives as long as replay.
+    /// Throws ios_base::failure if record doesn't match its header.
+    /// @param[in] _index Frame index.
+    /// @param[out] _frame Frame.
+    /// @return Time since recording start.
+    ///////////////
+    std::chrono::nanoseconds read( size_t _index, cv::Mat& _frame ) const;
+
+    ///////////////
+    /// @brief Get results recorded with frame.
+    /// @details Throws ios_base::failure if results count doesn't match record size.
+    /// @param[in] _index Frame index.
+    /// @return Results indexed by template ID, empty if none.
+    ///////////////
+    std::vector< matchResult_t > results( size_t _index ) const;
+
+private:
+    int                                        m_descriptor;
+    const uint8_t*                             m_memory;
+    size_t                                     m_memorySize;
+    std::vector< std::pair< size_t, size_t > > m_frames; // Offsets of frame and results records
+};
+
+///////////////
+/// @brief Decodes frames of video file or images directory on own thread, ahead of matcher.
+/// @details Up to prefetch count decoded frames wait for matcher, buffers of taken frames
+/// are handed back to decoder.
+/// Throws ios_base::failure at error.
+///////////////
+class frameSource_t {
+public:
+    ///////////////
+    /// @brief Open source and start decoding.
+    /// @param[in] _source Video file, image sequence pattern like "frame_%04d.png" or images directory.
+    /// @param[in] _extension Images extension, used only for directory.
+    /// @param[in] _prefetchCount Decoded frames kept ahead.
+    ///////////////
+    explicit frameSource_t(
+        const std::string& _source,
+        const std::string& _extension     = ".png",
+        size_t             _prefetchCount = FRAME_PREFETCH_COUNT
+    );
+    ~frameSource_t( void );
+
+    frameSource_t( const frameSource_t& ) = delete;
+    frameSource_t& operator=( const frameSource_t& ) = delete;
+
+    ///////////////
+    /// @brief Take next frame, waits if decoder is behind.
+    /// @details Previous frame passed in is reused by decoder, it must not be referenced elsewhere.
+    /// Rethrows decoder exception after last decoded frame.
+    /// @param[in,out] _frame Previous frame, next frame.
+    /// @param[out] _name Image path, or frame position in video in seconds.
+    /// @return False after last frame.
+    ///////////////
+    bool read( cv::Mat& _frame, std::string& _name );
+
+    ///////////////
+    /// @brief Time spent in \c read waiting for decoder.
+    /// @return Wait time.
+    ///////////////
+    std::chrono::nanoseconds waitTime( void ) const {
+        return ( m_waitTime );
+    }
+
+private:
+    //! <b>[struct]</b>
+    /// @code{.cpp}
+    struct frame_t {
+        cv::Mat     image;
+        std::string name;
+    };
+    /// @endcode
+    //! <b>[struct]</b>
+
+    void run( void );
+
+    std::unique_ptr< cv::VideoCapture > m_videoCapture;
+    std::vector< std::string >          m_imagePaths;
+    size_t                              m_prefetchCount;
+    std::chrono::nanoseconds            m_waitTime{ 0 };
+    std::mutex                          m_mutex;
+    std::condition_variable             m_condition;
+    std::condition_variable             m_frameCondition;
+    std::deque< frame_t >               m_frames;
+    std::vector< cv::Mat >              m_freeImages;
+    bool                                m_isFinished = false;
+    bool                                m_isStopping = false;
+    std::exception_ptr                  m_exception;
+    std::thread                         m_thread;
+};
+
+//! <b>[struct]</b>
+/// Throughput of matched stream.
+/// @code{.cpp}
+struct streamStatistics_t {
+    uint64_t framesCount     = 0;
+    uint64_t detectionsCount = 0;
+    double   seconds         = 0;
+    double   waitSeconds     = 0; // Time matcher waited for decoder
+    double   framesPerSecond = 0;
+};
+/// @endcode
+//! <b>[struct]</b>
+
+class windowCapture_t;
+class resultDisplay_t;
+class incrementalMatcher_t;
+class latencyHistogram_t;
+
+///////////////
+/// @brief Matching state kept between calls.
+/// @details Owns loaded templates, window capture, buffers, threads and latest results,
+/// so every call pays only for capture and matching itself.
+///////////////
+class matchingSession_t {
+public:
+    explicit matchingSession_t(
+        uint32_t _matchMethod,
+        size_t   _threadsCount = std::thread::hardware_concurrency()
+    );
+    ~matchingSession_t( void );
+
+    matchingSession_t( const matchingSession_t& ) = delete;
+    matchingSession_t& operator=( const matchingSession_t& ) = delete;
+
+    ///////////////
+    /// @brief Load template and add it to searched ones.
+    /// @details Throws ios_base::failure at error.
+    /// @param[in] _templateImage Template image path.
+    /// @return Template ID.
+    ///////////////
+    size_t addTemplate( const std::string& _templateImage );
+
+    ///////////////
+    /// @brief Open capture of window, replacing previous one.
+    /// @param[in] _windowName Window name.
+    ///////////////
+    void setWindow( const std::string& _windowName );
+
+    ///////////////
+    /// @brief Capture window frames downscaled on X server for coarse or overview matching.
+    /// @details Templates are downscaled the same way and matched directly, results stay in window coordinates.
+    /// Replayed frames are taken as recorded with this scale, frame ring frames are always full resolution.
+    /// Throws ios_base::failure at error.
+    /// @param[in] _downscale Times window is larger than frame, 1 for full resolution.
+    ///////////////
+    void setCaptureScale( uint32_t _downscale );
+
+    ///////////////
+    /// @brief Add window matched by \c matchWindows with its own subset of templates.
+    /// @details All windows share one display connection, loaded templates and thread pool.
+    /// Throws ios_base::failure at error.
+    /// @param[in] _windowName Window name.
+    /// @param[in] _templateIds Template IDs searched on window, all templates if empty.
+    /// @return Window ID.
+    ///////////////
+    size_t addWindow( const std::string& _windowName, const std::vector< size_t >& _templateIds = {} );
+
+    ///////////////
+    /// @brief Record every window frame with its results.
+    /// @details Throws ios_base::failure at error.
+    /// @param[in] _path Frame stream path, empty to stop recording.
+    /// @param[in] _isCompressed Store frames as fast PNG instead of raw planes.
+    ///////////////
+    void setRecorder( const std::string& _path, bool _isCompressed = false );
+
+    ///////////////
+    /// @brief Take window frames from recorded frame stream instead of capturing them.
+    /// @details Throws ios_base::failure at error.
+    /// @param[in] _path Frame stream path.
+    /// @param[in] _isRealTime Keep recorded timing, otherwise frames go at maximum speed.
+    ///////////////
+    void setReplay( const std::string& _path, bool _isRealTime = false );
+
+    ///////////////
+    /// @brief All recorded frames were matched.
+    /// @return Replay is finished, false without replay.
+    ///////////////
+    bool isReplayFinished( void );
+
+    ///////////////
+    /// @brief Results recorded with last replayed frame, to compare against new ones.
+    /// @return Results indexed by template ID.
+    ///////////////
+    std::vector< matchResult_t > recordedResults( void );
+
+    ///////////////
+    /// @brief Take window frames from frame ring instead of capturing them.
+    /// @details Throws ios_base::failure at error.
+    /// @param[in] _ringName Shared memory name like "/frames" or file path.
+    /// @param[in] _isFileBacked Ring name is file path.
+    ///////////////
+    void setFrameRing( const std::string& _ringName, bool _isFileBacked = false );
+
+    void setShowResult( bool _showResult ) {
+        m_showResult = _showResult;
+    }
+
+    ///////////////
+    /// @brief Keep response maps between window frames and recompute only changed tiles.
+    /// @details Enabled by default.
+    /// @param[in] _isIncremental Enable or disable.
+    ///////////////
+    void setIncremental( bool _isIncremental );
+
+    ///////////////
+    /// @brief Time matching strategies of every template on first frame and keep fastest one.
+    /// @details Strategies must find template where direct matching does. Profile is loaded now if it exists,
+    /// its templates of the same pixels and frame size are not tuned again. Templates are tuned only when
+    /// they are added or frame size changes, profile is saved after every tuning.
+    /// Throws ios_base::failure at error.
+    /// @param[in] _path Profile path, empty to stop tuning and go back to direct matching.
+    ///////////////
+    void setTuningProfile( const std::string& _path );
+
+    ///////////////
+    /// @brief Tuning of every template.
+    /// @return Tunings indexed by template ID, not tuned ones have 0 hash.
+    ///////////////
+    std::vector< templateTuning_t > templateTunings( void );
+
+    const std::vector< std::string >& templateImages( void ) const {
+        return ( m_templateImages );
+    }
+
+    ///////////////
+    /// @brief Latest results, readable from any thread.
+    /// @return Results table.
+    ///////////////
+    const matchResults_t& results( void ) const {
+        return ( m_results );
+    }
+
+    ///////////////
+    /// @brief Match all templates on image.
+    /// @details Throws ios_base::failure at error.
+    /// @param[in] _image Image where the search is running.
+    /// @param[in] _isRgb Image is in RGB order, used only to show result.
+    /// @return Results indexed by template ID.
+    ///////////////
+    std::vector< matchResult_t > matchImage( const cv::Mat& _image, bool _isRgb = false );
+
+    ///////////////
+    /// @brief Match all templates on image from file.
+    /// @details Throws ios_base::failure at error.
+    /// @param[in] _sourceImage Image path.
+    /// @return Results indexed by template ID.
+    ///////////////
+    std::vector< matchResult_t > matchFile( const std::string& _sourceImage );
+
+    ///////////////
+    /// @brief Capture window and match all templates on it.
+    /// @details With frame ring, newest frame is matched in place and previous results are returned if there is no new one.
+    /// With latency target, frame too old to be matched within it is dropped and previous results are returned.
+    /// Throws ios_base::failure at error.
+    /// @return Results indexed by template ID.
+    ///////////////
+    std::vector< matchResult_t > matchWindow( void );
+
+    ///////////////
+    /// @brief Capture every window added by \c addWindow and match its templates on it.
+    /// @details Windows are captured back to back, then matched. With at least as many windows as threads
+    /// every window is matched by one thread, otherwise templates of each window are spread over all threads.
+    /// Throws ios_base::failure at error.
+    /// @return Results of every window template, ordered by window ID.
+    ///////////////
+    std::vector< windowResult_t > matchWindows( void );
+
+    ///////////////
+    /// @brief Match all templates on every frame of video file or images directory.
+    /// @details Frames are decoded ahead on own thread, results of unchanged frames are reused.
+    /// Detections are written to output as soon as frame is matched.
+    /// Throws ios_base::failure at error.
+    /// @param[in] _source Video file, image sequence pattern like "frame_%04d.png" or images directory.
+    /// @param[in] _outputPath Detections file, JSON if it ends with ".json", CSV otherwise.
+    /// @param[in] _extension Images extension, used only for directory.
+    /// @return Frames count and throughput.
+    ///////////////
+    streamStatistics_t matchStream(
+        const std::string& _source,
+        const std::string& _outputPath,
+        const std::string& _extension = ".png"
+    );
+
+    ///////////////
+    /// @brief Set score a stream result needs to be written as detection.
+    /// @details Threshold is maximum for squared difference methods, minimum otherwise.
+    /// Normed methods have default thresholds, other methods need one set before matchStream().
+    /// @param[in] _threshold Score threshold, NaN for method default.
+    ///////////////
+    void setScoreThreshold( double _threshold );
+
+    ///////////////
+    /// @brief Add rule applied by run loop after every frame.
+    /// @details Throws ios_base::failure at error.
+    /// @param[in] _rule Click rule.
+    ///////////////
+    void addClickRule( const clickRule_t& _rule );
+
+    ///////////////
+    /// @brief Set schedule of template and enable scheduling.
+    /// @details Throws ios_base::failure at error.
+    /// @param[in] _templateId Template ID.
+    /// @param[in] _schedule Template schedule.
+    ///////////////
+    void setTemplateSchedule( size_t _templateId, const templateSchedule_t& _schedule );
+
+    ///////////////
+    /// @brief Limit summed matching time of templates per frame and enable scheduling.
+    /// @details Templates past their deadline are matched over budget.
+    /// @param[in] _frameBudget Budget, 0 for unlimited.
+    ///////////////
+    void setFrameBudget( std::chrono::microseconds _frameBudget );
+
+    ///////////////
+    /// @brief Configure run loop for low and steady latency, applied on \c start .
+    /// @details Pinned threads aren't moved back when configuration changes.
+    /// Throws ios_base::failure at error.
+    /// @param[in] _lowLatency Configuration, default one for usual run loop.
+    ///////////////
+    void setLowLatency( const lowLatency_t& _lowLatency );
+
+    ///////////////
+    /// @brief Called from run loop thread for every event, events are still queued.
+    /// @param[in] _callback Callback or empty function to remove it.
+    ///////////////
+    void setEventCallback( std::function< void( const sessionEvent_t& ) > _callback );
+
+    ///////////////
+    /// @brief Start capturing window and matching on own thread.
+    /// @details Frames come from window capture, frame ring or replay, whichever is set, as in matchWindow().
+    /// Frames start on fixed deadlines, frame running past its deadline skips missed ones.
+    /// Throws ios_base::failure at error.
+    /// @param[in] _framesPerSecond Frame rate.
+    ///////////////
+    void start( double _framesPerSecond );
+
+    ///////////////
+    /// @brief Stop run loop and wait for current frame.
+    ///////////////
+    void stop( void );
+
+    bool isRunning( void ) const {
+        return ( m_loopThread.joinable() );
+    }
+
+    ///////////////
+    /// @brief Take queued events.
+    /// @details Queue keeps only newest \c SESSION_EVENTS_COUNT events.
+    /// @return Events in order they happened.
+    ///////////////
+    std::vector< sessionEvent_t > popEvents( void );
+
+    uint64_t framesCount( void ) const {
+        return ( m_framesCount.load( std::memory_order_relaxed ) );
+    }
+
+    uint64_t missedFramesCount( void ) const {
+        return ( m_missedFramesCount.load( std::memory_order_relaxed ) );
+    }
+
+    ///////////////
+    /// @brief Achieved capture to result latency of run loop against target.
+    /// @return Latency of all frames since session creation.
+    ///////////////
+    latencyReport_t latencyReport( void ) const;
+
+private:
+    //! <b>[struct]</b>
+    /// Scheduling state of template.
+    /// @code{.cpp}
+    struct templateState_t {
+        templateSchedule_t                    schedule;
+        std::chrono::steady_clock::time_point lastMatch;
+        std::chrono::nanoseconds              cost{ 0 }; // Average matching time
+        matchResult_t                         result;    // Result of last match
+        uint32_t                              backoff = 0;
+        bool                                  isMatched = false;
+    };
+    /// @endcode
+    //! <b>[struct]</b>
+
+    //! <b>[struct]</b>
+    /// Window of \c matchWindows with its templates subset.
+    /// @code{.cpp}
+    struct targetWindow_t {
+        std::unique_ptr< windowCapture_t >      capture;
+        std::vector< size_t >                   templateIds;    // Session template ID of every subset template
+        std::vector< std::string >              templateImages; // Subset template paths
+        matchResults_t                          results;        // Indexed by subset index
+        std::unique_ptr< incrementalMatcher_t > incrementalMatcher;
+    };
+    /// @endcode
+    //! <b>[struct]</b>
+
+    bool matchFrame( const cv::Mat& _frame, std::vector< std::vector< cv::Point > >* _outlines, uint32_t _downscale = 1 );
+    const std::vector< matchStrategy_t >* tune( const cv::Mat& _frame );
+    void saveTuningProfile( void );
+    bool schedule( templateSelection_t& _selection );
+    void reschedule( const templateSelection_t& _selection );
+    void run( std::chrono::nanoseconds _framePeriod );
+    void applyRules( const std::vector< matchResult_t >& _results, std::chrono::steady_clock::time_point _captureTime );
+    bool replayFrame( cv::Mat& _frame );
+    void pushEvent( const sessionEvent_t& _event );
+
+    uint32_t                                m_matchMethod;
+    double                                  m_scoreThreshold;
+    bool                                    m_showResult = false;
+    std::vector< std::string >              m_templateImages;
+    matPool_t                               m_matPool;
+    threadPool_t                            m_threadPool;
+    matchResults_t                          m_results;
+    std::unique_ptr< windowCapture_t >      m_windowCapture;
+    uint32_t                                m_captureScale = 1;
+    std::deque< targetWindow_t >            m_targetWindows;
+    std::unique_ptr< resultDisplay_t >      m_resultDisplay;
+    std::unique_ptr< incrementalMatcher_t > m_incrementalMatcher;
+    std::unique_ptr< frameRingReader_t >    m_frameRingReader;
+    uint64_t                                m_frameSequence = 0;
+    std::unique_ptr< frameRecorder_t >      m_frameRecorder;
+    std::unique_ptr< frameReplay_t >        m_frameReplay;
+    size_t                                  m_replayIndex = 0;
+    bool                                    m_isReplayRealTime = false;
+    std::chrono::steady_clock::time_point   m_replayStart;
+    std::vector< matchResult_t >            m_recordedResults;
+    std::string                             m_windowName;
+    std::vector< templateState_t >          m_templateStates;
+    std::chrono::microseconds               m_frameBudget{ 0 };
+    bool                                    m_isScheduled = false;
+
+    std::string                               m_tuningProfile;
+    cv::Size                                  m_tunedSize;
+    std::vector< templateTuning_t >           m_templateTunings;
+    std::vector< matchStrategy_t >            m_strategies;
+    cv::Size                                  m_profileSize;    // Frame size of profile tunings
+    std::map< std::string, templateTuning_t > m_profileTunings; // Profile tunings by template path
+
+    std::mutex                                           m_mutex;
+    std::vector< clickRule_t >                           m_clickRules;
+    std::vector< std::chrono::steady_clock::time_point > m_lastClicks;
+    std::vector< matchResult_t >                         m_previousResults;
+
+    std::mutex                                     m_eventsMutex;
+    std::deque< sessionEvent_t >                   m_events;
+    std::function< void( const sessionEvent_t& ) > m_eventCallback;
+
+    std::mutex                            m_loopMutex;
+    std::condition_variable               m_loopCondition;
+    std::atomic< bool >                   m_isStopping{ false }; // Atomic, busy polling checks it without lock
+    std::atomic< uint64_t >               m_framesCount{ 0 };
+    std::atomic< uint64_t >               m_missedFramesCount{ 0 };
+    std::atomic< uint64_t >               m_droppedFramesCount{ 0 };
+    lowLatency_t                          m_lowLatency;
+    std::chrono::nanoseconds              m_matchTime{ 0 }; // Expected matching time of window frame
+    uint32_t                              m_droppedInRowCount = 0; // Ring frames dropped since last matched one
+    std::unique_ptr< latencyHistogram_t > m_latencies;
+    std::thread                           m_loopThread;
+};
+
+///////////////
+/// @brief Completion of asynchronous request whose frame was superseded by newer frame of the same source.
+///////////////
+class matchCancelled_t : public std::ios_base::failure {
+public:
+    explicit matchCancelled_t( const std::string& _source )
+        : std::ios_base::failure( "Frame of " + _source + " was superseded by newer frame" ) {}
+};
+
+#ifdef MATCHING_COROUTINES
+class matchAwaitable_t;
+#endif
+
+///////////////
+/// @brief Capture and matching requests that return at once and complete on own dispatcher thread.
+/// @details Dispatcher captures or loads frame and matches templates on matcher's thread pool, one request at a time.
+/// Newer request for the same file or window supersedes older one: queued request is dropped,
+/// running request skips templates not started yet. Superseded request completes with \c matchCancelled_t .
+/// Completions run on dispatcher thread, so they must not block, coroutines resumed there should move on.
+/// Throws ios_base::failure at error.
+///////////////
+class asyncMatcher_t {
+public:
+    typedef std::function< void( std::exception_ptr, std::vector< matchResult_t > ) > completion_t;
+
+    explicit asyncMatcher_t(
+        uint32_t _matchMethod,
+        size_t   _threadsCount = std::thread::hardware_concurrency()
+    );
+
+    ///////////////
+    /// @brief Cancel pending requests and wait for dispatcher.
+    /// @details Every pending request still completes with \c matchCancelled_t .
+    ///////////////
+    ~asyncMatcher_t( void );
+
+    asyncMatcher_t( const asyncMatcher_t& ) = delete;
+    asyncMatcher_t& operator=( const asyncMatcher_t& ) = delete;
+
+    ///////////////
+    /// @brief Load template and add it to searched ones, requests submitted later search it as well.
+    /// @param[in] _templateImage Template image path.
+    /// @return Template ID.
+    ///////////////
+    size_t addTemplate( const std::string& _templateImage );
+
+    ///////////////
+    /// @brief Queue matching of image file.
+    /// @param[in] _sourceImage Image path.
+    /// @param[in] _completion Called on dispatcher thread with exception or results indexed by template ID.
+    ///////////////
+    void submitFile( const std::string& _sourceImage, completion_t _completion );
+
+    ///////////////
+    /// @brief Queue capture and matching of window.
+    /// @param[in] _windowName Window name.
+    /// @param[in] _completion Called on dispatcher thread with exception or results indexed by template ID.
+    ///////////////
+    void submitWindow( const std::string& _windowName, completion_t _completion );
+
+    ///////////////
+    /// @brief Queue matching of image file for caller without coroutines.
+    /// @param[in] _sourceImage Image path.
+    /// @return Results indexed by template ID, or request exception.
+    ///////////////
+    std::future< std::vector< matchResult_t > > matchFileAsync( const std::string& _sourceImage );
+
+    ///////////////
+    /// @brief Queue capture and matching of window for caller without coroutines.
+    /// @param[in] _windowName Window name.
+    /// @return Results indexed by template ID, or request exception.
+    ///////////////
+    std::future< std::vector< matchResult_t > > matchWindowAsync( const std::string& _windowName );
+
+#ifdef MATCHING_COROUTINES
+    ///////////////
+    /// @brief Match image file on \c co_await , suspended coroutine resumes on dispatcher thread.
+    /// @param[in] _sourceImage Image path.
+    /// @return Awaitable of results indexed by template ID.
+    ///////////////
+    matchAwaitable_t matchFile( const std::string& _sourceImage );
+
+    ///////////////
+    /// @brief Capture and match window on \c co_await , suspended coroutine resumes on dispatcher thread.
+    /// @param[in] _windowName Window name.
+    /// @return Awaitable of results indexed by template ID.
+    ///////////////
+    matchAwaitable_t matchWindow( const std::string& _windowName );
+#endif
+
+    ///////////////
+    /// @brief Cancel every queued and running request.
+    ///////////////
+    void cancel( void );
+
+private:
+    //! <b>[typedef]</b>
+    /// Source of request: window flag and file path or window name.
+    /// @code{.cpp}
+    typedef std::pair< bool, std::string > source_t;
+    /// @endcode
+    //! <b>[typedef]</b>
+
+    //! <b>[struct]</b>
+    /// @code{.cpp}
+    struct request_t {
+        source_t                               source;
+        std::shared_ptr< std::atomic< bool > > isCancelled;
+        completion_t                           completion;
+    };
+    /// @endcode
+    //! <b>[struct]</b>
+
+    void submit( source_t _source, completion_t _completion );
+    std::vector< matchResult_t > process( const request_t& _request );
+    void run( void );
+
+    uint32_t                                                     m_matchMethod;
+    std::vector< std::string >                                   m_templateImages;
+    matPool_t                                                    m_matPool;
+    threadPool_t                                                 m_threadPool;
+    std::mutex                                                   m_mutex;
+    std::condition_variable                                      m_condition;
+    std::deque< request_t >                                      m_requests;
+    std::map< source_t, std::shared_ptr< std::atomic< bool > > > m_latestRequests; // Cancellation of newest request per source
+    bool                                                         m_isStopping = false;
+    std::thread                                                  m_thread;
+};
+
+#ifdef MATCHING_COROUTINES
+///////////////
+/// @brief Request of \c asyncMatcher_t submitted when awaiting coroutine suspends.
+/// @details Throws request exception on resume, \c matchCancelled_t if frame was superseded.
+///////////////
+class matchAwaitable_t {
+public:
+    matchAwaitable_t( asyncMatcher_t& _matcher, bool _isWindow, std::string _source )
+        : m_matcher( _matcher ), m_isWindow( _isWindow ), m_source( std::move( _source ) ) {}
+
+    bool await_ready( void ) const noexcept {
+        return ( false );
+    }
+
+    void await_suspend( std::coroutine_handle<> _handle ) {
+        //! <b>[submit]</b>
+        /// Awaitable lives in coroutine frame, it is not touched after completion resumes coroutine.
+        /// @code{.cpp}
+        auto l_completion = [ this, _handle ]( std::exception_ptr _exception, std::vector< matchResult_t > _results ) {
+            m_exception = std::move( _exception );
+            m_results   = std::move( _results );
+
+            _handle.resume();
+        };
+
+        if ( m_isWindow ) {
+            m_matcher.submitWindow( m_source, std::move( l_completion ) );
+
+        } else {
+            m_matcher.submitFile( m_source, std::move( l_completion ) );
+        }
+        /// @endcode
+        //! <b>[submit]</b>
+    }
+
+    std::vector< matchResult_t > await_resume( void ) {
+        if ( m_exception ) {
+            std::rethrow_exception( m_exception );
+        }
+
+        return ( std::move( m_results ) );
+    }
+
+private:
+    asyncMatcher_t&              m_matcher;
+    bool                         m_isWindow;
+    std::string                  m_source;
+    std::exception_ptr           m_exception;
+    std::vector< matchResult_t > m_results;
+};
+
+inline matchAwaitable_t asyncMatcher_t::matchFile( const std::string& _sourceImage ) {
+    return ( matchAwaitable_t( *this, false, _sourceImage ) );
+}
+
+inline matchAwaitable_t asyncMatcher_t::matchWindow( const std::string& _windowName ) {
+    return ( matchAwaitable_t( *this, true, _windowName ) );
+}
+#endif
@@ -0,0 +1,234 @@
+///////////////
+/// @file allocations.cpp
+/// @brief Steady state allocation test of stateless and session matching.
+/// @details After warm-up frames every buffer of a frame is borrowed from pool, so pool allocates nothing.
+/// Batched templates then allocate no \c cv::Mat at all. Templates left to cv::matchTemplate
+/// are checked against pool only, OpenCV allocates DFT and integral scratch inside every call.
+/// Heap allocations through global operator new are counted as well and reported per frame,
+/// returned results and per-frame bookkeeping containers still allocate, so they are not asserted.
+///////////////
+#include <opencv4/opencv2/core.hpp>
+#include <opencv4/opencv2/imgcodecs.hpp>
+
+#include <fmt/core.h>
+
+#include "matching.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+//! <b>[define]</b>
+/// @code{.cpp}
+#define WARMUP_FRAMES_COUNT 5
+#define CHECKED_FRAMES_COUNT 20
+#define SAMPLE_WIDTH 320
+#define SAMPLE_HEIGHT 240
+#define GLYPHS_COUNT 6
+#define GLYPH_SIZE 16 // Small enough to be batched
+#define LARGE_TEMPLATE_SIZE 64 // Too large to be batched
+/// @endcode
+//! <b>[define]</b>
+
+//! <b>[heap]</b>
+/// Every heap allocation of process goes through replaced global operator new.
+/// @code{.cpp}
+static std::atomic< uint64_t > g_heapAllocationsCount = { 0 };
+
+void* operator new( size_t _size ) {
+    g_heapAllocationsCount.fetch_add( 1, std::memory_order_relaxed );
+
+    if ( void* l_memory = std::malloc( _size ? _size : 1 ) ) {
+        return ( l_memory );
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void* _memory ) noexcept {
+    std::free( _memory );
+}
+
+void operator delete( void* _memory, size_t ) noexcept {
+    std::free( _memory );
+}
+/// @endcode
+//! <b>[heap]</b>
+
+///////////////
+/// @brief Write sample of random pixels and templates cut from it.
+/// @param[in] _directory Output directory.
+/// @param[out] _glyphs Same size templates, batched together.
+/// @param[out] _largeTemplates Single template matched by cv::matchTemplate .
+/// @return Sample image.
+///////////////
+static cv::Mat writeImages(
+    const std::filesystem::path& _directory,
+    std::vector< std::string >&  _glyphs,
+    std::vector< std::string >&  _largeTemplates
+) {
+    //! <b>[sample]</b>
+    /// PNG keeps pixels, so templates are found exactly.
+    /// @code{.cpp}
+    cv::Mat l_sample( SAMPLE_HEIGHT, SAMPLE_WIDTH, CV_8UC3 );
+    cv::RNG l_rng( 1 );
+
+    l_rng.fill( l_sample, cv::RNG::UNIFORM, 0, 256 );
+
+    std::filesystem::create_directories( _directory );
+
+    cv::imwrite( ( _directory / "sample.png" ).string(), l_sample );
+    /// @endcode
+    //! <b>[sample]</b>
+
+    //! <b>[templates]</b>
+    /// @code{.cpp}
+    for ( int _glyphIndex = 0; _glyphIndex < GLYPHS_COUNT; _glyphIndex++ ) {
+        const std::string l_glyphPath = ( _directory / fmt::format( "glyph.{}.png", _glyphIndex ) ).string();
+
+        cv::imwrite( l_glyphPath, l_sample( cv::Rect( ( 40 * _glyphIndex ), ( 30 * _glyphIndex ), GLYPH_SIZE, GLYPH_SIZE ) ) );
+
+        _glyphs.push_back( l_glyphPath );
+    }
+
+    _largeTemplates.push_back( ( _directory / "large.png" ).string() );
+
+    cv::imwrite( _largeTemplates.back(), l_sample( cv::Rect( 100, 60, LARGE_TEMPLATE_SIZE, LARGE_TEMPLATE_SIZE ) ) );
+    /// @endcode
+    //! <b>[templates]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_sample );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Run frames after warm-up and count allocations made by them.
+/// @param[in] _name Checked path, for report.
+/// @param[in] _frame Matches one frame.
+/// @param[in] _pool Pool the frame borrows from, not checked if \c NULL .
+/// @param[in] _isMatAllocationFree No \c cv::Mat allocation is allowed, not only pool ones.
+/// @return No forbidden allocation was made.
+///////////////
+static bool checkSteadyState(
+    const std::string&                   _name,
+    const std::function< void( void ) >& _frame,
+    const matPool_t*                     _pool,
+    bool                                 _isMatAllocationFree
+) {
+    //! <b>[warmup]</b>
+    /// @code{.cpp}
+    for ( size_t _frameIndex = 0; _frameIndex < WARMUP_FRAMES_COUNT; _frameIndex++ ) {
+        _frame();
+    }
+    /// @endcode
+    //! <b>[warmup]</b>
+
+    //! <b>[count]</b>
+    /// @code{.cpp}
+    const uint64_t l_poolAllocations = ( _pool ? _pool->allocations() : 0 );
+    const uint64_t l_matAllocations  = getMatAllocationsCount();
+    const uint64_t l_heapAllocations = g_heapAllocationsCount.load();
+
+    for ( size_t _frameIndex = 0; _frameIndex < CHECKED_FRAMES_COUNT; _frameIndex++ ) {
+        _frame();
+    }
+
+    const uint64_t l_poolDelta = ( _pool ? ( _pool->allocations() - l_poolAllocations ) : 0 );
+    const uint64_t l_matDelta  = ( getMatAllocationsCount() - l_matAllocations );
+    const uint64_t l_heapDelta = ( g_heapAllocationsCount.load() - l_heapAllocations );
+    const bool     l_isPassed  = ( !l_poolDelta && ( !_isMatAllocationFree || !l_matDelta ) );
+
+    fmt::print(
+        "{}: {} pool, {} cv::Mat, {:.1f} heap allocations per frame {}\n",
+        _name,
+        l_poolDelta,
+        l_matDelta,
+        ( static_cast< double >( l_heapDelta ) / CHECKED_FRAMES_COUNT ),
+        ( l_isPassed ? "ok" : "FAILED" )
+    );
+    /// @endcode
+    //! <b>[count]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_isPassed );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+int main( void ) {
+    try {
+        //! <b>[prepare]</b>
+        /// Counter is installed before first image is decoded.
+        /// @code{.cpp}
+        enableAllocationCounter();
+
+        const std::filesystem::path l_directory  = ( std::filesystem::temp_directory_path() / "matching_allocations" );
+        const std::string           l_samplePath = ( l_directory / "sample.png" ).string();
+        std::vector< std::string >  l_glyphs;
+        std::vector< std::string >  l_largeTemplates;
+        const cv::Mat               l_sample     = writeImages( l_directory, l_glyphs, l_largeTemplates );
+        bool                        l_isPassed   = true;
+        /// @endcode
+        //! <b>[prepare]</b>
+
+        //! <b>[stateless]</b>
+        /// Every cv::TemplateMatchModes method, feature matching allocates inside ORB.
+        /// @code{.cpp}
+        for ( uint32_t _matchMethod = cv::TM_SQDIFF; _matchMethod <= cv::TM_CCOEFF_NORMED; _matchMethod++ ) {
+            l_isPassed &= checkSteadyState(
+                fmt::format( "file method {} batched", _matchMethod ),
+                [ & ] { matchingMethodFile( _matchMethod, l_samplePath, l_glyphs, false ); },
+                &getDefaultMatPool(),
+                true
+            );
+            l_isPassed &= checkSteadyState(
+                fmt::format( "file method {} matchTemplate", _matchMethod ),
+                [ & ] { matchingMethodFile( _matchMethod, l_samplePath, l_largeTemplates, false ); },
+                &getDefaultMatPool(),
+                false
+            );
+        }
+        /// @endcode
+        //! <b>[stateless]</b>
+
+        //! <b>[session]</b>
+        /// Session frame path matches every frame, incremental matching would skip unchanged ones.
+        /// Session pool is private, its allocations are \c cv::Mat allocations.
+        /// @code{.cpp}
+        for ( uint32_t _matchMethod = cv::TM_SQDIFF; _matchMethod <= cv::TM_CCOEFF_NORMED; _matchMethod++ ) {
+            matchingSession_t l_session( _matchMethod );
+
+            for ( const std::string& _glyph : l_glyphs ) {
+                l_session.addTemplate( _glyph );
+            }
+
+            l_session.setIncremental( false );
+
+            l_isPassed &= checkSteadyState(
+                fmt::format( "session method {} batched", _matchMethod ),
+                [ & ] { l_session.matchImage( l_sample ); },
+                NULL,
+                true
+            );
+        }
+
+        return ( l_isPassed ? EXIT_SUCCESS : EXIT_FAILURE );
+        /// @endcode
+        //! <b>[session]</b>
+
+    } catch ( const std::exception& _exception ) {
+        fmt::print( stderr, "{}\n", _exception.what() );
+
+        return ( EXIT_FAILURE );
+    }
+}
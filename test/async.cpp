@@ -0,0 +1,142 @@
+///////////////
+/// @file async.cpp
+/// @brief Awaiting \c asyncMatcher_t from C++20 coroutine.
+/// @details Built as C++20, so \c MATCHING_COROUTINES and \c matchAwaitable_t are compiled against library built as C++17.
+/// Coroutine awaits match of image file and template cut from it must be found at its center.
+///////////////
+#include <opencv4/opencv2/core.hpp>
+#include <opencv4/opencv2/imgcodecs.hpp>
+
+#include <fmt/core.h>
+
+#include "matching.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <vector>
+
+#ifndef MATCHING_COROUTINES
+#error "Coroutines are not enabled, build as C++20"
+#endif
+
+//! <b>[define]</b>
+/// @code{.cpp}
+#define SAMPLE_WIDTH 320
+#define SAMPLE_HEIGHT 240
+#define TEMPLATE_X 100
+#define TEMPLATE_Y 60
+#define TEMPLATE_SIZE 32
+#define TIMEOUT_SECONDS 30
+/// @endcode
+//! <b>[define]</b>
+
+///////////////
+/// @brief Coroutine started at once and destroyed on completion, result goes to promise passed to it.
+///////////////
+struct detachedTask_t {
+    struct promise_type {
+        detachedTask_t get_return_object( void ) noexcept {
+            return ( detachedTask_t() );
+        }
+
+        std::suspend_never initial_suspend( void ) noexcept {
+            return ( std::suspend_never() );
+        }
+
+        std::suspend_never final_suspend( void ) noexcept {
+            return ( std::suspend_never() );
+        }
+
+        void return_void( void ) noexcept {}
+
+        void unhandled_exception( void ) noexcept {
+            std::terminate();
+        }
+    };
+};
+
+///////////////
+/// @brief Match image file on \c co_await .
+/// @param[in] _matcher Matcher with template added.
+/// @param[in] _sourceImage Image path.
+/// @param[out] _results Results or request exception.
+///////////////
+static detachedTask_t awaitMatch(
+    asyncMatcher_t&                               _matcher,
+    std::string                                   _sourceImage,
+    std::promise< std::vector< matchResult_t > >& _results
+) {
+    try {
+        _results.set_value( co_await _matcher.matchFile( _sourceImage ) );
+
+    } catch ( ... ) {
+        _results.set_exception( std::current_exception() );
+    }
+}
+
+int main( void ) {
+    try {
+        //! <b>[prepare]</b>
+        /// @code{.cpp}
+        const std::filesystem::path l_directory = ( std::filesystem::temp_directory_path() / "matching_async" );
+        const std::string           l_sample    = ( l_directory / "sample.png" ).string();
+        const std::string           l_template  = ( l_directory / "template.png" ).string();
+        cv::Mat                     l_image( SAMPLE_HEIGHT, SAMPLE_WIDTH, CV_8UC3 );
+        cv::RNG                     l_rng( 1 );
+
+        l_rng.fill( l_image, cv::RNG::UNIFORM, 0, 256 );
+
+        std::filesystem::create_directories( l_directory );
+
+        cv::imwrite( l_sample, l_image );
+        cv::imwrite( l_template, l_image( cv::Rect( TEMPLATE_X, TEMPLATE_Y, TEMPLATE_SIZE, TEMPLATE_SIZE ) ) );
+        /// @endcode
+        //! <b>[prepare]</b>
+
+        //! <b>[await]</b>
+        /// Coroutine resumes on dispatcher thread, main thread waits for its promise.
+        /// Matcher is destroyed first, so request still pending at timeout completes into live promise.
+        /// @code{.cpp}
+        std::promise< std::vector< matchResult_t > > l_promise;
+        std::future< std::vector< matchResult_t > >  l_future = l_promise.get_future();
+        asyncMatcher_t                               l_matcher( cv::TM_SQDIFF_NORMED );
+
+        l_matcher.addTemplate( l_template );
+
+        awaitMatch( l_matcher, l_sample, l_promise );
+
+        if ( l_future.wait_for( std::chrono::seconds( TIMEOUT_SECONDS ) ) != std::future_status::ready ) {
+            fmt::print( stderr, "Awaited match did not complete in {} seconds\n", TIMEOUT_SECONDS );
+
+            return ( EXIT_FAILURE );
+        }
+
+        const std::vector< matchResult_t > l_results = l_future.get();
+        /// @endcode
+        //! <b>[await]</b>
+
+        //! <b>[check]</b>
+        /// @code{.cpp}
+        const bool l_isPassed = (
+            ( l_results.size() == 1 ) &&
+            l_results.front().found &&
+            ( l_results.front().x == ( TEMPLATE_X + ( TEMPLATE_SIZE / 2 ) ) ) &&
+            ( l_results.front().y == ( TEMPLATE_Y + ( TEMPLATE_SIZE / 2 ) ) )
+        );
+
+        fmt::print( "awaited match {}\n", ( l_isPassed ? "ok" : "FAILED" ) );
+
+        return ( l_isPassed ? EXIT_SUCCESS : EXIT_FAILURE );
+        /// @endcode
+        //! <b>[check]</b>
+
+    } catch ( const std::exception& _exception ) {
+        fmt::print( stderr, "{}\n", _exception.what() );
+
+        return ( EXIT_FAILURE );
+    }
+}
@@ -0,0 +1,241 @@
+///////////////
+/// @file batch.cpp
+/// @brief Batched correlation against cv::matchTemplate .
+/// @details Response maps of \c correlateTemplates are compared with cv::matchTemplate ones for every
+/// cv::TemplateMatchModes method, on color and gray images. Error is relative to largest reference response,
+/// unnormalized methods reach millions on 8-bit images.
+/// Session matching frame ring frames must batch templates with incremental matching on, as it is by default,
+/// and give the same results as full batched matching of the same frame.
+///////////////
+#include <opencv4/opencv2/core.hpp>
+#include <opencv4/opencv2/imgcodecs.hpp>
+#include <opencv4/opencv2/imgproc.hpp>
+
+#include <fmt/core.h>
+
+#include "matching.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+//! <b>[define]</b>
+/// @code{.cpp}
+#define SAMPLE_WIDTH 160
+#define SAMPLE_HEIGHT 120
+#define TEMPLATES_COUNT 5
+#define TEMPLATE_SIZE 16
+#define RELATIVE_TOLERANCE 1e-4 // Float products against OpenCV DFT correlation
+#define MOVED_TEMPLATE_X 120 // Where first template is moved to on second frame
+#define MOVED_TEMPLATE_Y 90
+/// @endcode
+//! <b>[define]</b>
+
+///////////////
+/// @brief Compare batched responses of every method with cv::matchTemplate .
+/// @param[in] _type Image type, see cv::Mat::type().
+/// @return All methods are within tolerance.
+///////////////
+static bool checkType( int _type ) {
+    //! <b>[sample]</b>
+    /// Templates are cut from sample, so every method has exact match, the last one is noise.
+    /// @code{.cpp}
+    cv::Mat                l_sample( SAMPLE_HEIGHT, SAMPLE_WIDTH, _type );
+    cv::RNG                l_rng( 1 );
+    std::vector< cv::Mat > l_templates;
+
+    l_rng.fill( l_sample, cv::RNG::UNIFORM, 0, 256 );
+
+    for ( int _templateIndex = 0; _templateIndex < ( TEMPLATES_COUNT - 1 ); _templateIndex++ ) {
+        l_templates.push_back( l_sample( cv::Rect( ( 12 * _templateIndex ), ( 10 * _templateIndex ), TEMPLATE_SIZE, TEMPLATE_SIZE ) ).clone() );
+    }
+
+    l_templates.emplace_back( TEMPLATE_SIZE, TEMPLATE_SIZE, _type );
+
+    l_rng.fill( l_templates.back(), cv::RNG::UNIFORM, 0, 256 );
+    /// @endcode
+    //! <b>[sample]</b>
+
+    //! <b>[compare]</b>
+    /// @code{.cpp}
+    bool l_isPassed = true;
+
+    for ( uint32_t _matchMethod = cv::TM_SQDIFF; _matchMethod <= cv::TM_CCOEFF_NORMED; _matchMethod++ ) {
+        const std::vector< cv::Mat > l_responses = correlateTemplates( l_sample, l_templates, _matchMethod );
+        double                       l_worstError = 0;
+
+        for ( size_t _templateIndex = 0; _templateIndex < l_templates.size(); _templateIndex++ ) {
+            cv::Mat l_reference;
+            double  l_referenceMinimum;
+            double  l_referenceMaximum;
+
+            cv::matchTemplate( l_sample, l_templates[ _templateIndex ], l_reference, _matchMethod );
+            cv::minMaxLoc( l_reference, &l_referenceMinimum, &l_referenceMaximum );
+
+            const double l_scale = std::max( { 1.0, std::fabs( l_referenceMinimum ), std::fabs( l_referenceMaximum ) } );
+
+            if ( l_responses[ _templateIndex ].size() != l_reference.size() ) {
+                l_worstError = std::numeric_limits< double >::infinity();
+
+                break;
+            }
+
+            l_worstError = std::max( l_worstError, ( cv::norm( l_responses[ _templateIndex ], l_reference, cv::NORM_INF ) / l_scale ) );
+        }
+
+        const bool l_isMethodPassed = ( l_worstError <= RELATIVE_TOLERANCE );
+
+        fmt::print(
+            "method {} {} channels: relative error {:.3g} {}\n",
+            _matchMethod,
+            CV_MAT_CN( _type ),
+            l_worstError,
+            ( l_isMethodPassed ? "ok" : "FAILED" )
+        );
+
+        l_isPassed &= l_isMethodPassed;
+    }
+    /// @endcode
+    //! <b>[compare]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_isPassed );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+///////////////
+/// @brief Match two frame ring frames in session and compare with full batched matching.
+/// @details Second frame moves first template, so only cells around old and new place are recomputed.
+/// @return Every method batched incrementally and matched the same as full batch.
+///////////////
+static bool checkSession( void ) {
+    //! <b>[frames]</b>
+    /// Templates are cut from first frame, second one has first template moved and its old place filled with noise.
+    /// @code{.cpp}
+    const std::filesystem::path l_directory = ( std::filesystem::temp_directory_path() / "matching_batch" );
+    const std::string           l_ring      = ( l_directory / "frames" ).string();
+    const std::string           l_trace     = ( l_directory / "trace.json" ).string();
+    cv::Mat                     l_frame( SAMPLE_HEIGHT, SAMPLE_WIDTH, CV_8UC3 );
+    cv::Mat                     l_movedFrame;
+    cv::RNG                     l_rng( 2 );
+    std::vector< std::string >  l_templates;
+
+    l_rng.fill( l_frame, cv::RNG::UNIFORM, 0, 256 );
+
+    std::filesystem::create_directories( l_directory );
+
+    for ( int _templateIndex = 0; _templateIndex < TEMPLATES_COUNT; _templateIndex++ ) {
+        l_templates.push_back( ( l_directory / fmt::format( "template.{}.png", _templateIndex ) ).string() );
+
+        cv::imwrite(
+            l_templates.back(),
+            l_frame( cv::Rect( ( 20 * _templateIndex ), ( 15 * _templateIndex ), TEMPLATE_SIZE, TEMPLATE_SIZE ) )
+        );
+    }
+
+    l_movedFrame = l_frame.clone();
+
+    l_frame( cv::Rect( 0, 0, TEMPLATE_SIZE, TEMPLATE_SIZE ) ).copyTo(
+        l_movedFrame( cv::Rect( MOVED_TEMPLATE_X, MOVED_TEMPLATE_Y, TEMPLATE_SIZE, TEMPLATE_SIZE ) )
+    );
+
+    cv::Mat l_oldPlace = l_movedFrame( cv::Rect( 0, 0, TEMPLATE_SIZE, TEMPLATE_SIZE ) );
+
+    l_rng.fill( l_oldPlace, cv::RNG::UNIFORM, 0, 256 );
+
+    frameRingWriter_t l_writer( l_ring, ( l_frame.total() * l_frame.elemSize() ), FRAME_RING_SLOTS_COUNT, true );
+    /// @endcode
+    //! <b>[frames]</b>
+
+    //! <b>[compare]</b>
+    /// @code{.cpp}
+    bool l_isPassed = true;
+
+    for ( uint32_t _matchMethod = cv::TM_SQDIFF; _matchMethod <= cv::TM_CCOEFF_NORMED; _matchMethod++ ) {
+        matchingSession_t l_session( _matchMethod );
+        matchingSession_t l_reference( _matchMethod );
+
+        for ( const std::string& _template : l_templates ) {
+            l_session.addTemplate( _template );
+            l_reference.addTemplate( _template );
+        }
+
+        l_writer.publish( l_frame );
+        l_session.setFrameRing( l_ring, true );
+        l_session.matchWindow();
+
+        clearTrace();
+        enableTracing( true );
+
+        l_writer.publish( l_movedFrame );
+
+        const std::vector< matchResult_t > l_results = l_session.matchWindow();
+
+        enableTracing( false );
+        writeTrace( l_trace );
+
+        const std::vector< matchResult_t > l_referenceResults = l_reference.matchImage( l_movedFrame );
+        std::ifstream                      l_traceFile( l_trace );
+        const std::string                  l_traceText(
+            ( std::istreambuf_iterator< char >( l_traceFile ) ),
+            std::istreambuf_iterator< char >()
+        );
+        bool                               l_isMethodPassed = (
+            ( l_traceText.find( "matchTemplateBatch" ) != std::string::npos ) &&
+            ( l_results.front().x == ( MOVED_TEMPLATE_X + ( TEMPLATE_SIZE / 2 ) ) ) &&
+            ( l_results.front().y == ( MOVED_TEMPLATE_Y + ( TEMPLATE_SIZE / 2 ) ) )
+        );
+
+        for ( size_t _templateId = 0; _templateId < l_results.size(); _templateId++ ) {
+            const matchResult_t& l_result          = l_results[ _templateId ];
+            const matchResult_t& l_referenceResult = l_referenceResults[ _templateId ];
+
+            l_isMethodPassed &= (
+                ( l_result.x == l_referenceResult.x ) &&
+                ( l_result.y == l_referenceResult.y ) &&
+                ( std::fabs( l_result.score - l_referenceResult.score ) <= ( RELATIVE_TOLERANCE * std::max( 1.0, std::fabs( l_referenceResult.score ) ) ) )
+            );
+        }
+
+        fmt::print( "session method {} incremental batch {}\n", _matchMethod, ( l_isMethodPassed ? "ok" : "FAILED" ) );
+
+        l_isPassed &= l_isMethodPassed;
+    }
+    /// @endcode
+    //! <b>[compare]</b>
+
+    //! <b>[return]</b>
+    /// End of function.
+    /// @code{.cpp}
+    return ( l_isPassed );
+    /// @endcode
+    //! <b>[return]</b>
+}
+
+int main( void ) {
+    try {
+        //! <b>[check]</b>
+        /// @code{.cpp}
+        const bool l_isColorPassed   = checkType( CV_8UC3 );
+        const bool l_isGrayPassed    = checkType( CV_8UC1 );
+        const bool l_isSessionPassed = checkSession();
+
+        return ( ( l_isColorPassed && l_isGrayPassed && l_isSessionPassed ) ? EXIT_SUCCESS : EXIT_FAILURE );
+        /// @endcode
+        //! <b>[check]</b>
+
+    } catch ( const std::exception& _exception ) {
+        fmt::print( stderr, "{}\n", _exception.what() );
+
+        return ( EXIT_FAILURE );
+    }
+}
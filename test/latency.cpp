@@ -0,0 +1,141 @@
+///////////////
+/// @file latency.cpp
+/// @brief Dropping of stale frame ring frames against latency target.
+/// @details Fresh ring frames must always be matched. Frames published long before they are read are dropped,
+/// but never more than \c LOW_LATENCY_MAXIMUM_DROPS in a row, so a session reading only stale frames keeps giving results.
+///////////////
+#include <opencv4/opencv2/core.hpp>
+#include <opencv4/opencv2/imgcodecs.hpp>
+
+#include <fmt/core.h>
+
+#include "matching.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+//! <b>[define]</b>
+/// @code{.cpp}
+#define SAMPLE_WIDTH 160
+#define SAMPLE_HEIGHT 120
+#define TEMPLATE_SIZE 16
+#define LATENCY_TARGET_MILLISECONDS 20
+#define STALE_MILLISECONDS 50 // Frame age past latency target
+#define FRESH_FRAMES_COUNT 5
+#define STALE_FRAMES_COUNT 20
+#define MAXIMUM_DROPS 4 // LOW_LATENCY_MAXIMUM_DROPS of engine
+/// @endcode
+//! <b>[define]</b>
+
+int main( void ) {
+    try {
+        //! <b>[prepare]</b>
+        /// Ring is file backed in temporary directory, so test needs no shared memory permissions.
+        /// Every frame is the same, incremental matching is off so none of them is skipped as unchanged.
+        /// @code{.cpp}
+        const std::filesystem::path l_directory = ( std::filesystem::temp_directory_path() / "matching_latency" );
+        const std::string           l_template  = ( l_directory / "template.png" ).string();
+        const std::string           l_ring      = ( l_directory / "frames" ).string();
+        cv::Mat                     l_frame( SAMPLE_HEIGHT, SAMPLE_WIDTH, CV_8UC3 );
+        cv::RNG                     l_rng( 1 );
+
+        l_rng.fill( l_frame, cv::RNG::UNIFORM, 0, 256 );
+
+        std::filesystem::create_directories( l_directory );
+
+        cv::imwrite( l_template, l_frame( cv::Rect( 40, 30, TEMPLATE_SIZE, TEMPLATE_SIZE ) ) );
+
+        frameRingWriter_t l_writer( l_ring, ( l_frame.total() * l_frame.elemSize() ), FRAME_RING_SLOTS_COUNT, true );
+        matchingSession_t l_session( cv::TM_SQDIFF_NORMED, 2 );
+        lowLatency_t      l_lowLatency;
+
+        l_lowLatency.latencyTarget = std::chrono::milliseconds( LATENCY_TARGET_MILLISECONDS );
+
+        l_session.addTemplate( l_template );
+        l_session.setIncremental( false );
+        l_session.setLowLatency( l_lowLatency );
+
+        l_writer.publish( l_frame );
+
+        l_session.setFrameRing( l_ring, true );
+        /// @endcode
+        //! <b>[prepare]</b>
+
+        //! <b>[match]</b>
+        /// Frame is matched when it gets new frame number, dropped one keeps results of previous frame.
+        /// @code{.cpp}
+        uint64_t l_lastFrame = 0;
+
+        auto isMatched = [ & ]( void ) {
+            const uint64_t l_frameNumber = l_session.matchWindow().front().frame;
+            const bool     l_isMatched   = ( l_frameNumber != l_lastFrame );
+
+            l_lastFrame = l_frameNumber;
+
+            return ( l_isMatched );
+        };
+        /// @endcode
+        //! <b>[match]</b>
+
+        //! <b>[fresh]</b>
+        /// @code{.cpp}
+        bool l_isPassed = isMatched();
+
+        for ( size_t _frameIndex = 0; _frameIndex < FRESH_FRAMES_COUNT; _frameIndex++ ) {
+            l_writer.publish( l_frame );
+
+            l_isPassed &= isMatched();
+        }
+
+        fmt::print( "fresh frames {}\n", ( l_isPassed ? "matched" : "FAILED, dropped" ) );
+        /// @endcode
+        //! <b>[fresh]</b>
+
+        //! <b>[stale]</b>
+        /// @code{.cpp}
+        size_t l_droppedInRowCount        = 0;
+        size_t l_maximumDroppedInRowCount = 0;
+        size_t l_matchedFramesCount       = 0;
+
+        for ( size_t _frameIndex = 0; _frameIndex < STALE_FRAMES_COUNT; _frameIndex++ ) {
+            l_writer.publish( l_frame );
+
+            std::this_thread::sleep_for( std::chrono::milliseconds( STALE_MILLISECONDS ) );
+
+            if ( isMatched() ) {
+                l_matchedFramesCount++;
+                l_droppedInRowCount = 0;
+
+            } else {
+                l_droppedInRowCount++;
+                l_maximumDroppedInRowCount = std::max( l_maximumDroppedInRowCount, l_droppedInRowCount );
+            }
+        }
+
+        const bool l_isStalePassed = (
+            ( l_session.latencyReport().droppedFramesCount > 0 ) &&
+            ( l_maximumDroppedInRowCount <= MAXIMUM_DROPS ) &&
+            ( l_matchedFramesCount >= ( STALE_FRAMES_COUNT / ( MAXIMUM_DROPS + 1 ) ) )
+        );
+
+        fmt::print(
+            "stale frames: {} matched, at most {} dropped in row {}\n",
+            l_matchedFramesCount,
+            l_maximumDroppedInRowCount,
+            ( l_isStalePassed ? "ok" : "FAILED" )
+        );
+
+        return ( ( l_isPassed && l_isStalePassed ) ? EXIT_SUCCESS : EXIT_FAILURE );
+        /// @endcode
+        //! <b>[stale]</b>
+
+    } catch ( const std::exception& _exception ) {
+        fmt::print( stderr, "{}\n", _exception.what() );
+
+        return ( EXIT_FAILURE );
+    }
+}